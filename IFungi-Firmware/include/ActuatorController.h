@@ -7,9 +7,27 @@
 #include "LEDScheduler.h"
 #include "OperationMode.h"
 #include "exhaustScheduler.h"
+#include "PIDController.h"
+#include "RelayAutotuner.h"
+#include "RelayGuard.h"
+#include "ClimateArbiter.h"
+#include "PeltierThermalModel.h"
+#include "EnergyMeter.h"
+#include "TimingProbe.h"
+#include "RuleEngine.h"
+#include "SetpointRamp.h"
+#include "DaylightHarvester.h"
+#include "SafetySupervisor.h"
 
 class FirebaseHandler;
 
+/// Malha submetida ao autotune a relé
+enum AutotuneLoop : uint8_t {
+    AUTOTUNE_LOOP_NONE        = 0,
+    AUTOTUNE_LOOP_TEMPERATURE = 1,   ///< Peltier (aquece/resfria, d = 1)
+    AUTOTUNE_LOOP_HUMIDITY    = 2    ///< Umidificador (liga/desliga, d = 0.5)
+};
+
 /**
  * @class ActuatorController
  * @brief Controlador principal dos atuadores do sistema (relés, LEDs, servo, Peltier)
@@ -17,11 +35,49 @@ class FirebaseHandler;
  * NOTA (v1.1): controlAutomatically() agora recebe dhtHealthy (bool).
  * Quando false, o Peltier é desligado imediatamente e bloqueado até que
  * o DHT22 se recupere — evita aquecimento/resfriamento sem leitura válida.
+ *
+ * NOTA (v1.2): o Peltier deixou de ser liga/desliga com histerese. Um PID
+ * (saída -1..+1: positivo = aquecer, negativo = resfriar) gera um duty que é
+ * aplicado por proporção de tempo em R1/R2, com tempos mínimos ligado/desligado.
+ * O aquecimento contínuo é limitado pelo PeltierThermalModel (v1.8).
+ *
+ * NOTA (v1.3): autotune a relé (RelayAutotuner) para temperatura e umidade.
+ * Durante o ensaio o autotuner comanda o atuador da malha; os ganhos obtidos
+ * são gravados no namespace NVS "setpoints" (tKp/tKi/tKd, hKp/hKi/hKd).
+ *
+ * NOTA (v1.4): relés protegidos contra desgaste (RelayGuard) — ver controlRelay().
+ *
+ * NOTA (v1.7): umidificador por pulsos — PI + proporção de tempo em R3, com o
+ * duty cortado pela taxa de subida da umidade (humidifierRiseGain).
+ * Umidificador e exaustor são sequenciados pelo ClimateArbiter.
+ *
+ * NOTA (v1.9): regras do usuário (RuleEngine) avaliadas em controlAutomatically()
+ * como intenção de exaustor/umidificador/LED; fonte em NVS "rules".
+ *
+ * NOTA (v1.10): tempMin/tempMax/humidityMin/humidityMax são o alvo; as malhas
+ * usam os efetivos da SetpointRamp, que andam em direção ao alvo a cada ciclo.
+ *
+ * NOTA (v1.12): sem agenda/regra, os LEDs são dimerizados pelo DaylightHarvester
+ * para manter luxSetpoint no LDR, descontando a própria contribuição.
+ *
+ * NOTA (v1.13): limites rígidos (leitura parada, DHT, temperatura máxima, água,
+ * tempo ligado) aplicados pelo SafetySupervisor numa task própria, em qualquer
+ * modo. Relé bloqueado não é religado por writeRelay(); o corte feito pela
+ * task é sincronizado no estado/contadores em reconcileSafetyCuts().
  */
 class ActuatorController {
 public:
     int closedPosition = 160;
     int openPosition   = 45;
+    unsigned long damperRampMs   = 1500;   ///< Duração da rampa do damper entre posições
+    unsigned long damperSettleMs = 500;    ///< Espera após a rampa antes de desanexar o servo
+    float damperMinFraction    = 0.10f;    ///< Piso de ventilação (0 = fecha totalmente)
+    float damperFullOpenExcess = 0.50f;    ///< Excesso relativo de gás que abre 100% (0.5 = 50% acima; ≤ 0 → 100%)
+    bool  humidifierPulseMode  = true;     ///< false = liga/desliga com histerese (comportamento antigo)
+    float humidifierRiseGain   = 0.10f;    ///< Corte de duty por %UR/min de subida
+    float ventMandatoryExcess  = 1.00f;    ///< Excesso de gás que torna a ventilação inadiável (1.0 = dobro)
+    /// Potências nominais (W): Peltier aquecendo/resfriando, umidificador, exaustor, LED 100%
+    EnergyRatings energyRatings = {60.0f, 60.0f, 25.0f, 12.0f, 20.0f};
 
     void begin(uint8_t pinLED, uint8_t pinRelay1, uint8_t pinRelay2,
                uint8_t pinRelay3, uint8_t pinRelay4, uint8_t servoPin);
@@ -32,8 +88,60 @@ public:
                         bool persistToNVS = true);
 
     void controlLEDs(bool on, int intensity);
-    void controlRelay(uint8_t relayNumber, bool state);
-    void controlPeltier(bool cooling, bool on);
+    /**
+     * @brief Comuta um relé (1..4) respeitando as regras de desgaste
+     * @param force true em caminhos de segurança — ignora dwell/limite por hora
+     * @return true se o relé está no estado pedido ao final da chamada
+     */
+    bool controlRelay(uint8_t relayNumber, bool state, bool force = false);
+    /// Peltier via R1/R2; a troca só acontece se ambos os relés puderem comutar
+    void controlPeltier(bool cooling, bool on, bool force = false);
+
+    /**
+     * @brief Define o ângulo alvo do damper (0-180)
+     * @details Só age quando o alvo muda: a damperTask anexa o servo, faz a
+     * rampa, espera assentar e desanexa.
+     */
+    void setDamperTarget(int angle);
+    int  getDamperAngle() const { return currentDamperAngle; }
+    /// Abertura do damper 0..1 (0 = closedPosition, 1 = openPosition), em 10 níveis
+    void setDamperFraction(float fraction);
+
+    /// Regras de desgaste de um relé (maxSwitchesPerHour = 0 → sem limite)
+    void setRelayWearLimits(uint8_t relayNumber, unsigned long minOnMs,
+                            unsigned long minOffMs, uint16_t maxSwitchesPerHour);
+    const RelayGuard& getRelayGuard() const { return relayGuard; }
+    /// Grava já os contadores de comutação pendentes (ex.: antes de reiniciar)
+    void flushRelayCounters() { relayGuard.flush(); }
+
+    /// Duty efetivo no pino (0..1) para a intensidade lógica, após a curva CIE
+    static float ledDutyForLogical(int logical);
+    /// Inversa de ledDutyForLogical: intensidade lógica (fracionária, 0-255)
+    static float ledLogicalForDuty(float duty);
+
+    /// Sonda de temporização da ledPwmTask (atraso de ativação e duração do fade)
+    const TimingProbe& getLedProbe() const { return ledProbe; }
+
+    // ─── Supervisor de segurança ─────────────────────────────────────────────
+    /// Cria a task do SafetySupervisor (sensores e atuadores já inicializados)
+    bool startSafetySupervisor(SensorController& sensors) { return safetySupervisor.begin(*this, sensors); }
+    /// Reserva da loop quando a task não pôde ser criada (sem efeito com a task)
+    void pollSafetySupervisor() { safetySupervisor.poll(); }
+    /// Intervenções por motivo e relés bloqueados (telemetria)
+    const SafetySupervisor& getSafetySupervisor() const { return safetySupervisor; }
+    /**
+     * @brief Aplica a máscara de bloqueio do supervisor (qualquer task, sem actuatorMutex)
+     * @details Na mesma seção crítica de writeRelay(): grava a máscara e leva a
+     * nível baixo os relés bloqueados. Relé do Peltier cortado corta o par.
+     * @return Relés energizados cortados agora (bit n-1 = relé n)
+     */
+    uint8_t safetyEnforce(uint8_t inhibitMask);
+    /// Relés efetivamente energizados (bit n-1 = relé n)
+    uint8_t relayOutputs() const;
+
+    /// Energia por atuador (Wh/horas ligado por período)
+    EnergyMeter& getEnergyMeter() { return energyMeter; }
+    const EnergyMeter& getEnergyMeter() const { return energyMeter; }
 
     /**
      * @brief Controla atuadores automaticamente baseado em leituras dos sensores
@@ -48,17 +156,103 @@ public:
      * @param dhtHealthy  false=DHT inoperante → Peltier BLOQUEADO por segurança
      * @param allowFirebaseWrite  Permite que o controlador envie atualizações ao Firebase
      *                            (desative quando chamado de uma thread secundária)
+     * @param ccsReady    false=CCS811 ainda condicionando → CO2/TVOCs ignorados no alarme de gás
      */
     void controlAutomatically(float temp, float humidity, int light,
                                int co, int co2, int tvocs,
                                bool waterLevel, bool dhtHealthy = true,
-                               bool allowFirebaseWrite = true);
+                               bool allowFirebaseWrite = true,
+                               bool ccsReady = true);
+
+    /**
+     * @brief Ganhos do PID do Peltier (saída em fração de duty por °C)
+     * @details ki em 1/(°C·s), kd em s/°C. Não zera o integrador.
+     */
+    void setPeltierPidGains(float kp, float ki, float kd);
+    /**
+     * @brief Janela da proporção de tempo do Peltier e tempos mínimos do relé
+     * @details minOn/minOff são limitados à janela. Padrão: 120 s / 20 s / 20 s.
+     */
+    void setPeltierWindow(unsigned long windowMs, unsigned long minOnMs, unsigned long minOffMs);
+    /// Última saída do PID do Peltier (-1..+1; positivo = aquecimento)
+    float getPeltierDemand() const { return peltierPid.output(); }
+
+    /**
+     * @brief Ganhos do PI do umidificador (saída em fração de duty por %UR)
+     * @details Também ajustados pelo autotune de umidade (regra PI).
+     */
+    void setHumidifierPidGains(float kp, float ki, float kd);
+    /**
+     * @brief Janela dos pulsos do umidificador e tempos mínimos do relé 3
+     * @details Padrão: 180 s / 30 s / 30 s. Ajustada ao RelayGuard de R3:
+     * mínimos ≥ os do relé e janela com pulso (2 comutações) dentro de
+     * maxSwitchesPerHour — 40/h → janela ≥ 180 s.
+     */
+    void setHumidifierWindow(unsigned long windowMs, unsigned long minOnMs, unsigned long minOffMs);
+    /// Duty aplicado no último ciclo (0..1, já descontada a antecipação)
+    float getHumidifierDuty() const { return humidifierDuty; }
+    /// Taxa de variação filtrada da umidade (%UR/min)
+    float getHumidityRiseRate() const { return humidityRiseRate; }
+
+    /// Modelo térmico do Peltier (limites ajustáveis; sinkTemp() para diagnóstico)
+    PeltierThermalModel& getPeltierThermal() { return peltierThermal; }
+    bool isPeltierInCooldown() const { return inCooldown; }
+
+    /// Árbitro umidificação x ventilação (durações e tempos por estado)
+    ClimateArbiter& getClimateArbiter() { return climateArbiter; }
+    const ClimateArbiter& getClimateArbiter() const { return climateArbiter; }
+
+    // ─── Rampa de setpoints ───────────────────────────────────────────────────
+    /**
+     * @brief Taxas da rampa (°C/h e %UR/h; 0 = imediato; negativo = mantém)
+     * @details Gravadas no namespace NVS "setpoints" (tRamp/hRamp) se mudarem.
+     */
+    void setSetpointRampRates(float tempPerHour, float humidityPerHour);
+    /// Alvo e efetivo de cada faixa (telemetria)
+    const SetpointRamp& getSetpointRamp() const { return setpointRamp; }
+
+    // ─── Regras do usuário ────────────────────────────────────────────────────
+    /**
+     * @brief Compila e ativa um conjunto de regras
+     * @param persist true grava fonte e versão no namespace NVS "rules"
+     * @return false mantém as regras anteriores (error descreve a falha)
+     */
+    bool loadRules(const String& source, int version, bool persist, String& error);
+    int  getRulesVersion() const { return _rulesVersion; }
+    const RuleEngine& getRuleEngine() const { return ruleEngine; }
+
+    // ─── Dimerização pela luz natural ─────────────────────────────────────────
+    /// Ganho LED→LDR e luz natural estimada (telemetria)
+    const DaylightHarvester& getDaylightHarvester() const { return daylightHarvester; }
+    /// Recalibra o ganho LED→LDR (unidade da leitura mudou). Chamar com actuatorMutex.
+    void recalibrateDaylightGain() { daylightHarvester.requestCalibration(); }
+
+    // ─── Autotune ─────────────────────────────────────────────────────────────
+    /**
+     * @brief Inicia o autotune a relé de uma malha
+     * @details Rejeitado em modo debug, com outro ensaio em curso ou com o
+     * atuador da malha desabilitado pelo modo de operação. O ensaio oscila em
+     * torno do centro da faixa de setpoints. DHT inoperante, água baixa ou
+     * mudança de modo abortam o ensaio.
+     * @return true se o ensaio foi iniciado
+     */
+    bool startAutotune(AutotuneLoop loop);
+    void abortAutotune(const char* reason);
+    bool isAutotuning() const { return autotuner.isRunning(); }
+    AutotuneLoop getAutotuneLoop() const { return autotuneLoop; }
+    const RelayAutotuner& getAutotuner() const { return autotuner; }
+
+    PidGains getPeltierGains() const { return peltierPid.gains(); }
+    PidGains getHumidityGains() const { return humidifierPid.gains(); }
+    /// Grava os ganhos das malhas junto aos setpoints (namespace "setpoints")
+    void savePidGainsNVS();
 
     void setDebugMode(bool debug);
     void setManualStates(bool relay1, bool relay2, bool relay3, bool relay4,
                          bool ledsOn, int ledsIntensity, bool humidifierOn);
 
-    void applyOperationMode(OperationMode mode);
+    /// @param reapply true reaplica o preset mesmo sem troca de modo (tabela nova)
+    void applyOperationMode(OperationMode mode, bool reapply = false);
     OperationMode getOperationMode() const { return _currentMode; }
 
     bool heatPeltier(bool on);
@@ -113,6 +307,73 @@ private:
     unsigned long peltierHeatingStart = 0;
     unsigned long cooldownStart       = 0;
 
+    // ─── PID + proporção de tempo do Peltier ─────────────────────────────────
+    PIDController          peltierPid{0.6f, 0.004f, 0.0f, -1.0f, 1.0f};
+    TimeProportionalOutput peltierTpo{120000UL, 20000UL, 20000UL};
+    PeltierMode            peltierTpoDirection = OFF;   ///< Sentido do ciclo em curso
+    unsigned long          lastPeltierPidTime  = 0;
+
+    // ─── Autotune ─────────────────────────────────────────────────────────────
+    RelayAutotuner autotuner;
+    AutotuneLoop   autotuneLoop  = AUTOTUNE_LOOP_NONE;
+
+    void serviceAutotune(float temp, float humidity, bool waterLevel, bool dhtHealthy);
+
+    // ─── PI + pulsos do umidificador ─────────────────────────────────────────
+    static constexpr float HUMIDITY_RATE_TAU_S = 60.0f;   ///< Filtro da taxa de subida
+    PIDController          humidifierPid{0.15f, 0.0005f, 0.0f, 0.0f, 1.0f};   ///< duty por %UR
+    TimeProportionalOutput humidifierTpo{180000UL, 30000UL, 30000UL};
+    unsigned long          lastHumidityPidTime = 0;
+    float                  lastHumiditySample  = 0.0f;
+    float                  humidityRiseRate    = 0.0f;
+    float                  humidifierDuty      = 0.0f;
+
+    ClimateArbiter climateArbiter;
+
+    RuleEngine ruleEngine;
+    DaylightHarvester daylightHarvester;   ///< LEDs sem agenda: completa a luz natural
+    int        _rulesVersion    = 0;       ///< 0 = nenhuma regra carregada
+    bool       _ruleLedOverride = false;   ///< Regra de LED ativa no último ciclo
+    void saveRulesNVS(const String& source);
+    bool loadRulesNVS();
+
+    /// Executa um passo do PI; retorna o estado desejado de R3
+    bool runHumidifierControl(float humidity);
+    /// Zera o histórico e força o ciclo de pulsos para desligado
+    void stopHumidifierControl();
+    /// Estende janela/mínimos dos pulsos às regras de R3; true se alterou
+    bool fitHumidifierWindowToRelay();
+
+    RelayGuard relayGuard;
+    EnergyMeter energyMeter;
+    /// Integra a energia das cargas no estado atual até now
+    void accountEnergy(unsigned long now);
+    /**
+     * @brief Única escrita física nos relés: atualiza estado + contadores
+     * @return false se o relé está bloqueado pelo SafetySupervisor (não liga)
+     */
+    bool writeRelay(uint8_t relayNumber, bool state, unsigned long now);
+
+    // ─── Supervisor de segurança ─────────────────────────────────────────────
+    SafetySupervisor safetySupervisor;
+    mutable portMUX_TYPE _relayMux = portMUX_INITIALIZER_UNLOCKED;   ///< Pinos dos relés + máscaras
+    volatile uint8_t _safetyInhibit = 0;   ///< Relés que o controle não pode ligar
+    volatile uint8_t _safetyCut     = 0;   ///< Cortados pela task, estado lógico ainda ligado
+    bool safetyInhibited(uint8_t mask) const { return (_safetyInhibit & mask) != 0; }
+    /// Leva os cortes do supervisor ao estado lógico, energia e RelayGuard
+    void reconcileSafetyCuts(unsigned long now);
+
+    void runPeltierControl(float temp);
+    void stopPeltierControl(const char* reason);
+
+    // Faixas abaixo são o alvo (NVS/Firebase/modo); malhas usam os efetivos
+    SetpointRamp setpointRamp;
+    bool         _setpointRamping = false;
+    float effTempMin()     const { return setpointRamp.effective(RAMP_TEMP_MIN); }
+    float effTempMax()     const { return setpointRamp.effective(RAMP_TEMP_MAX); }
+    float effHumidityMin() const { return setpointRamp.effective(RAMP_HUMIDITY_MIN); }
+    float effHumidityMax() const { return setpointRamp.effective(RAMP_HUMIDITY_MAX); }
+
     int   luxSetpoint   = 5000;
     float tempMin       = 20.0;
     float tempMax       = 30.0;
@@ -123,7 +384,7 @@ private:
     int   tvocsSetpoint = 100;
 
     PeltierMode currentPeltierMode  = OFF;
-    int         currentLEDIntensity = 0;
+    volatile int currentLEDIntensity = 0;   ///< Intensidade ao fim do último fade
     volatile int targetLEDIntensity = 0;
     bool relay1State = false;
     bool relay2State = false;
@@ -139,8 +400,7 @@ private:
     const unsigned long FIREBASE_WRITE_BLOCK_DURATION = 10000;
 
     bool inCooldown = false;
-    const unsigned long operationTime = 300000;
-    const unsigned long cooldownTime  = 60000;
+    PeltierThermalModel peltierThermal;   ///< Decide início/fim do cooldown do aquecimento
 
     bool devModeAnalogRead   = false;
     bool devModeDigitalWrite = false;
@@ -149,6 +409,11 @@ private:
     int  devModePWMValue     = 0;
     bool lastDevModeState    = false;
     TaskHandle_t ledPwmTaskHandle = nullptr;
+    TimingProbe  ledProbe{"ledPwmTask", 1250000UL};   ///< Prazo: fade completo (1 s) + 250 ms
+    volatile int64_t ledReleaseUs = 0;                ///< Instante do último novo alvo
+    TaskHandle_t damperTaskHandle = nullptr;
+    volatile int currentDamperAngle = -1;   ///< -1 = desconhecida (boot)
+    volatile int targetDamperAngle  = -1;
     bool _loadedScheduleFromNvs   = false;
     bool _loadedExhaustScheduleFromNvs = false;
 
@@ -158,8 +423,17 @@ private:
     void updateFirebaseStateImmediately();
     void executeDevModeOperations();
     static void ledPwmTask(void* parameter);
+    static void damperTask(void* parameter);
+    static const int DAMPER_LEVELS = 10;
+    /// Maior excesso relativo (valor/setpoint - 1) entre CO e, se ccsReady, CO2/TVOCs
+    float gasExcess(int co, int co2, int tvocs, bool ccsReady) const;
+    /// Novo alvo para a ledPwmTask, sem log nem escrita imediata no Firebase
+    void        setLEDTarget(int level);
     static int  ledLogicalToHardwarePwm(int logical);
+    void        setupLedHardware();
     void        writeLedHardwareFromLogical(int logical);
+    /// Fade em hardware (LEDC); bloqueia a task chamadora até concluir
+    void        fadeLedHardwareToLogical(int fromLogical, int toLogical);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef CLIMATE_ARBITER_H
+#define CLIMATE_ARBITER_H
+
+#include <Arduino.h>
+
+/**
+ * @file ClimateArbiter.h
+ * @brief Arbitragem entre umidificação e ventilação (umidificador x exaustor)
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Umidificador e exaustor eram decididos de forma independente: com
+ * CO2 alto na frutificação (co2Setpoint 800) o exaustor jogava fora o ar úmido
+ * enquanto o umidificador rodava no máximo — água e energia desperdiçadas.
+ * O árbitro recebe as intenções das duas malhas e sequencia o conflito:
+ *
+ *   intenção   umidificar ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+ *              ventilar   ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+ *   exaustor              ▔▔▔▔▔▁▁▁▁▁▁▁▁▔▔▔▔▔▁▁▁▁▁▁▁▁
+ *   umidificador          ▁▁▁▁▁▔▔▔▔▔▔▔▔▁▁▁▁▁▔▔▔▔▔▔▔▔
+ *                         rajada │ recuperação │ ...
+ *
+ *  ESTADOS:
+ *  ─────────────────────────────────────
+ *  - IDLE              : sem conflito — cada malha segue a própria intenção
+ *  - VENT_BURST        : rajada de ventilação (ventBurstMs), umidificador pausado
+ *  - HUMIDITY_RECOVERY : exaustor fechado (recoveryMs), umidificador liberado
+ *  - HUMIDIFIER_PAUSED : ventilação obrigatória (CO, modo forçado, excesso
+ *                        grave de gás) — nunca adiada; umidificador pausado
+ *
+ *  O tempo acumulado em cada estado é contabilizado desde o boot (telemetria).
+ *  Durações padrão (3 min + 5 min) cabem no limite de comutações/hora do
+ *  RelayGuard para R3/R4.
+ */
+
+enum ArbiterState : uint8_t {
+    ARB_IDLE              = 0,
+    ARB_VENT_BURST        = 1,
+    ARB_HUMIDITY_RECOVERY = 2,
+    ARB_HUMIDIFIER_PAUSED = 3,
+    ARB_STATES            = 4
+};
+
+/// Intenções das malhas no ciclo atual
+struct ClimateIntents {
+    bool humidify;        ///< Malha de umidade quer o umidificador ligado
+    bool ventilate;       ///< Gás/agenda pedem exaustor
+    bool ventMandatory;   ///< Ventilação que não pode ser adiada
+};
+
+/// Decisão aplicada aos relés
+struct ClimateDecision {
+    bool humidifier;
+    bool exhaust;
+};
+
+class ClimateArbiter {
+public:
+    unsigned long ventBurstMs = 3UL * 60UL * 1000UL;   ///< Duração da rajada de ventilação
+    unsigned long recoveryMs  = 5UL * 60UL * 1000UL;   ///< Duração da recuperação de umidade
+
+    /// Decide o estado dos atuadores a partir das intenções
+    ClimateDecision arbitrate(const ClimateIntents& in, unsigned long now);
+
+    ArbiterState state() const { return _state; }
+    /// Tempo acumulado no estado (ms), incluindo o período em curso
+    uint32_t timeInState(ArbiterState s, unsigned long now) const;
+    /// Nº de entradas no estado desde o boot
+    uint32_t entries(ArbiterState s) const { return s < ARB_STATES ? _entries[s] : 0; }
+
+    static const char* stateName(ArbiterState s);
+
+private:
+    ArbiterState  _state        = ARB_IDLE;
+    unsigned long _enteredAt    = 0;
+    uint32_t      _accum[ARB_STATES]   = {};
+    uint32_t      _entries[ARB_STATES] = {};
+
+    void _enter(ArbiterState s, unsigned long now);
+};
+
+#endif // CLIMATE_ARBITER_H
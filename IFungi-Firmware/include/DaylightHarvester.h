@@ -0,0 +1,111 @@
+#ifndef DAYLIGHT_HARVESTER_H
+#define DAYLIGHT_HARVESTER_H
+
+#include <Arduino.h>
+#include "PIDController.h"
+
+/**
+ * @file DaylightHarvester.h
+ * @brief Dimerização em malha fechada dos LEDs pela leitura do LDR
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Sem agenda, o controle automático ligava os LEDs em 255 abaixo de
+ * luxSetpoint e desligava acima: com luz natural parcial gastava energia à
+ * toa e piscava perto do limiar. Agora a intensidade é modulada para manter
+ * a luz medida no setpoint, completando só o que falta de luz natural.
+ *
+ *  MODELO:
+ *  ─────────────────────────────────────
+ *    luz medida = luz natural + ledGain × duty
+ *
+ *  - duty é o ciclo efetivo no pino (0..1) após a curva CIE
+ *    (ActuatorController::ledDutyForLogical), o mesmo que a contabilização
+ *    de energia usa: a luz dos LEDs é linear no duty, não no nível lógico.
+ *  - ledGain (luz com LEDs em 100%) é calibrado: LEDs em 0 e em 255 por
+ *    CAL_SETTLE_MS cada, na primeira vez (sem valor na NVS) e a cada
+ *    CAL_INTERVAL_MS. Gravado no namespace NVS "daylight" (chave "ledFull";
+ *    a chave "gain" do modelo por nível é ignorada). A varredura só começa com calibrationAllowed
+ *    (janela de luz da agenda de LEDs); fora dela fica pendente e a malha
+ *    segue com o ganho atual (ou liga/desliga, sem ganho).
+ *  - Luz natural estimada = medida − ledGain × duty aplicado, filtrada
+ *    (EMA, FILTER_TAU_S) — a contribuição dos próprios LEDs é descontada.
+ *  - Duty = (setpoint − luz natural) / ledGain (feedforward) + correção PI
+ *    (erro em duty, banda morta DEADBAND_FRACTION do setpoint), convertido
+ *    de volta ao nível lógico pela inversa da curva.
+ *  - LDR que não enxerga os LEDs (ledGain < GAIN_MIN): volta ao liga/desliga
+ *    com histerese — a malha não tem como medir o efeito.
+ *
+ *  AMOSTRAGEM:
+ *  ─────────────────────────────────────
+ *  Cada novo nível só é decidido depois que o fade terminou e passou
+ *  SETTLE_MS (fade de 1 s + período de 2 s do LDR): a amostra sempre
+ *  corresponde ao nível aplicado. Passo limitado a MAX_SLEW_PER_S níveis/s;
+ *  variações menores que LEVEL_STEP são ignoradas; abaixo de MIN_ON_LEVEL
+ *  os LEDs desligam.
+ */
+
+enum HarvestState : uint8_t {
+    HARVEST_RUN        = 0,
+    HARVEST_CAL_DARK   = 1,   ///< Calibração: medindo com LEDs apagados
+    HARVEST_CAL_BRIGHT = 2    ///< Calibração: medindo com LEDs em 255
+};
+
+class DaylightHarvester {
+public:
+    static constexpr float     FILTER_TAU_S      = 8.0f;
+    static constexpr float     MAX_SLEW_PER_S    = 8.0f;
+    static constexpr float     DEADBAND_FRACTION = 0.05f;
+    static constexpr float     GAIN_MIN          = 128.0f;  ///< Luz dos LEDs em 100%
+    static const int           LEVEL_STEP        = 4;
+    static const int           MIN_ON_LEVEL      = 12;
+    static const unsigned long SETTLE_MS         = 3000UL;
+    static const unsigned long CAL_SETTLE_MS     = 4000UL;
+    static const unsigned long CAL_INTERVAL_MS   = 7UL * 24UL * 3600UL * 1000UL;
+    static const unsigned long RESTART_GAP_MS    = 30000UL;  ///< Pausa que reinicia a malha
+
+    /// Restaura ledGain da NVS
+    void begin();
+
+    /**
+     * @brief Um passo da malha
+     * @param light   Leitura atual do LDR
+     * @param applied Nível em que o último fade terminou (currentLEDIntensity)
+     * @param target  Setpoint de luz (luxSetpoint)
+     * @param calibrationAllowed false adia a calibração (período escuro)
+     * @return Nível PWM desejado (0-255)
+     */
+    int update(int light, int applied, float target, unsigned long now, bool calibrationAllowed);
+
+    /// Agenda nova calibração no próximo update()
+    void requestCalibration() { _calDue = true; }
+
+    HarvestState state()       const { return _state; }
+    float        ledGain()     const { return _gain; }
+    bool         closedLoop()  const { return _gain >= GAIN_MIN; }
+    /// Luz natural estimada (filtrada)
+    float        daylight()    const { return _daylight; }
+
+private:
+    PIDController _trim{0.30f, 0.02f, 0.0f, -0.25f, 0.25f};   ///< Correção em duty
+
+    HarvestState  _state      = HARVEST_RUN;
+    float         _gain       = 0.0f;
+    bool          _calDue     = true;
+    unsigned long _calAt      = 0;
+    float         _calDark    = 0.0f;
+
+    int           _commanded  = -1;     ///< -1 = malha parada
+    unsigned long _settledAt  = 0;      ///< Fade concluído no nível comandado
+    unsigned long _lastSample = 0;
+    unsigned long _lastCall   = 0;
+    float         _daylight   = NAN;
+
+    void _restart(int applied);
+    int  _command(int level);
+    int  _calibrate(int light, unsigned long now);
+    int  _regulate(int light, float target, unsigned long now);
+    void _save();
+};
+
+#endif // DAYLIGHT_HARVESTER_H
@@ -0,0 +1,103 @@
+#ifndef ENERGY_METER_H
+#define ENERGY_METER_H
+
+#include <Arduino.h>
+
+/**
+ * @file EnergyMeter.h
+ * @brief Contabilização de energia por atuador (Wh e horas ligado)
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Não há medição de corrente na placa: a energia é estimada
+ * integrando a potência nominal de cada carga pelo tempo em cada estado.
+ * O ActuatorController chama integrate() com as potências vigentes antes de
+ * qualquer mudança de relé e a cada ciclo de controle (≤ 5 s), de modo que a
+ * integral é exata para os relés e tem erro ≤ 1 ciclo para o LED.
+ *
+ *  ACUMULADORES:
+ *  ─────────────────────────────────────
+ *  hoje, ontem, semana (segunda a domingo), semana anterior e total — cada um
+ *  com Wh e segundos ligado por canal (Peltier, umidificador, exaustor, LED).
+ *  A virada de dia/semana usa o relógio injetado (timestamp já no fuso local);
+ *  sem relógio válido tudo acumula em "hoje" até a primeira hora conhecida.
+ *
+ *  PERSISTÊNCIA:
+ *  ─────────────────────────────────────
+ *  - Estado vivo em RTC_NOINIT (sobrevive a reset por software/WDT/pânico),
+ *    validado por número mágico + checksum.
+ *  - Checkpoint na NVS (namespace "energy", chave "state") a cada
+ *    ENERGY_CHECKPOINT_MS e na virada do dia. Após queda de energia perde-se
+ *    no máximo uma hora de contabilização.
+ */
+
+enum EnergyChannel : uint8_t {
+    ENERGY_PELTIER    = 0,
+    ENERGY_HUMIDIFIER = 1,
+    ENERGY_EXHAUST    = 2,
+    ENERGY_LED        = 3,
+    ENERGY_CHANNELS   = 4
+};
+
+enum EnergyPeriod : uint8_t {
+    ENERGY_TODAY     = 0,
+    ENERGY_YESTERDAY = 1,
+    ENERGY_WEEK      = 2,
+    ENERGY_LAST_WEEK = 3,
+    ENERGY_LIFETIME  = 4,
+    ENERGY_PERIODS   = 5
+};
+
+/// Potências nominais (W) das cargas
+struct EnergyRatings {
+    float peltierHeatW;   ///< R1 + R2 (aquecimento)
+    float peltierCoolW;   ///< R1 (resfriamento)
+    float humidifierW;
+    float exhaustW;
+    float ledFullW;       ///< LED em duty 100% (escala linear com o duty do LEDC)
+};
+
+struct EnergyTotals {
+    double wh[ENERGY_CHANNELS];
+    double onSec[ENERGY_CHANNELS];
+};
+
+class EnergyMeter {
+public:
+    /// Relógio em epoch local (s); 0 ou implausível = desconhecido
+    void setClock(unsigned long (*clock)()) { _clock = clock; }
+
+    /// Retoma da RTC, senão da NVS, senão começa do zero
+    void begin();
+
+    /**
+     * @brief Integra as potências vigentes desde a última chamada
+     * @details Chamar ANTES de alterar qualquer carga.
+     */
+    void integrate(const float watts[ENERGY_CHANNELS], unsigned long now);
+
+    /// Verifica a virada de dia/semana e grava o checkpoint se venceu
+    void checkpointIfDue(unsigned long now);
+    /// Grava o checkpoint na NVS imediatamente
+    void checkpoint();
+
+    const EnergyTotals& totals(EnergyPeriod p) const;
+    double totalWh(EnergyPeriod p) const;
+
+    static const char* channelName(EnergyChannel c);
+    static const char* periodName(EnergyPeriod p);
+
+private:
+    static const unsigned long ENERGY_CHECKPOINT_MS  = 60UL * 60UL * 1000UL;
+    static const unsigned long ENERGY_CLOCK_CHECK_MS = 60UL * 1000UL;
+
+    unsigned long (*_clock)() = nullptr;
+    unsigned long _lastIntegrate  = 0;
+    unsigned long _lastCheckpoint = 0;
+    unsigned long _lastClockCheck = 0;
+    bool          _started        = false;
+
+    void _rollover(uint32_t day);
+};
+
+#endif // ENERGY_METER_H
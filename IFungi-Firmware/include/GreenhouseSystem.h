@@ -5,7 +5,9 @@
 #include <FirebaseESP32.h>
 #include <nvs_flash.h>
 #include "ActuatorController.h"
+#include "LightCalibration.h"
 #include "OperationMode.h"
+#include "GrowRecipe.h"
 #include "RemoteLogger.h"
 #include <Preferences.h>
 #include <NTPClient.h>
@@ -130,9 +132,119 @@ public:
      * @details Escreve o modo corrente em /operation_mode/mode.
      * Útil após uma mudança iniciada pelo próprio ESP32.
      *
-     * @param mode Modo a ser publicado
+     * @param mode  Modo a ser publicado
+     * @param force true escreve mesmo se igual ao último publicado (o app
+     *              pode ter mudado o nó desde então)
+     * @return true se o Firebase contém o modo
      */
-    void publishOperationMode(OperationMode mode);
+    bool publishOperationMode(OperationMode mode, bool force = false);
+
+    // ── Autotune ─────────────────────────────────────────────────────────────
+
+    /**
+     * @brief Lê /autotune/request e dispara/aborta o ensaio no actuator
+     *
+     * @details Valores aceitos: "temperature", "humidity", "abort". Após
+     * processar, o pedido volta para "none" para não ser reexecutado.
+     */
+    void receiveAutotuneRequest(ActuatorController& actuators);
+
+    /**
+     * @brief Publica estado/resultado do autotune em /autotune
+     * @details Só escreve quando o estado ou o nº de ciclos muda.
+     */
+    void publishAutotuneStatus(ActuatorController& actuators);
+
+    // ── Calibração do LDR ────────────────────────────────────────────────────
+
+    /**
+     * @brief Lê /calibracao_ldr/comando ("ponto:<lux>" ou "limpar")
+     *
+     * @details Comando lido volta para "none" para não ser reexecutado. A
+     * aplicação (SensorController, sob sensorMutex) fica com o chamador.
+     *
+     * @param[out] command Comando pendente
+     * @return true se há comando a aplicar
+     */
+    bool fetchLightCalibrationCommand(String& command);
+
+    /**
+     * @brief Publica resultado do comando e a curva em /calibracao_ldr/status
+     */
+    void publishLightCalibrationStatus(const LightCalibration& cal, bool ok,
+                                       const String& message, int adc);
+
+    // ── Regras de automação ──────────────────────────────────────────────────
+
+    /**
+     * @brief Busca a fonte das regras se /regras/versao mudou
+     *
+     * @details Lê só o inteiro de versão a cada chamada; a fonte
+     * (/regras/fonte) é baixada apenas quando a versão difere da última
+     * tentada — versão rejeitada não é baixada de novo.
+     *
+     * @param currentVersion Versão ativa no ActuatorController
+     * @param[out] source  Fonte das regras
+     * @param[out] version Versão lida
+     * @return true se há uma nova versão a compilar
+     */
+    bool fetchRules(int currentVersion, String& source, int& version);
+
+    /// Esquece a versão tentada (não foi compilada): fetchRules() a devolve de novo
+    void retryRules() { _lastRulesVersionTried = -1; }
+
+    /**
+     * @brief Publica o resultado da compilação em /regras/status
+     */
+    void publishRulesStatus(int version, bool ok, const String& error, int ruleCount);
+
+    // ── Tabela de modos ──────────────────────────────────────────────────────
+
+    /**
+     * @brief Busca /operation_mode/presets/tabela se a versão mudou
+     * @details Mesmo protocolo de fetchRules(): versão rejeitada não é baixada de novo.
+     */
+    bool fetchModeTable(int currentVersion, String& source, int& version);
+
+    /// Esquece a versão tentada (não foi carregada): fetchModeTable() a devolve de novo
+    void retryModeTable() { _lastModesVersionTried = -1; }
+
+    /**
+     * @brief Publica o resultado da decodificação e as chaves disponíveis
+     *        em /operation_mode/presets/status
+     */
+    void publishModeTableStatus(int version, bool ok, const String& error);
+
+    // ── Receita de cultivo ───────────────────────────────────────────────────
+
+    /// Busca /receita/fases se /receita/versao mudou (protocolo de fetchRules())
+    bool fetchRecipe(int currentVersion, String& source, int& version);
+
+    /**
+     * @brief Lê /receita/comando ("start", "stop", "next") e o devolve para "none"
+     * @return Comando pendente ou string vazia
+     */
+    String receiveRecipeCommand();
+
+    /**
+     * @brief Publica o progresso em /receita/status
+     * @details Só escreve quando ativa/fase/horas na fase mudam ou force=true.
+     */
+    void publishRecipeStatus(const GrowRecipe& recipe, bool force);
+
+    // ── Telemetria dos atuadores ─────────────────────────────────────────────
+
+    /**
+     * @brief Publica telemetria de desgaste/uso dos atuadores em /telemetria
+     *
+     * @details Por relé: comutações acumuladas (vida útil), comutações na
+     * última hora e comutações adiadas pelas regras de desgaste. Permite
+     * prever a troca dos relés pelo app. Inclui o tempo em cada estado de
+     * conflito do ClimateArbiter (/telemetria/arbitragem), a energia estimada
+     * por atuador (/telemetria/energia) e as intervenções do SafetySupervisor
+     * (/telemetria/seguranca).
+     */
+    bool sendActuatorTelemetry(ActuatorController& actuators);
 
     // OTA
     void ensureOTANodeExists();
@@ -185,6 +297,15 @@ private:
 
     // Cache do modo de operação para detectar mudanças sem re-escrever sempre
     OperationMode _lastPublishedMode = MODE_MANUAL;
+    int           _lastAutotuneStatus = -1;   ///< state*256 + ciclos publicados
+    int           _lastRulesVersionTried = -1; ///< Evita baixar de novo versão rejeitada
+    int           _lastModesVersionTried = -1;
+    int           _lastRecipeVersionTried = -1;
+    long          _lastRecipeStatus       = -1;   ///< ativa/fase/horas publicados
+
+    /// Lê <base>/versao e, se nova, <base>/<sourceKey> (texto versionado)
+    bool fetchVersionedSource(const String& base, const char* sourceKey, int currentVersion,
+                              int& lastTried, String& source, int& version);
 };
 
 #endif
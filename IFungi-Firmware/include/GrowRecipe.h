@@ -0,0 +1,135 @@
+#ifndef GROW_RECIPE_H
+#define GROW_RECIPE_H
+
+#include <Arduino.h>
+#include "OperationMode.h"
+
+/**
+ * @file GrowRecipe.h
+ * @brief Receita de cultivo: sequência de modos de operação por fase
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Substitui a troca manual incubação → frutificação → secagem.
+ * Cada fase aplica um modo (embutido ou da ModeTable) e avança por tempo
+ * decorrido e/ou condição dos sensores. Fonte sincronizada do Firebase
+ * (/receita/fases), uma fase por linha ('#' comenta):
+ *
+ *   incubacao,14-21,co2plato:150   # após 14 dias, avança quando o CO2 estabilizar; no máx. 21
+ *   frutificacao,10
+ *   secagem,2
+ *
+ *  CAMPOS:
+ *  ─────────────────────────────────────
+ *  modo     → chave do modo (ver OperationMode.h)
+ *  dias     → "N" (avança após N dias) ou "min-max" (condição avaliada a
+ *             partir de min; max avança incondicionalmente). Aceita fração.
+ *  condição → co2plato:<ppm>: CO2 com amplitude (máx − mín) ≤ ppm nas
+ *             últimas RECIPE_CO2_WINDOW amostras (1 a cada 15 min = 2 h).
+ *             Só conta com o CCS811 pronto; sensor fora reinicia a janela.
+ *
+ *  TEMPO E PERSISTÊNCIA:
+ *  ─────────────────────────────────────
+ *  - Dias contados no relógio de parede (epoch): reboot, OTA ou período
+ *    offline não atrasam a receita. Sem hora plausível nada avança.
+ *  - Fases, fase atual e instantes de início gravados como blob no
+ *    namespace NVS "recipe" a cada mudança.
+ *  - Nova versão com a receita ativa mantém o progresso se a fase atual
+ *    ainda existir; senão a receita é interrompida. Se o modo da fase atual
+ *    mudou, o chamador o reaplica na próxima conferência (mode() é comparado
+ *    com o modo ativo a cada ciclo, não só na troca de fase).
+ *  - Ao fim da última fase a receita é concluída e o modo permanece.
+ *
+ *  MODOS DAS FASES:
+ *  ─────────────────────────────────────
+ *  Cada fase guarda a chave do modo (ids de modos personalizados seguem a
+ *  ordem da tabela e mudam se ela for reordenada). As chaves são resolvidas
+ *  com ModeTable::find() no begin(), no load() e em resolveModes() — chamado
+ *  após cada recarga da tabela. Fase atual cujo modo sumiu da tabela
+ *  interrompe a receita; fase seguinte sem modo a conclui ao ser alcançada.
+ */
+
+enum RecipeTrigger : uint8_t {
+    RECIPE_TRIGGER_TIME        = 0,   ///< Avança em maxHours
+    RECIPE_TRIGGER_CO2_PLATEAU = 1    ///< Avança no platô de CO2 após minHours
+};
+
+struct RecipePhase {
+    char     modeKey[16];   ///< Chave do modo (ModeEntry::key)
+    uint8_t  trigger;       ///< RecipeTrigger
+    uint16_t minHours;
+    uint16_t maxHours;
+    uint16_t plateauPpm;
+};
+
+class GrowRecipe {
+public:
+    static const uint8_t       RECIPE_MAX_PHASES      = 8;
+    static const uint8_t       RECIPE_CO2_WINDOW      = 8;
+    static const unsigned long RECIPE_CO2_SAMPLE_MS   = 15UL * 60UL * 1000UL;
+
+    /// Restaura fases e progresso da NVS (após ModeTable::begin())
+    void begin();
+
+    /// Resolve de novo as chaves das fases — chamar após recarregar a ModeTable
+    void resolveModes();
+
+    /**
+     * @brief Decodifica uma receita e substitui as fases
+     * @return false mantém a receita anterior (error indica a linha)
+     */
+    bool load(const String& source, int version, String& error);
+
+    /// Inicia na fase 0 — exige relógio plausível e ao menos uma fase
+    bool start(unsigned long epoch);
+    void stop(const char* reason);
+    /// Avança para a próxima fase imediatamente (comando do operador)
+    bool skip(unsigned long epoch);
+
+    /**
+     * @brief Amostra o CO2 e avalia a transição da fase atual
+     * @return true se a fase mudou — o chamador aplica mode() se isActive()
+     */
+    bool update(unsigned long epoch, int co2, bool ccsReady, unsigned long nowMs);
+
+    bool          isActive()   const { return _s.active; }
+    uint8_t       phase()      const { return _s.phase; }
+    uint8_t       phaseCount() const { return _s.count; }
+    int           version()    const { return _s.version; }
+    OperationMode mode()       const { return (OperationMode)_modes[_s.phase]; }
+    unsigned long startedAt()  const { return _s.recipeStart; }
+    /// Dias na fase atual / desde o início (0 sem relógio)
+    float phaseDays(unsigned long epoch) const;
+    float totalDays(unsigned long epoch) const;
+    /// Motivo da última transição, início ou parada
+    const char* lastReason() const { return _reason; }
+
+private:
+    struct State {
+        uint16_t    format;
+        int32_t     version;
+        uint8_t     count;
+        bool        active;
+        uint8_t     phase;
+        uint32_t    recipeStart;
+        uint32_t    phaseStart;
+        RecipePhase phases[RECIPE_MAX_PHASES];
+    };
+
+    State         _s = {};
+    uint8_t       _modes[RECIPE_MAX_PHASES] = {};   ///< Id resolvido por fase (RAM)
+    int           _co2[RECIPE_CO2_WINDOW] = {};
+    uint8_t       _co2Count   = 0;
+    uint8_t       _co2Head    = 0;
+    unsigned long _lastSample = 0;
+    char          _reason[64] = "";
+
+    void _enterPhase(uint8_t phase, unsigned long epoch, const char* reason);
+    /// false se alguma chave não existe mais (id da fase fica MODE_MANUAL)
+    bool _resolvePhase(uint8_t phase);
+    bool _co2Plateau(uint16_t ppm) const;
+    void _save();
+    static bool _parseLine(char* line, RecipePhase& phase, String& error);
+};
+
+#endif // GROW_RECIPE_H
@@ -2,11 +2,12 @@
 #define LED_SCHEDULER_H
 
 #include <Arduino.h>
+#include "TimeWindows.h"
 
 /**
  * @file LEDScheduler.h
  * @brief Sistema de agendamento e simulação de ciclo solar para os LEDs
- * @version 1.0
+ * @version 1.2
  * @date 2026
  *
  * @details Gerencia dois modos de operação dos LEDs de crescimento:
@@ -32,13 +33,34 @@
  *  A curva usa uma função senoidal sobre a janela de luz definida.
  *  Pico de intensidade ao meio-dia solar (midpoint entre onHour e offHour).
  *
+ *  JANELAS (v1.1, ver TimeWindows.h):
+ *  ─────────────────────────────────────
+ *  O horário é avaliado pelo núcleo comum TimeWindowSchedule: janela que
+ *  cruza a meia-noite (20:00-08:00), várias janelas e dias da semana pelo
+ *  campo opcional "windows". No modo solar cada bloco contínuo de luz
+ *  recebe o seu próprio arco.
+ *
+ *  MODO ASTRONÔMICO (v1.2, solarSimEnabled + astroEnabled):
+ *  ─────────────────────────────────────
+ *  Nascer/pôr do sol e elevação solar calculados (equações da NOAA) para
+ *  latitude/longitude e a data: a duração do dia acompanha as estações e as
+ *  janelas de horário são ignoradas. Uma vez por dia (ou ao mudar a posição)
+ *  a curva é tabelada em ASTRO_SLOTS pontos de ASTRO_STEP_MIN minutos —
+ *  intensidade ∝ sen(elevação), normalizada pelo meio-dia do próprio dia,
+ *  com o mesmo piso de 10% do arco senoidal. update() só interpola a tabela.
+ *  Fuso fixo ASTRO_UTC_OFFSET_MIN, o mesmo do NTPClient.
+ *
  *  PRIORIDADE:
  *  ─────────────────────────────────────
  *  1. debugMode ativo → scheduler desabilitado totalmente
- *  2. solarSimEnabled → ignora scheduleEnabled
+ *  2. solarSimEnabled → ignora scheduleEnabled (astroEnabled → curva astronômica)
  *  3. scheduleEnabled → intensidade fixa no período
  *  4. Nenhum ativo → não interfere no controle automático
  *
+ *  Mesmo com a agenda desligada, update() avalia a janela de luz configurada
+ *  (inLightPeriod()): a calibração do DaylightHarvester só acende os LEDs em
+ *  255 dentro dela, nunca no período escuro.
+ *
  *  ESTRUTURA NO FIREBASE RTDB:
  *  ─────────────────────────────────────
  *  /greenhouses/<ID>/led_schedule: {
@@ -48,7 +70,11 @@
  *    "onMinute": 0,       // minuto de ligar (0-59)
  *    "offHour":  20,      // hora de desligar (0-23)
  *    "offMinute": 0,      // minuto de desligar (0-59)
- *    "intensity": 255     // intensidade fixa (0-255, ignorada no modo solar)
+ *    "intensity": 255,    // intensidade fixa (0-255, ignorada no modo solar)
+ *    "windows": "",       // opcional (v1.1): substitui onHour..offMinute
+ *    "astroEnabled": false, // opcionais (v1.2): curva astronômica no modo solar
+ *    "latitude": -23.55,
+ *    "longitude": -46.63
  *  }
  */
 
@@ -65,6 +91,17 @@ public:
     int   offMinute       = 0;     ///< Minuto de fim (0-59)
     int   configIntensity = 255;   ///< Intensidade no modo timer (0-255)
 
+    /// Janelas de luz — campos on/off acima viram a janela padrão (ver TimeWindows.h)
+    TimeWindowSchedule windows;
+
+    bool  astroEnabled    = false;   ///< Modo solar segue o sol real (lat/lon)
+    float latitude        = -23.55f; ///< Graus, sul negativo
+    float longitude       = -46.63f; ///< Graus, oeste negativo
+
+    static const int     ASTRO_UTC_OFFSET_MIN = -180; ///< Fuso dos timestamps (NTPClient)
+    static const uint8_t ASTRO_STEP_MIN       = 10;
+    static const uint8_t ASTRO_SLOTS          = 24 * 60 / ASTRO_STEP_MIN;
+
     // ─── Interface pública ────────────────────────────────────────────────────
 
     /**
@@ -96,6 +133,9 @@ public:
      */
     bool isActive() const { return scheduleEnabled || solarSimEnabled; }
 
+    /// Dentro da janela de luz configurada (avaliada mesmo com a agenda desligada)
+    bool inLightPeriod() const { return _lightPeriod; }
+
     /**
      * @brief Converte segundos desde meia-noite em hora e minuto
      * @param secondsOfDay  Segundos decorridos desde 00:00:00 UTC (timestamp % 86400)
@@ -104,26 +144,45 @@ public:
      */
     static void secondsToHM(unsigned long secondsOfDay, int& hour, int& minute);
 
+    /// Nascer/pôr do sol do dia tabelado, em minutos locais (-1 = sem tabela)
+    int sunriseMinute() const { return _sunrise; }
+    int sunsetMinute()  const { return _sunset; }
+
 private:
 
     bool _ledsOn    = false; ///< Estado calculado: LEDs devem estar ligados?
+    bool _lightPeriod = false; ///< Janela de luz configurada contém o instante atual
     int  _intensity = 0;     ///< Intensidade calculada (0-255)
 
     /**
      * @brief Calcula intensidade do modo simulação solar
      *
      * @details Usa função senoidal normalizada:
-     *   t = posição normalizada dentro da janela de luz (0.0 a 1.0)
+     *   t = posição normalizada dentro do bloco de luz (0.0 a 1.0)
      *   intensity = sin(t * PI) * 255
      *
      * Isso garante rampa suave de subida e descida, com pico ao meio do dia.
      *
-     * @param nowMinutes   Minutos desde meia-noite (hora*60 + minuto)
-     * @param startMinutes Minutos do horário de início
-     * @param endMinutes   Minutos do horário de fim
+     * @param now   Timestamp atual
+     * @param start Início do bloco de luz (windows.blockStart())
+     * @param end   Fim do bloco de luz (windows.nextChange())
      * @return Intensidade (0-255)
      */
-    int _solarIntensity(int nowMinutes, int startMinutes, int endMinutes);
+    int _solarIntensity(unsigned long now, unsigned long start, unsigned long end);
+
+    // ─── Modo astronômico ─────────────────────────────────────────────────────
+
+    uint8_t _astroTable[ASTRO_SLOTS + 1] = {};
+    long    _astroDay = -1;        ///< Dia local (timestamp / 86400) da tabela
+    float   _astroLat = NAN;
+    float   _astroLon = NAN;
+    int     _sunrise  = -1;
+    int     _sunset   = -1;
+
+    /// Recalcula nascer/pôr e a curva do dia (≈ ASTRO_SLOTS senos/cossenos)
+    void _buildAstroTable(long day);
+    /// Intensidade por interpolação na tabela — 0 fora do período de sol
+    int  _astroIntensity(unsigned long secondsOfDay) const;
 };
 
 #endif // LED_SCHEDULER_H
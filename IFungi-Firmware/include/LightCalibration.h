@@ -0,0 +1,87 @@
+#ifndef LIGHT_CALIBRATION_H
+#define LIGHT_CALIBRATION_H
+
+#include <Arduino.h>
+
+/**
+ * @file LightCalibration.h
+ * @brief Curva de calibração do LDR: contagem do ADC → lux
+ * @version 1.0
+ * @date 2026
+ *
+ * @details luxSetpoint é documentado em lux, mas era comparado com a contagem
+ * crua do analogRead() do LDR. Com a calibração, SensorController::getLight()
+ * passa a entregar lux e telemetria, histórico, regras e controle de LEDs
+ * usam a mesma unidade do setpoint.
+ *
+ *  PROCEDIMENTO (modo debug/calibração ligado):
+ *  ─────────────────────────────────────
+ *  1. Luxímetro de referência ao lado do LDR, luz estável.
+ *  2. App grava /calibracao_ldr/comando = "ponto:<lux>" → a leitura crua
+ *     atual é pareada com o valor informado (ponto com ADC a menos de
+ *     LCAL_MERGE_ADC de outro o substitui).
+ *  3. Repetir em níveis de luz diferentes (escuro, ambiente, LEDs no máximo).
+ *     Com 2 ou mais pontos a curva é montada e gravada na NVS ("ldrcal").
+ *  4. "limpar" apaga a calibração (volta à contagem crua).
+ *  Resultado e pontos publicados em /calibracao_ldr/status.
+ *
+ *  CURVA:
+ *  ─────────────────────────────────────
+ *  - Resposta do LDR é aproximadamente exponencial: entre pontos vizinhos
+ *    log(lux) é interpolado linearmente no ADC; fora da faixa, prolonga o
+ *    segmento mais próximo. Lux deve ser monotônico no ADC (qualquer sentido,
+ *    conforme o divisor resistivo).
+ *  - Na calibração a curva é amostrada em LCAL_LUT_SIZE pontos (a cada 16
+ *    contagens); toLux() é O(1): índice pelos bits altos + interpolação linear.
+ *  - Lux limitado a 0-65535 (tabela em uint16_t).
+ */
+
+struct LightCalPoint {
+    uint16_t adc;
+    float    lux;
+};
+
+class LightCalibration {
+public:
+    static const uint8_t  LCAL_MAX_POINTS = 8;
+    static const uint8_t  LCAL_LUT_SHIFT  = 4;
+    static const uint16_t LCAL_ADC_MAX    = 4095;
+    static const uint16_t LCAL_LUT_SIZE   = ((LCAL_ADC_MAX + 1) >> LCAL_LUT_SHIFT) + 1;
+    static const uint16_t LCAL_MERGE_ADC  = 16;
+    static constexpr float LCAL_MIN_LUX   = 0.5f;   ///< Piso do log (ponto "escuro" = 0 lux)
+
+    /// Restaura os pontos da NVS e monta a tabela
+    void begin();
+
+    /**
+     * @brief Inclui/substitui um ponto e remonta a curva
+     * @return false mantém a calibração anterior (error descreve o motivo)
+     */
+    bool addPoint(int adc, float lux, String& error);
+    void clear();
+
+    /// Contagem do ADC → lux; sem calibração devolve a própria contagem
+    int toLux(int adc) const {
+        if (_count < 2) return adc;
+        if (adc < 0) adc = 0;
+        if (adc > LCAL_ADC_MAX) adc = LCAL_ADC_MAX;
+        uint16_t i    = adc >> LCAL_LUT_SHIFT;
+        int      frac = adc & ((1 << LCAL_LUT_SHIFT) - 1);
+        return _lut[i] + (((int)_lut[i + 1] - (int)_lut[i]) * frac >> LCAL_LUT_SHIFT);
+    }
+
+    bool                 calibrated() const { return _count >= 2; }
+    uint8_t              count()      const { return _count; }
+    const LightCalPoint& point(uint8_t i) const { return _points[i]; }
+
+private:
+    LightCalPoint _points[LCAL_MAX_POINTS] = {};
+    uint8_t       _count = 0;
+    uint16_t      _lut[LCAL_LUT_SIZE] = {};
+
+    static bool _validate(const LightCalPoint* pts, uint8_t n, String& error);
+    void _build();
+    void _save();
+};
+
+#endif // LIGHT_CALIBRATION_H
@@ -6,7 +6,7 @@
 /**
  * @file OperationMode.h
  * @brief Modos de operação pré-configurados para cultivo de fungos
- * @version 1.0
+ * @version 1.1
  * @date 2026
  *
  * @details Define os modos de operação da estufa para cada fase do ciclo
@@ -56,8 +56,31 @@
  *  /greenhouses/<ID>/operation_mode: {
  *    "mode": "frutificacao",          // string do enum
  *    "lastChanged": 1720000000,       // timestamp da última mudança
- *    "changedBy": "app"               // quem mudou (app, esp32, auto)
+ *    "changedBy": "app",              // quem mudou (app, esp32, auto)
+ *    "presets": {                     // tabela versionada (opcional)
+ *      "versao": 3,
+ *      "tabela": "ostra_frut,Ostra frutificacao,15,21,85,95,800,3000,HLPS,06:00,18:00,180\n...",
+ *      "status": { "versao", "ok", "erro", "modos" }   // escrito pelo ESP32
+ *    }
  *  }
+ *
+ * NOVIDADES (v1.1):
+ *  - Presets deixam de ser um switch: ModeTable guarda um vetor plano
+ *    indexado pelo id do modo (O(1)) e um índice hash chave → id. Os cinco
+ *    modos acima são a base; a tabela do Firebase pode redefinir os presets
+ *    deles (exceto manual) e acrescentar modos por espécie sem recompilar.
+ *  - A tabela é decodificada uma vez e gravada como blob no namespace NVS
+ *    "modes"; no boot o blob é carregado direto no vetor.
+ *
+ *  FORMATO DA TABELA (uma linha por modo, '#' comenta):
+ *  ─────────────────────────────────────
+ *   chave,rótulo,tMin,tMax,hMin,hMax,co2,lux,flags,liga HH:MM,desliga HH:MM,intensidade
+ *   flags: H umidificador, L LEDs, P Peltier, X exaustor forçado,
+ *          S agenda de LEDs, O simulação solar ("-" = nenhuma)
+ *   chave: [a-z0-9_], até 15 caracteres. Modos novos recebem ids a partir
+ *   de MODE_BUILTIN_COUNT, na ordem da tabela — o id muda se a tabela for
+ *   reordenada: quem guarda um modo entre cargas guarda a chave e a resolve
+ *   de novo com ModeTable::find(). Campo vazio conta (rótulo vazio = chave).
  */
 
 // =============================================================================
@@ -72,50 +95,8 @@ enum OperationMode {
     MODE_MANUTENCAO   = 4   ///< Manutenção: tudo desligado
 };
 
-// =============================================================================
-// CONVERSÃO ENUM ↔ STRING
-// =============================================================================
-
-/**
- * @brief Converte string do Firebase para enum OperationMode
- * @param str String do Firebase (ex: "frutificacao")
- * @return OperationMode correspondente (padrão: MODE_MANUAL)
- */
-inline OperationMode operationModeFromString(const String& str) {
-    if (str == "incubacao")    return MODE_INCUBACAO;
-    if (str == "frutificacao") return MODE_FRUTIFICACAO;
-    if (str == "secagem")      return MODE_SECAGEM;
-    if (str == "manutencao")   return MODE_MANUTENCAO;
-    return MODE_MANUAL;
-}
-
-/**
- * @brief Converte enum OperationMode para string do Firebase
- * @param mode Enum OperationMode
- * @return String correspondente (ex: "frutificacao")
- */
-inline String operationModeToString(OperationMode mode) {
-    switch (mode) {
-        case MODE_INCUBACAO:    return "incubacao";
-        case MODE_FRUTIFICACAO: return "frutificacao";
-        case MODE_SECAGEM:      return "secagem";
-        case MODE_MANUTENCAO:   return "manutencao";
-        default:                return "manual";
-    }
-}
-
-/**
- * @brief Retorna nome legível do modo para logs
- */
-inline String operationModeLabel(OperationMode mode) {
-    switch (mode) {
-        case MODE_INCUBACAO:    return "Incubação";
-        case MODE_FRUTIFICACAO: return "Frutificação";
-        case MODE_SECAGEM:      return "Secagem";
-        case MODE_MANUTENCAO:   return "Manutenção";
-        default:                return "Manual";
-    }
-}
+static const uint8_t MODE_BUILTIN_COUNT = 5;    ///< Primeiro id de modo definido pela tabela
+static const uint8_t MODE_TABLE_MAX     = 12;   ///< Capacidade da tabela (embutidos + personalizados)
 
 // =============================================================================
 // ESTRUTURA DE PRESET
@@ -151,139 +132,115 @@ struct ModePreset {
 };
 
 // =============================================================================
-// PRESETS POR MODO
+// TABELA DE MODOS
 // =============================================================================
 
 /**
- * @brief Retorna o preset de configuração para um modo de operação
- *
- * @details Valores baseados em literatura de cultivo de fungos comestíveis
- * (Pleurotus ostreatus, Lentinula edodes, Ganoderma lucidum).
- * Ajuste conforme a espécie cultivada.
+ * @struct ModeEntry
+ * @brief Uma linha da tabela: chave do Firebase, rótulo de log e preset
+ */
+struct ModeEntry {
+    char       key[16];
+    char       label[24];
+    ModePreset preset;
+};
+
+/**
+ * @class ModeTable
+ * @brief Presets indexados pelo id do modo, carregados da NVS/Firebase
  *
- * @param mode Modo de operação desejado
- * @return ModePreset com todos os parâmetros configurados
+ * @details Estado estático único (como o RemoteLogger). Só a loopTask
+ * consulta e substitui a tabela — sem mutex.
  */
-inline ModePreset getModePreset(OperationMode mode) {
-    switch (mode) {
+class ModeTable {
+public:
+    static const uint8_t HASH_SLOTS = 32;   ///< Potência de 2, > 2 × MODE_TABLE_MAX
+
+    /// Carrega os modos embutidos e, se houver, o blob salvo na NVS
+    static void begin();
+
+    /**
+     * @brief Decodifica uma tabela de texto e, se válida, substitui a atual
+     * @param persist true grava o blob decodificado no namespace NVS "modes"
+     * @return false mantém a tabela anterior (error indica a linha)
+     */
+    static bool load(const String& source, int version, bool persist, String& error);
+
+    /// Preset do modo; id fora da tabela → preset manual
+    static const ModePreset& preset(OperationMode mode) {
+        return _table.entries[(unsigned)mode < _table.count ? mode : MODE_MANUAL].preset;
+    }
+    static const char* key(OperationMode mode) {
+        return _table.entries[(unsigned)mode < _table.count ? mode : MODE_MANUAL].key;
+    }
+    static const char* label(OperationMode mode) {
+        return _table.entries[(unsigned)mode < _table.count ? mode : MODE_MANUAL].label;
+    }
+    /// Id da chave via índice hash; chave desconhecida → MODE_MANUAL
+    static OperationMode find(const char* key);
+
+    static uint8_t count()   { return _table.count; }
+    static int     version() { return _table.version; }
+    /// Chaves separadas por vírgula (para o app listar os modos)
+    static String  keyList();
+
+private:
+    struct Table {
+        uint16_t  format;
+        int32_t   version;                ///< 0 = só embutidos
+        uint8_t   count;
+        ModeEntry entries[MODE_TABLE_MAX];
+    };
+
+    static Table   _table;
+    static uint8_t _index[HASH_SLOTS];    ///< id + 1 por slot (0 = vazio)
+
+    static void _loadBuiltins(Table& t);
+    static void _rebuildIndex();
+    static bool _parseLine(char* line, Table& t, String& error);
+};
 
-        // ─── INCUBAÇÃO ────────────────────────────────────────────────────────
-        // Substrato selado em sacos. Micélio coloniza em escuro e seco.
-        // Temp ideal Pleurotus: 22-28°C. Sem luz. Sem umidade externa.
-        case MODE_INCUBACAO:
-            return {
-                /* tempMin */          22.0f,
-                /* tempMax */          28.0f,
-                /* humidityMin */      50.0f,  // irrelevante (umidif. desligado)
-                /* humidityMax */      70.0f,  // irrelevante
-                /* co2Setpoint */      2000,   // tolerância maior (sacos fechados produzem CO2)
-                /* luxSetpoint */      0,      // sem setpoint de luz
-                /* humidifierEnabled*/ false,  // ← DESLIGADO: sacos são selados
-                /* ledsEnabled */      false,  // ← DESLIGADO: fase escura
-                /* peltierEnabled */   true,   // ← ATIVO: controla temperatura
-                /* exhaustForcedOn */  false,  // exaustor apenas por CO2
-                /* schedulerActive */  false,
-                /* solarSim */         false,
-                /* ledOnHour */        0,
-                /* ledOnMinute */      0,
-                /* ledOffHour */       0,
-                /* ledOffMinute */     0,
-                /* ledIntensity */     0
-            };
+// =============================================================================
+// CONVERSÃO ENUM ↔ STRING
+// =============================================================================
 
-        // ─── FRUTIFICAÇÃO ─────────────────────────────────────────────────────
-        // Sacos abertos ou blocos expostos. Alta umidade, ciclo de luz 12h.
-        // Temp ideal Pleurotus frutificação: 18-24°C.
-        case MODE_FRUTIFICACAO:
-            return {
-                /* tempMin */          18.0f,
-                /* tempMax */          24.0f,
-                /* humidityMin */      85.0f,  // ← alta umidade essencial
-                /* humidityMax */      95.0f,
-                /* co2Setpoint */      800,    // ← baixo CO2 estimula primórdios
-                /* luxSetpoint */      3000,
-                /* humidifierEnabled*/ true,   // ← ATIVO: umidade alta
-                /* ledsEnabled */      true,   // ← ATIVO: ciclo de luz
-                /* peltierEnabled */   true,
-                /* exhaustForcedOn */  false,
-                /* schedulerActive */  true,   // ← ativa scheduler automaticamente
-                /* solarSim */         false,  // timer fixo (12h)
-                /* ledOnHour */        6,
-                /* ledOnMinute */      0,
-                /* ledOffHour */       18,
-                /* ledOffMinute */     0,
-                /* ledIntensity */     180     // ~70% de intensidade
-            };
+/**
+ * @brief Converte string do Firebase para enum OperationMode
+ * @param str String do Firebase (ex: "frutificacao", "ostra_frut")
+ * @return OperationMode correspondente (padrão: MODE_MANUAL)
+ */
+inline OperationMode operationModeFromString(const String& str) {
+    return ModeTable::find(str.c_str());
+}
 
-        // ─── SECAGEM ─────────────────────────────────────────────────────────
-        // Pós-colheita. Reduz umidade. Exaustor contínuo para secar o ambiente.
-        case MODE_SECAGEM:
-            return {
-                /* tempMin */          20.0f,
-                /* tempMax */          35.0f,  // faixa larga — sem controle ativo
-                /* humidityMin */      30.0f,
-                /* humidityMax */      50.0f,  // umidade baixa desejada
-                /* co2Setpoint */      1000,
-                /* luxSetpoint */      0,
-                /* humidifierEnabled*/ false,  // ← DESLIGADO
-                /* ledsEnabled */      false,  // ← DESLIGADO
-                /* peltierEnabled */   false,  // ← DESLIGADO: economia de energia
-                /* exhaustForcedOn */  true,   // ← exaustor SEMPRE ligado para secar
-                /* schedulerActive */  false,
-                /* solarSim */         false,
-                /* ledOnHour */        0,
-                /* ledOnMinute */      0,
-                /* ledOffHour */       0,
-                /* ledOffMinute */     0,
-                /* ledIntensity */     0
-            };
+/**
+ * @brief Converte enum OperationMode para string do Firebase
+ * @param mode Enum OperationMode
+ * @return String correspondente (ex: "frutificacao")
+ */
+inline String operationModeToString(OperationMode mode) {
+    return ModeTable::key(mode);
+}
 
-        // ─── MANUTENÇÃO ──────────────────────────────────────────────────────
-        // Sem cultivo. Tudo desligado. Ideal para limpeza/esterilização.
-        case MODE_MANUTENCAO:
-            return {
-                /* tempMin */          10.0f,  // faixa muito larga = Peltier nunca aciona
-                /* tempMax */          40.0f,
-                /* humidityMin */      0.0f,
-                /* humidityMax */      100.0f,
-                /* co2Setpoint */      5000,   // exaustor nunca aciona
-                /* luxSetpoint */      0,
-                /* humidifierEnabled*/ false,
-                /* ledsEnabled */      false,
-                /* peltierEnabled */   false,
-                /* exhaustForcedOn */  false,
-                /* schedulerActive */  false,
-                /* solarSim */         false,
-                /* ledOnHour */        0,
-                /* ledOnMinute */      0,
-                /* ledOffHour */       0,
-                /* ledOffMinute */     0,
-                /* ledIntensity */     0
-            };
+/**
+ * @brief Retorna nome legível do modo para logs
+ */
+inline String operationModeLabel(OperationMode mode) {
+    return ModeTable::label(mode);
+}
 
-        // ─── MANUAL (padrão) ─────────────────────────────────────────────────
-        // Sem restrições. Tudo controlado pelos setpoints do app.
-        default: // MODE_MANUAL
-            return {
-                /* tempMin */          20.0f,
-                /* tempMax */          30.0f,
-                /* humidityMin */      60.0f,
-                /* humidityMax */      80.0f,
-                /* co2Setpoint */      1000,
-                /* luxSetpoint */      5000,
-                /* humidifierEnabled*/ true,
-                /* ledsEnabled */      true,
-                /* peltierEnabled */   true,
-                /* exhaustForcedOn */  false,
-                /* schedulerActive */  false,
-                /* solarSim */         false,
-                /* ledOnHour */        6,
-                /* ledOnMinute */      0,
-                /* ledOffHour */       20,
-                /* ledOffMinute */     0,
-                /* ledIntensity */     255
-            };
-    }
+/**
+ * @brief Retorna o preset de configuração para um modo de operação
+ *
+ * @details Valores embutidos em OperationMode.cpp (literatura de cultivo de
+ * Pleurotus ostreatus, Lentinula edodes, Ganoderma lucidum), substituíveis
+ * pela tabela do Firebase. Acesso direto por índice.
+ *
+ * @param mode Modo de operação desejado
+ * @return ModePreset com todos os parâmetros configurados
+ */
+inline ModePreset getModePreset(OperationMode mode) {
+    return ModeTable::preset(mode);
 }
 
 #endif // OPERATION_MODE_H
@@ -0,0 +1,129 @@
+#ifndef PID_CONTROLLER_H
+#define PID_CONTROLLER_H
+
+#include <Arduino.h>
+
+/**
+ * @file PIDController.h
+ * @brief PID discreto com anti-windup e saída por proporção de tempo (relé)
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Os atuadores térmicos/umidade da estufa são relés (liga/desliga).
+ * O PID produz um duty cycle contínuo que é convertido em tempo ligado dentro
+ * de uma janela fixa (time-proportioning):
+ *
+ *   duty 0.25, janela 120 s →  ███████░░░░░░░░░░░░░░░░░░░░░░  (30 s on / 90 s off)
+ *
+ *  PID:
+ *  ─────────────────────────────────────
+ *  - Derivada sobre a medição (sem "kick" quando o setpoint muda).
+ *  - Anti-windup por integração condicional: o integrador não acumula
+ *    quando a saída está saturada no mesmo sentido do erro, e o termo I é
+ *    limitado a [outMin, outMax].
+ *  - hold(): congela o integrador enquanto o atuador está bloqueado por uma
+ *    proteção externa (cooldown, sensor inoperante) — evita acumular erro
+ *    que o atuador não tem como corrigir.
+ *
+ *  PROPORÇÃO DE TEMPO:
+ *  ─────────────────────────────────────
+ *  - Duty < minOn/janela é arredondado para 0 (não liga por pulsos curtos).
+ *  - Duty > 1 - minOff/janela é arredondado para 1 (não desliga por instantes).
+ *  - Uma vez ligado, o relé só desliga após minOnMs; uma vez desligado, só
+ *    religa após minOffMs — independentemente de mudanças no duty.
+ */
+
+/**
+ * @struct PidGains
+ * @brief Conjunto de ganhos (persistido na NVS / obtido pelo autotune)
+ */
+struct PidGains {
+    float kp;
+    float ki;
+    float kd;
+};
+
+/**
+ * @class PIDController
+ * @brief PID posicional com anti-windup; unidade da saída definida por outMin/outMax
+ */
+class PIDController {
+public:
+    float kp = 0.0f;
+    float ki = 0.0f;   ///< Ganho integral (por segundo)
+    float kd = 0.0f;   ///< Ganho derivativo (segundos)
+
+    PIDController(float kp, float ki, float kd, float outMin, float outMax)
+        : kp(kp), ki(ki), kd(kd), _outMin(outMin), _outMax(outMax) {}
+
+    void setGains(float p, float i, float d) { kp = p; ki = i; kd = d; }
+    void setGains(const PidGains& g) { setGains(g.kp, g.ki, g.kd); }
+    PidGains gains() const { PidGains g = {kp, ki, kd}; return g; }
+    void setOutputLimits(float outMin, float outMax);
+
+    /**
+     * @brief Executa um passo do controlador
+     *
+     * @param error       setpoint - medição (já com banda morta aplicada pelo chamador)
+     * @param measurement Medição atual (usada na derivada)
+     * @param dtSec       Intervalo desde o último passo (s); ≤0 → só termo P
+     * @return Saída limitada a [outMin, outMax]
+     */
+    float compute(float error, float measurement, float dtSec);
+
+    /// Congela o integrador e descarta o histórico da derivada (atuador bloqueado)
+    void hold() { _hasLast = false; }
+
+    /// Zera integrador e histórico
+    void reset();
+
+    float output()   const { return _output; }
+    float integral() const { return _integral; }
+
+private:
+    float _outMin;
+    float _outMax;
+    float _integral    = 0.0f;
+    float _lastMeas    = 0.0f;
+    bool  _hasLast     = false;
+    float _output      = 0.0f;
+};
+
+/**
+ * @class TimeProportionalOutput
+ * @brief Converte duty [0..1] em liga/desliga dentro de uma janela fixa
+ */
+class TimeProportionalOutput {
+public:
+    TimeProportionalOutput(unsigned long windowMs, unsigned long minOnMs, unsigned long minOffMs)
+        : _window(windowMs), _minOn(minOnMs), _minOff(minOffMs) {}
+
+    void configure(unsigned long windowMs, unsigned long minOnMs, unsigned long minOffMs);
+
+    /**
+     * @brief Decide o estado do relé para o instante atual
+     * @param duty Fração da janela com o relé ligado (0..1)
+     * @param now  millis()
+     * @return true = relé deve estar ligado
+     */
+    bool update(float duty, unsigned long now);
+
+    /// Força desligado (proteção externa) — respeita minOff a partir de agora
+    void forceOff(unsigned long now);
+
+    bool          isOn()     const { return _on; }
+    unsigned long windowMs() const { return _window; }
+    unsigned long minOnMs()  const { return _minOn; }
+    unsigned long minOffMs() const { return _minOff; }
+
+private:
+    unsigned long _window;
+    unsigned long _minOn;
+    unsigned long _minOff;
+    unsigned long _windowStart = 0;
+    unsigned long _lastSwitch  = 0;
+    bool          _on          = false;
+    bool          _started     = false;
+};
+
+#endif // PID_CONTROLLER_H
@@ -0,0 +1,63 @@
+#ifndef PELTIER_THERMAL_MODEL_H
+#define PELTIER_THERMAL_MODEL_H
+
+#include <Arduino.h>
+
+/**
+ * @file PeltierThermalModel.h
+ * @brief Estimativa térmica de 1ª ordem do dissipador do Peltier no aquecimento
+ * @version 1.0
+ * @date 2026
+ *
+ * @details O limite fixo de 5 min de aquecimento + 1 min de cooldown ignorava
+ * a carga: numa noite fria o módulo aguentaria mais, num dia quente menos.
+ * Sem sensor no dissipador, a elevação sobre o ambiente é estimada a partir
+ * do histórico de tempo ligado:
+ *
+ *   ligado   : ΔT → riseFullC   com constante de tempo tauSec
+ *   desligado: ΔT → 0           com a mesma constante
+ *   T_sink   = T_ambiente + ΔT  (ambiente ≈ temperatura da câmara)
+ *
+ *   Com os padrões (τ = 180 s, ΔT∞ = 60 °C, limite 65 °C), a partir do frio:
+ *     ambiente 10 °C → ~7,5 min   20 °C → ~4 min   30 °C → ~2,5 min
+ *
+ *  PROTEÇÃO:
+ *  ─────────────────────────────────────
+ *  - overLimit(): T_sink ≥ sinkLimitC → cooldown
+ *  - canResume(): T_sink ≤ sinkLimitC - resumeMarginC (histerese)
+ *  - hardMaxOnMs / minCooldownMs continuam como teto/piso fixos de segurança,
+ *    independentes do modelo.
+ *  - No boot o estado real é desconhecido: parte de ΔT = riseFullC/2
+ *    (conservador — decai em poucos minutos se o módulo estava frio).
+ */
+class PeltierThermalModel {
+public:
+    float tauSec        = 180.0f;   ///< Constante de tempo do dissipador
+    float riseFullC     = 60.0f;    ///< Elevação em regime com o Peltier sempre ligado
+    float sinkLimitC    = 65.0f;    ///< T_sink máxima estimada antes do cooldown
+    float resumeMarginC = 15.0f;    ///< Queda exigida para sair do cooldown
+    unsigned long hardMaxOnMs   = 600000UL;   ///< Teto absoluto de aquecimento contínuo
+    unsigned long minCooldownMs = 30000UL;    ///< Cooldown mínimo
+
+    /// Reinicia o estado (boot) com a elevação conservadora
+    void reset(unsigned long now);
+
+    /**
+     * @brief Integra o modelo até now
+     * @param heating Peltier aquecendo no intervalo desde a última chamada
+     * @param ambient Temperatura ambiente (°C); NAN mantém a última válida
+     */
+    void update(bool heating, float ambient, unsigned long now);
+
+    float rise()     const { return _rise; }
+    float sinkTemp() const { return _ambient + _rise; }
+    bool  overLimit() const { return sinkTemp() >= sinkLimitC; }
+    bool  canResume() const { return sinkTemp() <= sinkLimitC - resumeMarginC; }
+
+private:
+    float         _rise       = 0.0f;
+    float         _ambient    = 25.0f;
+    unsigned long _lastUpdate = 0;
+};
+
+#endif // PELTIER_THERMAL_MODEL_H
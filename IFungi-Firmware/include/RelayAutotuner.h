@@ -0,0 +1,110 @@
+#ifndef RELAY_AUTOTUNER_H
+#define RELAY_AUTOTUNER_H
+
+#include <Arduino.h>
+
+/**
+ * @file RelayAutotuner.h
+ * @brief Autotune por realimentação a relé (Åström–Hägglund) para as malhas da estufa
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Cada câmara tem volume, isolamento e potência diferentes — um único
+ * conjunto de ganhos não serve para todas. O autotune substitui o PID por um
+ * relé com histerese em torno do setpoint, o que força a malha a oscilar no
+ * seu período crítico:
+ *
+ *   medição   ╭─╮     ╭─╮     ╭─╮
+ *   sp + h ──/───\───/───\───/───\──
+ *   sp - h ─/─────\─/─────\─/─────\─
+ *   relé    ▔▔▔▔▁▁▁▁▁▔▔▔▔▁▁▁▁▁▔▔▔▔      (amplitude d)
+ *
+ *  IDENTIFICAÇÃO:
+ *  ─────────────────────────────────────
+ *  a  = metade da excursão pico-a-pico média da medição
+ *  Pu = período médio entre subidas consecutivas do relé
+ *  Ku = 4·d / (π·a)                          (ganho crítico — função descritiva)
+ *
+ *  GANHOS (Ziegler–Nichols, forma paralela, Ki em 1/s, Kd em s):
+ *  ─────────────────────────────────────
+ *  PID: Kp = 0.6·Ku   Ki = 1.2·Ku/Pu   Kd = 0.075·Ku·Pu
+ *  PI : Kp = 0.45·Ku  Ki = 0.54·Ku/Pu  Kd = 0
+ *
+ *  O primeiro ciclo é descartado (transitório de partida). O processo falha
+ *  por timeout ou se a amplitude for desprezível (sensor travado / atuador
+ *  sem efeito).
+ */
+
+enum AutotuneState : uint8_t {
+    AUTOTUNE_IDLE    = 0,
+    AUTOTUNE_RUNNING = 1,
+    AUTOTUNE_DONE    = 2,
+    AUTOTUNE_FAILED  = 3
+};
+
+enum AutotuneRule : uint8_t {
+    AUTOTUNE_RULE_PID = 0,
+    AUTOTUNE_RULE_PI  = 1
+};
+
+class RelayAutotuner {
+public:
+    /**
+     * @brief Inicia um ensaio
+     *
+     * @param setpoint     Centro da oscilação
+     * @param hysteresis   Histerese do relé (unidade da medição) — acima do ruído do sensor
+     * @param amplitude    d: metade da excursão da saída (±1 → 1.0; 0/1 → 0.5)
+     * @param cycles       Ciclos medidos (após o ciclo descartado)
+     * @param timeoutMs    Duração máxima do ensaio
+     * @param rule         Regra de sintonia
+     */
+    void start(float setpoint, float hysteresis, float amplitude,
+               uint8_t cycles, unsigned long timeoutMs, AutotuneRule rule);
+
+    /**
+     * @brief Processa uma amostra
+     * @return true = relé na posição "alta" (aquecer / umidificar)
+     */
+    bool update(float measurement, unsigned long now);
+
+    void abort(const char* reason);
+
+    AutotuneState state()  const { return _state; }
+    bool isRunning()       const { return _state == AUTOTUNE_RUNNING; }
+    const char* failReason() const { return _failReason; }
+    uint8_t cyclesDone()   const { return _cyclesDone; }
+
+    float ku() const { return _ku; }
+    float pu() const { return _pu; }    ///< segundos
+    float kp() const { return _kp; }
+    float ki() const { return _ki; }
+    float kd() const { return _kd; }
+
+private:
+    AutotuneState _state = AUTOTUNE_IDLE;
+    AutotuneRule  _rule  = AUTOTUNE_RULE_PID;
+
+    float _setpoint   = 0.0f;
+    float _hysteresis = 0.0f;
+    float _amplitude  = 1.0f;
+    uint8_t _cyclesWanted = 3;
+    unsigned long _timeout = 0;
+    unsigned long _startedAt = 0;
+
+    bool  _high = true;
+    float _peakMax = 0.0f;
+    float _peakMin = 0.0f;
+    unsigned long _lastRise = 0;
+    bool  _seenRise = false;
+    uint8_t _cyclesDone = 0;     ///< inclui o ciclo descartado
+    float _sumAmplitude = 0.0f;
+    float _sumPeriod    = 0.0f;
+
+    float _ku = 0.0f, _pu = 0.0f, _kp = 0.0f, _ki = 0.0f, _kd = 0.0f;
+    const char* _failReason = "";
+
+    void _finish();
+};
+
+#endif // RELAY_AUTOTUNER_H
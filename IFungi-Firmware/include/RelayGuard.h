@@ -0,0 +1,92 @@
+#ifndef RELAY_GUARD_H
+#define RELAY_GUARD_H
+
+#include <Arduino.h>
+
+/**
+ * @file RelayGuard.h
+ * @brief Proteção contra desgaste dos relés: tempo mínimo de permanência,
+ *        limite de comutações por hora e contadores de vida útil
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Relés eletromecânicos têm vida útil especificada em nº de
+ * comutações (tipicamente 100k sob carga). Leituras oscilando em torno de um
+ * limiar fazem o umidificador/exaustor "metralhar" e consomem essa vida.
+ *
+ *  REGRAS (por relé, 1..4):
+ *  ─────────────────────────────────────
+ *  - minOnMs : depois de ligar, só desliga após este tempo
+ *  - minOffMs: depois de desligar, só religa após este tempo
+ *  - maxSwitchesPerHour: comutações na última hora (6 baldes de 10 min).
+ *    Só adia o ligar, e só se não couber o par ligar+desligar; o desligar
+ *    depende apenas de minOnMs.
+ *  - Chamadas de segurança (force=true) ignoram as regras, mas são contadas.
+ *
+ *  CONTADORES (NVS namespace "relay-wear", chaves "c1".."c4"):
+ *  ─────────────────────────────────────
+ *  Gravação em lote para poupar a flash: a cada WEAR_FLUSH_SWITCHES
+ *  comutações pendentes ou WEAR_FLUSH_INTERVAL_MS após a primeira pendente.
+ *  Uma queda de energia perde no máximo um lote.
+ */
+
+struct RelayWearConfig {
+    unsigned long minOnMs;
+    unsigned long minOffMs;
+    uint16_t      maxSwitchesPerHour;   ///< 0 = sem limite
+};
+
+class RelayGuard {
+public:
+    static const uint8_t RELAYS = 4;
+
+    /// Configura as regras de um relé (1..4)
+    void configure(uint8_t relay, const RelayWearConfig& cfg);
+    const RelayWearConfig& config(uint8_t relay) const { return _r[_idx(relay)].cfg; }
+
+    /// Carrega contadores da NVS e libera a primeira comutação de cada relé
+    void begin();
+
+    /**
+     * @brief Verifica se o relé pode ir para newState agora
+     * @details Conta e loga (com limitação) as comutações bloqueadas.
+     */
+    bool permit(uint8_t relay, bool newState, unsigned long now);
+
+    /// Registra uma comutação efetivada
+    void record(uint8_t relay, bool newState, unsigned long now);
+
+    /// Grava os contadores se o lote encheu ou expirou
+    void flushIfDue(unsigned long now);
+    /// Grava os contadores pendentes imediatamente
+    void flush();
+
+    uint32_t lifetimeSwitches(uint8_t relay) const { return _r[_idx(relay)].lifetime; }
+    uint32_t blockedSwitches(uint8_t relay)  const { return _r[_idx(relay)].blocked; }
+    uint16_t switchesLastHour(uint8_t relay, unsigned long now) const;
+
+private:
+    static const uint8_t       WEAR_BUCKETS           = 6;
+    static const unsigned long WEAR_BUCKET_MS         = 10UL * 60UL * 1000UL;
+    static const uint8_t       WEAR_FLUSH_SWITCHES    = 50;
+    static const unsigned long WEAR_FLUSH_INTERVAL_MS = 30UL * 60UL * 1000UL;
+
+    struct RelayWear {
+        RelayWearConfig cfg          = {0, 0, 0};
+        bool            state        = false;
+        unsigned long   lastChange   = 0;
+        uint32_t        lifetime     = 0;
+        uint32_t        blocked      = 0;
+        unsigned long   lastBlockLog = 0;
+        uint16_t        bucketCount[WEAR_BUCKETS] = {};
+        uint32_t        bucketEpoch[WEAR_BUCKETS] = {};
+    };
+
+    RelayWear     _r[RELAYS];
+    uint16_t      _pending        = 0;
+    unsigned long _firstPendingAt = 0;
+
+    static uint8_t _idx(uint8_t relay) { return (relay >= 1 && relay <= RELAYS) ? relay - 1 : 0; }
+};
+
+#endif // RELAY_GUARD_H
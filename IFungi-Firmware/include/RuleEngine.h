@@ -0,0 +1,141 @@
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include <Arduino.h>
+
+/**
+ * @file RuleEngine.h
+ * @brief Regras de automação definidas pelo usuário, compiladas no dispositivo
+ *        para bytecode e avaliadas por um interpretador de passo fixo
+ * @version 1.0
+ * @date 2026
+ *
+ * @details As automações fixas de controlAutomatically() (alarme de gás,
+ * faixas de umidade, LED por LDR) continuam existindo; as regras acrescentam
+ * comportamentos sem OTA. Fonte sincronizada do Firebase (/regras/fonte),
+ * uma regra por linha (ou separadas por ';'):
+ *
+ *   if tvocs > 300 for 10 min then exhaust on 5 min
+ *   if humidity > 95 or not (temp < 30) then humidifier off
+ *   if light < 200 and co2 < 1500 then led 180 30 min
+ *
+ *  GRAMÁTICA:
+ *  ─────────────────────────────────────
+ *  regra    := "if" cond ["for" duração] "then" ação
+ *  cond     := e ("or" e)*
+ *  e        := fator ("and" fator)*
+ *  fator    := "not" fator | "(" cond ")" | operando CMP operando
+ *  operando := SENSOR | NÚMERO       SENSOR: temp humidity light co co2 tvocs water
+ *  CMP      := > < >= <= == !=
+ *  ação     := ATUADOR ("on" | "off" | NÚMERO) [duração]
+ *              ATUADOR: exhaust humidifier led (NÚMERO = intensidade do LED)
+ *  duração  := NÚMERO ["s" | "min" | "h"]
+ *
+ *  EXECUÇÃO:
+ *  ─────────────────────────────────────
+ *  - Condição em pós-fixa: LOAD/CONST/comparação/AND/OR/NOT, pilha de
+ *    RULE_STACK_DEPTH (profundidade verificada na compilação).
+ *  - Orçamento de RULE_STEP_BUDGET instruções por ciclo de controle: regras
+ *    que não couberem são avaliadas no ciclo seguinte (round-robin), mantendo
+ *    o último resultado — o tempo por ciclo é limitado independente do nº de
+ *    regras.
+ *  - "for": a condição precisa ficar verdadeira continuamente pelo tempo
+ *    indicado. Ação com duração fica ativa pelo tempo indicado e só volta a
+ *    disparar após novo período "for"; sem duração vale enquanto a condição.
+ *  - Conflitos: exaustor "on" vence; umidificador "off" vence; LED usa a
+ *    maior intensidade. Regras não derrubam intertravamentos de segurança.
+ *  - Sensor inválido (NAN) em qualquer operando torna a condição inteira
+ *    falsa — inclusive sob "not" e em ramos "or" com os demais sensores
+ *    válidos: regra nenhuma dispara com leitura inválida.
+ *  - '#' comenta até o fim da linha, inclusive ';' seguintes.
+ */
+
+/// Entradas das regras (snapshot do ciclo de controle)
+enum RuleSensor : uint8_t {
+    RULE_SENSOR_TEMP = 0,
+    RULE_SENSOR_HUMIDITY,
+    RULE_SENSOR_LIGHT,
+    RULE_SENSOR_CO,
+    RULE_SENSOR_CO2,
+    RULE_SENSOR_TVOCS,
+    RULE_SENSOR_WATER,      ///< 1 = nível de água baixo
+    RULE_SENSOR_COUNT
+};
+
+enum RuleActuator : uint8_t {
+    RULE_ACT_EXHAUST = 0,
+    RULE_ACT_HUMIDIFIER,
+    RULE_ACT_LED,
+    RULE_ACT_COUNT
+};
+
+/// Resultado das regras: -1 = sem opinião
+struct RuleOverrides {
+    int8_t  exhaust;      ///< -1 / 0 desliga / 1 liga
+    int8_t  humidifier;   ///< -1 / 0 desliga / 1 liga
+    int16_t led;          ///< -1 / intensidade 0-255
+};
+
+class RuleEngine {
+public:
+    static const uint8_t  RULE_MAX          = 16;
+    static const uint16_t RULE_CODE_SIZE    = 512;   ///< Bytecode de todas as regras
+    static const uint8_t  RULE_MAX_CODE     = 64;    ///< Bytecode por regra
+    static const uint8_t  RULE_STACK_DEPTH  = 8;
+    static const uint16_t RULE_STEP_BUDGET  = 192;   ///< Instruções por ciclo
+
+    /**
+     * @brief Compila a fonte e, se tudo compilar, substitui as regras atuais
+     * @param source Regras, uma por linha ou separadas por ';' ('#' comenta)
+     * @param error  Mensagem com nº da regra em caso de falha
+     * @return false mantém as regras anteriores
+     */
+    bool load(const String& source, String& error);
+    void clear();
+
+    /**
+     * @brief Avalia as regras (dentro do orçamento) e compõe as ações ativas
+     * @param inputs Valores indexados por RuleSensor
+     */
+    RuleOverrides evaluate(const float inputs[RULE_SENSOR_COUNT], unsigned long now);
+
+    uint8_t  ruleCount() const { return _prog.count; }
+    uint16_t codeSize()  const { return _prog.codeUsed; }
+    /// Regras com ação ativa no último evaluate()
+    uint8_t  activeCount() const { return _active; }
+
+private:
+    struct Rule {
+        uint16_t      codeStart;
+        uint8_t       codeLen;
+        uint8_t       actuator;
+        int16_t       value;      ///< 0/1 (relés) ou intensidade (LED)
+        unsigned long holdMs;     ///< "for"
+        unsigned long durationMs; ///< 0 = enquanto a condição
+    };
+
+    /// Programa compilado — valor simples, trocado inteiro em load()
+    struct Program {
+        Rule     rules[RULE_MAX];
+        uint8_t  count;
+        uint16_t codeUsed;
+        uint8_t  code[RULE_CODE_SIZE];
+    };
+
+    struct RuleState {
+        bool          cond;
+        unsigned long trueSince;   ///< Início do trecho verdadeiro atual
+        unsigned long firedAt;
+        bool          firing;
+    };
+
+    Program   _prog = {};
+    RuleState _state[RULE_MAX] = {};
+    uint8_t   _cursor = 0;
+    uint8_t   _active = 0;
+
+    bool _run(const Rule& r, const float inputs[RULE_SENSOR_COUNT]) const;
+    static bool _compileRule(const char* text, Program& prog, String& error);
+};
+
+#endif // RULE_ENGINE_H
@@ -0,0 +1,119 @@
+#ifndef SAFETY_SUPERVISOR_H
+#define SAFETY_SUPERVISOR_H
+
+#include <Arduino.h>
+
+class ActuatorController;
+class SensorController;
+
+/**
+ * @file SafetySupervisor.h
+ * @brief Task de supervisão com limites rígidos aplicados direto nos relés
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Os intertravamentos (DHT inoperante corta o Peltier, água baixa
+ * corta o umidificador, teto de aquecimento) viviam só em
+ * controlAutomatically(): não rodavam em modo debug e esperavam a loopTask ou
+ * a lifeSupportTask — um travamento de rede com um relé ligado deixava a
+ * carga energizada. Esta task roda a cada PERIOD_MS com prioridade acima das
+ * tasks da aplicação e não depende de actuatorMutex, sensorMutex nem Firebase.
+ *
+ *  LIMITES (por relé: R1 Peltier, R2 sentido/aquecimento, R3 umidificador,
+ *  R4 exaustor):
+ *  ─────────────────────────────────────
+ *  - Leitura parada (nenhum update() dos sensores há staleMs): R1, R2, R3.
+ *  - DHT22 inoperante ou temperatura NAN: R1, R2, R3.
+ *  - Temperatura ≥ maxTemp: R2 (aquecimento); resfriamento continua
+ *    permitido. Libera abaixo de maxTemp − tempHysteresis.
+ *  - Água baixa: R3.
+ *  - Tempo ligado contínuo ≥ maxOnMs[relé] (0 = sem limite): o relé fica
+ *    bloqueado por lockoutMs. Padrões acima dos tetos do controle
+ *    (hardMaxOnMs do Peltier = 10 min) — só atuam se o controle falhar.
+ *  Exaustor ligado é o lado seguro: só o limite de tempo (desativado) vale.
+ *
+ *  ATUAÇÃO:
+ *  ─────────────────────────────────────
+ *  ActuatorController::safetyEnforce() grava a máscara de bloqueio e corta os
+ *  pinos numa seção crítica (portMUX) compartilhada com writeRelay(): o
+ *  controle nunca religa um relé bloqueado, em nenhum modo. Cortar R2 com o
+ *  Peltier aquecendo corta R1 junto (sem inversão de polaridade em carga).
+ *  Contadores de energia/desgaste são acertados no próximo ciclo de controle.
+ *
+ *  Cada corte de saída energizada conta uma intervenção por motivo
+ *  (telemetria /telemetria/seguranca). A task não escreve na Serial: grava
+ *  contadores, máscara de bloqueio e relés cortados, e a loop os registra.
+ *
+ *  Sem memória para a task (xTaskCreatePinnedToCore falhou), begin() devolve
+ *  false e poll() roda os períodos a partir da loop — sem a independência de
+ *  prioridade, mas com os mesmos limites.
+ */
+
+enum SafetyReason : uint8_t {
+    SAFETY_SENSOR_STALE = 0,   ///< Sem leitura nova dos sensores
+    SAFETY_DHT_FAULT    = 1,   ///< DHT22 inoperante / temperatura NAN
+    SAFETY_OVER_TEMP    = 2,   ///< Temperatura acima de maxTemp
+    SAFETY_WATER_LOW    = 3,   ///< Nível de água baixo
+    SAFETY_MAX_ON_TIME  = 4,   ///< Relé ligado continuamente além do limite
+    SAFETY_REASONS      = 5
+};
+
+struct SafetyLimits {
+    float         maxTemp        = 40.0f;
+    float         tempHysteresis = 2.0f;
+    unsigned long staleMs        = 30000UL;
+    unsigned long maxOnMs[4]     = {0UL, 15UL * 60000UL, 30UL * 60000UL, 0UL};   ///< R1..R4
+    unsigned long lockoutMs      = 2UL * 60000UL;
+};
+
+class SafetySupervisor {
+public:
+    static const unsigned long PERIOD_MS     = 250;
+    /// Acima das tasks da aplicação (1), abaixo das de WiFi/lwIP (18-23)
+    static const UBaseType_t   TASK_PRIORITY = 10;
+
+    SafetyLimits limits;   ///< Ajustar antes de begin()
+
+    /**
+     * @brief Cria a task (core 0); sensores e atuadores já inicializados
+     * @return false se a task não foi criada — chamar poll() da loop
+     */
+    bool begin(ActuatorController& actuators, SensorController& sensors);
+
+    /// Task criada por begin()
+    bool running() const { return _handle != nullptr; }
+
+    /// Reserva sem task: um período se já passou PERIOD_MS desde o último
+    void poll();
+
+    uint32_t     interventions(SafetyReason reason) const { return _count[reason]; }
+    uint32_t     totalInterventions() const;
+    SafetyReason lastReason() const { return _lastReason; }
+    /// Relés bloqueados no último período (bit n-1 = relé n)
+    uint8_t      inhibitMask() const { return _inhibit; }
+    /// Relés cortados na última intervenção
+    uint8_t      lastCutMask() const { return _lastCut; }
+
+    static const char* reasonName(SafetyReason reason);
+
+private:
+    ActuatorController* _actuators = nullptr;
+    SensorController*   _sensors   = nullptr;
+    TaskHandle_t        _handle    = nullptr;
+
+    volatile uint32_t     _count[SAFETY_REASONS] = {};
+    volatile SafetyReason _lastReason = SAFETY_SENSOR_STALE;
+    volatile uint8_t      _inhibit    = 0;
+    volatile uint8_t      _lastCut    = 0;
+
+    bool          _overTemp = false;
+    unsigned long _onSince[4]     = {};   ///< 0 = desligado
+    unsigned long _lockedUntil[4] = {};
+    bool          _locked[4]      = {};
+    unsigned long _lastPoll       = 0;
+
+    static void task(void* parameter);
+    void step();
+};
+
+#endif // SAFETY_SUPERVISOR_H
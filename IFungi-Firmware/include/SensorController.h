@@ -4,6 +4,43 @@
 #include <Arduino.h>
 #include <DHT.h>
 #include <Adafruit_CCS811.h>
+#include "SensorRegistry.h"
+#include "LightCalibration.h"
+
+// =============================================================================
+// INSTÂNCIAS DE SENSOR (tempo de compilação)
+//
+// Câmaras maiores podem ter várias sondas DHT22 fundidas numa única leitura.
+// Exemplo no platformio.ini:
+//   -DIFUNGI_DHT_PINS=33,25,26
+//   -DIFUNGI_DHT_FUSION=FUSION_MEAN
+// =============================================================================
+
+#ifndef IFUNGI_DHT_PINS
+#define IFUNGI_DHT_PINS 33
+#endif
+#ifndef IFUNGI_DHT_FUSION
+#define IFUNGI_DHT_FUSION FUSION_MEDIAN
+#endif
+#ifndef IFUNGI_LDR_PINS
+#define IFUNGI_LDR_PINS 34
+#endif
+#ifndef IFUNGI_LDR_FUSION
+#define IFUNGI_LDR_FUSION FUSION_MEAN
+#endif
+
+namespace SensorConfig {
+    constexpr uint8_t DHT_PINS[]  = { IFUNGI_DHT_PINS };
+    constexpr uint8_t DHT_COUNT   = sizeof(DHT_PINS) / sizeof(DHT_PINS[0]);
+    constexpr uint8_t LDR_PINS[]  = { IFUNGI_LDR_PINS };
+    constexpr uint8_t LDR_COUNT   = sizeof(LDR_PINS) / sizeof(LDR_PINS[0]);
+
+    static_assert(DHT_COUNT >= 1 && DHT_COUNT <= 4, "IFUNGI_DHT_PINS: 1 a 4 sondas DHT22");
+    static_assert(LDR_COUNT >= 1 && LDR_COUNT <= 4, "IFUNGI_LDR_PINS: 1 a 4 LDRs");
+}
+
+typedef SensorGroup<Dht22Driver,  SensorConfig::DHT_COUNT> DhtGroup;
+typedef SensorGroup<AnalogDriver, SensorConfig::LDR_COUNT> LdrGroup;
 
 class SensorController {
 public:
@@ -15,38 +52,117 @@ public:
     int getCO2();
     /// CO estimado em ppm (MQ-7; após warmup). Não altera leituras do DHT22.
     int getCO();
+    /// Luz em lux (curva de LightCalibration); sem calibração = contagem crua do ADC
     int getLight();
+    /// Contagem crua do ADC do LDR (0-4095)
+    int getLightRaw() const { return lightRaw; }
     int getTVOCs();
-    bool isDHTHealthy() const { return dhtOK; }
+    bool isDHTHealthy() const { return dhtGroup.healthy(); }
     bool isCCS811Healthy() const { return ccsOK; }
+    /// CCS811 operante E fora do período de condicionamento — eCO2/TVOC confiáveis
+    bool isCCS811Ready() const;
     bool isMQ7Healthy() const { return millis() >= mq7WarmupUntil; }
     bool isLDRHealthy() const { return true; }
     bool isWaterLevelHealthy() const { return true; }
-    
+
+    /**
+     * @brief Fonte de tempo Unix (s) para datar o baseline do CCS811
+     * @details Sem relógio plausível o baseline não é salvo nem restaurado.
+     */
+    void setClock(unsigned long (*nowFn)()) { clockFn = nowFn; }
+
+    // ─── Notificação de snapshot ─────────────────────────────────────────────
+    static const uint8_t MAX_SNAPSHOT_LISTENERS = 2;
+
+    /**
+     * @brief Registra uma task para receber xTaskNotifyGive() a cada snapshot novo
+     * @details Um snapshot é publicado ao fim de update() somente quando algum
+     * valor entregue ao controle mudou — a task acordada nunca reprocessa
+     * entradas idênticas. Registrar antes de iniciar as leituras.
+     * @return false se a tabela de listeners está cheia
+     */
+    bool addSnapshotListener(TaskHandle_t task);
+    /// Nº de snapshots publicados desde o boot
+    uint32_t snapshotSequence() const { return snapshotSeq; }
+    /// millis() da publicação do último snapshot (instante de liberação do controle)
+    unsigned long snapshotMillis() const { return snapshotMs; }
+    /// millis() do último ciclo de leitura de update() (0 = nenhum) — idade dos dados
+    unsigned long lastReadMillis() const { return lastUpdate; }
+
+    /// Grupo de sondas DHT22 (saúde e leitura por instância)
+    const DhtGroup& dhtProbes() const { return dhtGroup; }
+    /// Grupo de LDRs (leitura por instância)
+    const LdrGroup& ldrProbes() const { return ldrGroup; }
+
+    // ─── Calibração do LDR (NVS "ldrcal") ────────────────────────────────────
+    /**
+     * @brief Pareia a leitura crua atual do LDR com o lux do luxímetro
+     * @details Chamar com sensorMutex — remonta a tabela usada em update().
+     * @return false mantém a calibração anterior (error descreve o motivo)
+     */
+    bool captureLightPoint(float lux, String& error);
+    /// Apaga a calibração (getLight() volta à contagem crua). Chamar com sensorMutex.
+    void clearLightCalibration();
+    const LightCalibration& lightCalibration() const { return ldrCal; }
+
 private:
     static const uint8_t MQ7_PIN = 35;
-    static const uint8_t DHT_PIN = 33;
-    static const uint8_t LDR_PIN = 34;
     static const uint8_t WATERLEVEL_PIN = 32;
     
-    DHT dht{DHT_PIN, DHT22};
+    DhtGroup dhtGroup{IFUNGI_DHT_FUSION};
+    LdrGroup ldrGroup{IFUNGI_LDR_FUSION};
+    LightCalibration ldrCal;
     Adafruit_CCS811 ccs;
     
-    bool dhtOK;
     bool ccsOK;
     unsigned long lastUpdate;
     
-    uint8_t       dhtFailCount    = 0;
     uint8_t       ccsFailCount    = 0;
-    unsigned long dhtRecoveryTime = 0;
     unsigned long ccsRecoveryTime = 0;
+
+    // ─── Baseline do CCS811 (NVS "ccs811") ───────────────────────────────────
+    /// Condicionamento sem baseline restaurado (datasheet: 20 min)
+    static const unsigned long CCS_CONDITIONING_MS           = 20UL * 60UL * 1000UL;
+    /// Estabilização com baseline restaurado
+    static const unsigned long CCS_WARM_START_MS             = 60UL * 1000UL;
+    /// Período entre gravações do baseline na NVS
+    static const unsigned long CCS_BASELINE_SAVE_INTERVAL_MS = 60UL * 60UL * 1000UL;
+    /// Idade máxima (s) de um baseline restaurável
+    static const unsigned long CCS_BASELINE_MAX_AGE_S        = 7UL * 24UL * 3600UL;
+
+    unsigned long ccsStartedAt     = 0;
+    unsigned long ccsReadyAt       = 0;
+    unsigned long lastBaselineSave = 0;
+    bool          ccsReadyLogged   = false;
+    unsigned long (*clockFn)()     = nullptr;
+
+    TaskHandle_t      snapshotListeners[MAX_SNAPSHOT_LISTENERS] = {};
+    uint8_t           snapshotListenerCount = 0;
+    volatile uint32_t snapshotSeq           = 0;
+    volatile unsigned long snapshotMs       = 0;
+
+    // Último snapshot publicado (comparado em publishSnapshotIfChanged)
+    struct Snapshot {
+        float temperature, humidity;
+        int   co2, co, tvocs, light;
+        bool  waterLevel, dhtOK, ccsReady;
+    };
+    Snapshot lastSnapshot = {NAN, NAN, -1, -1, -1, -1, false, false, false};
+
+    void publishSnapshotIfChanged();
+
+    unsigned long nowEpoch() const;
+    void onCCS811Started();
+    bool restoreCCS811Baseline();
+    void saveCCS811Baseline();
     
     float temperature;
     float humidity;
     int co2;
     int co;           ///< CO em ppm (MQ-7)
     int tvocs;
-    int light;
+    int light;        ///< lux (ou contagem crua sem calibração)
+    int lightRaw = 0; ///< Contagem do ADC do LDR
     bool waterLevel;
 
     unsigned long mq7WarmupUntil = 0;
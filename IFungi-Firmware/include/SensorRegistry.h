@@ -0,0 +1,277 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <Arduino.h>
+#include <DHT.h>
+
+/**
+ * @file SensorRegistry.h
+ * @brief Registro de drivers de sensor com múltiplas instâncias e fusão
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Permite ligar N sondas do mesmo tipo (ex.: 2-4 DHT22 numa câmara
+ * grande) e publicar um único valor fundido por canal.
+ *
+ *  INTERFACE DE DRIVER (polimorfismo estático — sem virtual no hot path):
+ *  ─────────────────────────────────────
+ *    static const uint8_t CHANNELS;          // nº de grandezas por leitura
+ *    static const char*   name();            // rótulo para logs
+ *    void attach(uint8_t pin);               // associa o pino (antes de begin)
+ *    void begin();                           // inicializa o hardware
+ *    bool read(float out[CHANNELS]);         // false = leitura inválida
+ *    bool recover(float out[CHANNELS]);      // reinicia + relê (instância caída)
+ *
+ *  SAÚDE POR INSTÂNCIA:
+ *  ─────────────────────────────────────
+ *  Cada instância tem seu contador de falhas consecutivas. Após maxFails
+ *  falhas ela é marcada inoperante e só volta via recover(), tentado a cada
+ *  recoveryIntervalMs. Instâncias inoperantes não entram na fusão.
+ *
+ *  POLÍTICAS DE FUSÃO:
+ *  ─────────────────────────────────────
+ *  FUSION_MEAN   → média das instâncias saudáveis
+ *  FUSION_MEDIAN → mediana (robusta a uma sonda descalibrada; com 2 = média)
+ *  FUSION_MIN    → menor valor (conservador p/ aquecimento)
+ *  FUSION_MAX    → maior valor (conservador p/ resfriamento)
+ *
+ *  A quantidade de instâncias e os pinos são definidos em tempo de
+ *  compilação (ver tabelas em SensorController.h).
+ */
+
+enum FusionPolicy : uint8_t {
+    FUSION_MEAN   = 0,
+    FUSION_MEDIAN = 1,
+    FUSION_MIN    = 2,
+    FUSION_MAX    = 3
+};
+
+/**
+ * @struct SensorInstanceHealth
+ * @brief Estado de saúde de uma instância de sensor
+ */
+struct SensorInstanceHealth {
+    bool          ok            = false; ///< Instância operante (entra na fusão)
+    uint8_t       failCount     = 0;     ///< Falhas consecutivas de leitura
+    unsigned long recoveryTime  = 0;     ///< millis() da última falha/tentativa de recuperação
+    uint32_t      totalFailures = 0;     ///< Falhas acumuladas desde o boot
+};
+
+// =============================================================================
+// DRIVERS
+// =============================================================================
+
+/**
+ * @class Dht22Driver
+ * @brief Driver DHT22 — canal 0 = temperatura (°C), canal 1 = umidade (%)
+ */
+class Dht22Driver {
+public:
+    static const uint8_t CHANNEL_TEMPERATURE = 0;
+    static const uint8_t CHANNEL_HUMIDITY    = 1;
+    static const uint8_t CHANNELS            = 2;
+
+    static const char* name() { return "DHT22"; }
+
+    void attach(uint8_t pin);
+    void begin();
+    bool read(float out[CHANNELS]);
+    bool recover(float out[CHANNELS]);
+
+private:
+    DHT*    _dht = nullptr;
+    uint8_t _pin = 0xFF;
+};
+
+/**
+ * @class AnalogDriver
+ * @brief Driver genérico de ADC (LDR, sondas analógicas) — canal 0 = contagem bruta
+ */
+class AnalogDriver {
+public:
+    static const uint8_t CHANNELS = 1;
+
+    static const char* name() { return "ADC"; }
+
+    void attach(uint8_t pin) { _pin = pin; }
+    void begin()             { pinMode(_pin, INPUT); }
+    bool read(float out[CHANNELS]) {
+        out[0] = (float)analogRead(_pin);
+        return true;
+    }
+    bool recover(float out[CHANNELS]) { return read(out); }
+
+private:
+    uint8_t _pin = 0xFF;
+};
+
+// =============================================================================
+// FUSÃO
+// =============================================================================
+
+/**
+ * @brief Funde n valores conforme a política. Reordena o buffer (mediana).
+ * @return NAN quando n == 0
+ */
+float fuseSensorValues(float* values, uint8_t n, FusionPolicy policy);
+
+// =============================================================================
+// GRUPO DE INSTÂNCIAS
+// =============================================================================
+
+/**
+ * @class SensorGroup
+ * @brief N instâncias de um mesmo driver, com saúde individual e valor fundido
+ *
+ * @tparam Driver Classe que satisfaz a interface de driver descrita acima
+ * @tparam N      Número de instâncias (fixo em tempo de compilação)
+ */
+template <typename Driver, uint8_t N>
+class SensorGroup {
+public:
+    static_assert(N > 0, "SensorGroup precisa de pelo menos uma instancia");
+    static const uint8_t COUNT    = N;
+    static const uint8_t CHANNELS = Driver::CHANNELS;
+
+    explicit SensorGroup(FusionPolicy policy = FUSION_MEDIAN,
+                         uint8_t maxFails = 3,
+                         unsigned long recoveryIntervalMs = 30000)
+        : _policy(policy), _maxFails(maxFails), _recoveryInterval(recoveryIntervalMs) {
+        for (uint8_t c = 0; c < CHANNELS; c++) _fused[c] = NAN;
+    }
+
+    /// Associa os pinos às instâncias (tabela constexpr do SensorController)
+    void attach(const uint8_t (&pins)[N]) {
+        for (uint8_t i = 0; i < N; i++) {
+            _pins[i] = pins[i];
+            _drivers[i].attach(pins[i]);
+        }
+    }
+
+    /**
+     * @brief Inicializa todas as instâncias e tenta uma leitura válida de cada
+     *
+     * @param attempts     Tentativas de leitura por instância
+     * @param retryDelayMs Espera entre tentativas (DHT22 precisa de ≥250 ms)
+     * @param settleMs     Espera única após begin() de todas as instâncias
+     * @return Nº de instâncias operantes
+     */
+    uint8_t begin(uint8_t attempts, unsigned long retryDelayMs, unsigned long settleMs) {
+        for (uint8_t i = 0; i < N; i++) _drivers[i].begin();
+        if (settleMs > 0) delay(settleMs);
+
+        for (uint8_t i = 0; i < N; i++) {
+            SensorInstanceHealth& h = _health[i];
+            h = SensorInstanceHealth();
+            for (uint8_t a = 0; a < attempts && !h.ok; a++) {
+                if (a > 0) delay(retryDelayMs);
+                if (_drivers[i].read(_values[i])) {
+                    h.ok = true;
+                } else {
+                    Serial.printf("[sensor] %s#%u (GPIO %u): tentativa %u/%u sem leitura valida\n",
+                                  Driver::name(), i, _pins[i], a + 1, attempts);
+                }
+            }
+            if (!h.ok) {
+                h.recoveryTime = millis();
+                Serial.printf("[sensor] %s#%u (GPIO %u): ERRO - nao responde apos %u tentativas\n",
+                              Driver::name(), i, _pins[i], attempts);
+            }
+        }
+        _fuse();
+        return healthyCount();
+    }
+
+    /**
+     * @brief Lê todas as instâncias operantes e tenta recuperar as inoperantes
+     *
+     * @details Uma instância vai para inoperante após maxFails leituras
+     * inválidas consecutivas; a recuperação é tentada a cada recoveryIntervalMs.
+     * O valor fundido é recalculado ao final.
+     *
+     * @return true se ao menos uma instância está operante
+     */
+    bool sample() {
+        unsigned long now = millis();
+        for (uint8_t i = 0; i < N; i++) {
+            SensorInstanceHealth& h = _health[i];
+            float tmp[CHANNELS];
+
+            if (h.ok) {
+                if (_drivers[i].read(tmp)) {
+                    memcpy(_values[i], tmp, sizeof(tmp));
+                    h.failCount = 0;
+                } else {
+                    h.failCount++;
+                    h.totalFailures++;
+                    Serial.printf("[sensor] %s#%u: leitura invalida (%u/%u falhas consecutivas)\n",
+                                  Driver::name(), i, h.failCount, _maxFails);
+                    if (h.failCount >= _maxFails) {
+                        h.ok           = false;
+                        h.recoveryTime = now;
+                        Serial.printf("[sensor] %s#%u: INOPERANTE — fora da fusao ate recuperar\n",
+                                      Driver::name(), i);
+                    }
+                }
+            } else if (now - h.recoveryTime >= _recoveryInterval) {
+                Serial.printf("[sensor] %s#%u: tentando recuperacao...\n", Driver::name(), i);
+                if (_drivers[i].recover(tmp)) {
+                    memcpy(_values[i], tmp, sizeof(tmp));
+                    h.ok        = true;
+                    h.failCount = 0;
+                    Serial.printf("[sensor] %s#%u: RECUPERADO\n", Driver::name(), i);
+                } else {
+                    h.recoveryTime = millis();
+                    Serial.printf("[sensor] %s#%u: recuperacao falhou, nova tentativa em %lus\n",
+                                  Driver::name(), i, _recoveryInterval / 1000UL);
+                }
+            }
+        }
+        _fuse();
+        return healthy();
+    }
+
+    /// Valor fundido do canal (NAN se nenhuma instância operante)
+    float value(uint8_t channel) const { return channel < CHANNELS ? _fused[channel] : NAN; }
+
+    bool    healthy() const { return healthyCount() > 0; }
+    uint8_t healthyCount() const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < N; i++) if (_health[i].ok) n++;
+        return n;
+    }
+
+    bool  instanceHealthy(uint8_t i) const { return i < N && _health[i].ok; }
+    float instanceValue(uint8_t i, uint8_t channel) const {
+        return (i < N && channel < CHANNELS && _health[i].ok) ? _values[i][channel] : NAN;
+    }
+    const SensorInstanceHealth& instanceHealth(uint8_t i) const { return _health[i < N ? i : 0]; }
+    uint8_t instancePin(uint8_t i) const { return _pins[i < N ? i : 0]; }
+
+    FusionPolicy policy() const { return _policy; }
+    void setPolicy(FusionPolicy p) { _policy = p; _fuse(); }
+
+private:
+    Driver               _drivers[N];
+    uint8_t              _pins[N] = {};
+    SensorInstanceHealth _health[N];
+    float                _values[N][CHANNELS] = {};
+    float                _fused[CHANNELS];
+
+    FusionPolicy  _policy;
+    uint8_t       _maxFails;
+    unsigned long _recoveryInterval;
+
+    void _fuse() {
+        float buf[N];
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            uint8_t n = 0;
+            for (uint8_t i = 0; i < N; i++) {
+                if (_health[i].ok) buf[n++] = _values[i][c];
+            }
+            _fused[c] = fuseSensorValues(buf, n, _policy);
+        }
+    }
+};
+
+#endif // SENSOR_REGISTRY_H
@@ -0,0 +1,67 @@
+#ifndef SETPOINT_RAMP_H
+#define SETPOINT_RAMP_H
+
+#include <Arduino.h>
+
+/**
+ * @file SetpointRamp.h
+ * @brief Rampa entre os setpoints configurados (alvo) e os usados nas malhas (efetivos)
+ * @version 1.0
+ * @date 2026
+ *
+ * @details applySetpoints() e applyOperationMode() trocavam as faixas de
+ * temperatura/umidade num degrau: de incubação (22-28 °C) para frutificação
+ * (18-24 °C) o Peltier resfriava no máximo por horas e a cultura sofria o
+ * choque. Agora os valores configurados são só o alvo; a cada ciclo de
+ * controle o efetivo anda no máximo rate × Δt em direção ao alvo.
+ *
+ *  REGRAS:
+ *  ─────────────────────────────────────
+ *  - Taxa 0 = troca imediata (comportamento antigo) no canal.
+ *  - O primeiro update() parte do alvo: setpoints da NVS/defaults aplicados
+ *    no boot não geram rampa.
+ *  - Mínimo e máximo andam na mesma taxa; o efetivo mínimo nunca passa do
+ *    máximo.
+ *  - Δt limitado a RAMP_MAX_STEP_MS: pausa longa do controle (debug, OTA)
+ *    não resulta em salto.
+ */
+
+enum RampChannel : uint8_t {
+    RAMP_TEMP_MIN = 0,
+    RAMP_TEMP_MAX,
+    RAMP_HUMIDITY_MIN,
+    RAMP_HUMIDITY_MAX,
+    RAMP_CHANNELS
+};
+
+class SetpointRamp {
+public:
+    static const unsigned long RAMP_MAX_STEP_MS = 60000UL;
+
+    float tempRatePerHour     = 1.0f;    ///< °C/h (0 = imediato)
+    float humidityRatePerHour = 10.0f;   ///< %UR/h (0 = imediato)
+
+    void setTarget(RampChannel ch, float value) { _target[ch] = value; }
+    /// Efetivo = alvo em todos os canais
+    void snap();
+
+    /**
+     * @brief Avança os efetivos até now
+     * @return true se algum canal ainda não alcançou o alvo
+     */
+    bool update(unsigned long now);
+
+    float target(RampChannel ch)    const { return _target[ch]; }
+    float effective(RampChannel ch) const { return _effective[ch]; }
+    bool  ramping() const;
+
+private:
+    float         _target[RAMP_CHANNELS]    = {};
+    float         _effective[RAMP_CHANNELS] = {};
+    unsigned long _lastUpdate  = 0;
+    bool          _initialized = false;
+
+    static float _approach(float value, float target, float maxStep);
+};
+
+#endif // SETPOINT_RAMP_H
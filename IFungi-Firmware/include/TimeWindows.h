@@ -0,0 +1,103 @@
+#ifndef TIME_WINDOWS_H
+#define TIME_WINDOWS_H
+
+#include <Arduino.h>
+
+/**
+ * @file TimeWindows.h
+ * @brief Núcleo de agendamento por janelas de horário, comum ao LEDScheduler
+ *        e ao ExhaustScheduler
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Os dois schedulers repetiam a mesma comparação "início <= agora <
+ * fim" e rejeitavam fim <= início — fotoperíodo noturno (20:00-08:00) era
+ * impossível. Este núcleo aceita várias janelas por dia, janelas que cruzam a
+ * meia-noite e máscara de dias da semana.
+ *
+ *  FORMATO (campo opcional "windows" nos nós de agenda do Firebase):
+ *  ─────────────────────────────────────
+ *    "06:00-12:00; 14:00-20:00@12345; 20:00-08:00@06"
+ *
+ *  - Janelas separadas por ';' ou ','. Fim "24:00" aceito.
+ *  - Fim antes do início: a janela cruza a meia-noite. A máscara vale para o
+ *    dia em que a janela COMEÇA (20:00-08:00@5 = sexta 20h até sábado 8h).
+ *  - "@dias": dígitos 0-6 (0 = domingo). Sem '@' = todos os dias.
+ *  - Texto vazio: vale a janela única onHour:onMinute-offHour:offMinute dos
+ *    campos antigos (setDefaultWindow) — apps antigos continuam funcionando.
+ *  - Janelas sobrepostas se unem.
+ *
+ *  AVALIAÇÃO O(1):
+ *  ─────────────────────────────────────
+ *  Na mudança de configuração ou ao cruzar uma transição, o estado atual, o
+ *  início do bloco (última transição) e a próxima transição são calculados
+ *  varrendo as fronteiras das janelas (até TW_SCAN_DAYS dias). Entre
+ *  transições isOn() só compara o timestamp com o intervalo em cache. Relógio
+ *  que volta (ajuste de NTP) também força o recálculo.
+ *
+ *  O timestamp é o de getCurrentTimestamp() (já no fuso local); o dia da
+ *  semana é derivado dele (01/01/1970 = quinta-feira).
+ */
+
+struct TimeWindow {
+    uint16_t startMin;  ///< Minuto do dia de início (0-1439)
+    uint16_t endMin;    ///< Minuto do dia de fim (0-1440); < startMin cruza a meia-noite
+    uint8_t  days;      ///< Bit n = dia n da semana (0 = domingo)
+};
+
+class TimeWindowSchedule {
+public:
+    static const uint8_t       TW_MAX_WINDOWS = 8;
+    static const uint8_t       TW_ALL_DAYS    = 0x7F;
+    static const uint8_t       TW_SCAN_DAYS   = 8;
+    static const unsigned long TW_NEVER       = 0xFFFFFFFFUL;
+
+    /**
+     * @brief Define as janelas a partir do texto (ver formato acima)
+     * @return false mantém as janelas anteriores (error descreve a entrada)
+     */
+    bool setText(const String& text, String& error);
+
+    /**
+     * @brief Janela única dos campos antigos — usada só com texto vazio
+     * @details Sem efeito se os minutos não mudaram; fim == início desativa.
+     */
+    void setDefaultWindow(int startMin, int endMin);
+
+    /// Estado no timestamp — O(1) entre transições
+    bool isOn(unsigned long ts);
+
+    /// Início do bloco atual (ligado ou desligado); 0 = sem transição anterior
+    unsigned long blockStart() const { return _blockStart; }
+    /// Próxima transição; TW_NEVER = estado não muda
+    unsigned long nextChange() const { return _nextChange; }
+
+    uint8_t       count()     const { return _count; }
+    bool          hasCustom() const { return _text.length() > 0; }
+    const String& text()      const { return _text; }
+    /// Texto das janelas ou "HH:MM-HH:MM" da janela padrão (para logs)
+    String        label()     const;
+    /// Incrementado a cada troca de janelas — usado na persistência
+    uint32_t      revision()  const { return _revision; }
+
+    static uint8_t dayOfWeek(unsigned long ts) { return (uint8_t)((ts / 86400UL + 4UL) % 7UL); }
+
+private:
+    TimeWindow    _windows[TW_MAX_WINDOWS] = {};
+    uint8_t       _count       = 0;
+    String        _text;
+    int           _defaultStart = -1;
+    int           _defaultEnd   = -1;
+    uint32_t      _revision     = 0;
+
+    bool          _dirty       = true;
+    bool          _on          = false;
+    unsigned long _blockStart  = 0;
+    unsigned long _nextChange  = 0;
+
+    bool _stateAtMinute(uint32_t minute) const;
+    void _recompute(unsigned long ts);
+    static bool _parseEntry(char* entry, TimeWindow& w, String& error);
+};
+
+#endif // TIME_WINDOWS_H
@@ -0,0 +1,94 @@
+#ifndef TIMING_PROBE_H
+#define TIMING_PROBE_H
+
+#include <Arduino.h>
+
+/**
+ * @file TimingProbe.h
+ * @brief Instrumentação de regularidade das malhas: atraso de ativação,
+ *        tempo de execução e prazos perdidos em histogramas fixos
+ * @version 1.0
+ * @date 2026
+ *
+ * @details Cada execução instrumentada tem três instantes:
+ *
+ *   release ──(jitter)──▶ start ──(exec)──▶ stop
+ *   └──────────────── resposta ────────────────┘   resposta > deadline → perdido
+ *
+ *  - beginWait(): a execução passa a esperar o hardware (fade do LEDC). O
+ *    exec para ali e o restante até stop() vai para o histograma de espera —
+ *    não conta como CPU nem disputa o pior estágio; ainda conta no prazo.
+ *
+ *  - release: quando a execução passou a ser devida (snapshot publicado,
+ *    fallback vencido, notificação de novo alvo). Sem release, jitter = 0.
+ *  - Histogramas de 7 faixas por década (<0,1 ms … ≥10 s) para jitter,
+ *    exec e espera — sem alocação, custo O(1) por amostra.
+ *  - Pior estágio: a maior execução observada (sondas + handlers do loop) é
+ *    gravada em RTC junto ao rtcLastStage e sobrevive a reset por WDT/pânico.
+ *
+ * Cada sonda deve ser atualizada por uma única task; a leitura para o
+ * relatório de saúde tolera valores momentaneamente inconsistentes.
+ */
+class TimingProbe {
+public:
+    static const uint8_t BINS = 7;
+
+    TimingProbe(const char* name, uint32_t deadlineUs) : _name(name), _deadlineUs(deadlineUs) {}
+
+    /// Instante (esp_timer_get_time) em que a execução se tornou devida
+    void release(int64_t atUs) { _releaseUs = atUs; _released = true; }
+    void start();
+    /// Fim do trabalho de CPU: daqui até stop() é espera (só a 1ª chamada vale)
+    void beginWait();
+    void stop();
+
+    const char* name()        const { return _name; }
+    uint32_t    count()       const { return _count; }
+    uint32_t    missed()      const { return _missed; }
+    uint32_t    maxExecUs()   const { return _maxExecUs; }
+    uint32_t    maxJitterUs() const { return _maxJitterUs; }
+    uint32_t    waitCount()   const { return _waitCount; }
+    uint32_t    maxWaitUs()   const { return _maxWaitUs; }
+    const uint32_t* execHistogram()   const { return _execHist; }
+    const uint32_t* jitterHistogram() const { return _jitterHist; }
+    const uint32_t* waitHistogram()   const { return _waitHist; }
+
+    /// Resumo de uma linha: n, perdidos, máx/p99 de exec e jitter (e espera)
+    void summary(char* buf, size_t len) const;
+
+    /// Rótulo do limite superior da faixa (ex.: "<10ms")
+    static const char* binLabel(uint8_t bin);
+
+    // ─── Pior estágio (RTC) ──────────────────────────────────────────────────
+    /// Registra uma duração; atualiza o pior estágio se for a maior até agora
+    static void noteStage(const char* stage, uint32_t us);
+    static const char* worstStage();
+    static uint32_t    worstStageUs();
+    /// Zera o pior estágio (após registrar o do boot anterior)
+    static void resetWorstStage();
+
+private:
+    const char* _name;
+    uint32_t    _deadlineUs;
+    int64_t     _releaseUs   = 0;
+    int64_t     _startUs     = 0;
+    int64_t     _waitUs      = 0;
+    bool        _released    = false;
+    bool        _waiting     = false;
+    uint32_t    _jitterUs    = 0;
+
+    uint32_t    _count       = 0;
+    uint32_t    _missed      = 0;
+    uint32_t    _maxExecUs   = 0;
+    uint32_t    _maxJitterUs = 0;
+    uint32_t    _waitCount   = 0;
+    uint32_t    _maxWaitUs   = 0;
+    uint32_t    _execHist[BINS]   = {};
+    uint32_t    _jitterHist[BINS] = {};
+    uint32_t    _waitHist[BINS]   = {};
+
+    static uint8_t _bin(uint32_t us);
+    static uint8_t _p99(const uint32_t* hist, uint32_t total);
+};
+
+#endif // TIMING_PROBE_H
@@ -2,11 +2,13 @@
 #define EXHAUST_SCHEDULER_H
 
 #include <Arduino.h>
+#include "TimeWindows.h"
+#include "RelayGuard.h"
 
 /**
  * @file exhaustScheduler.h
  * @brief Sistema de agendamento por horário do exaustor (ventilação)
- * @version 1.0
+ * @version 1.2
  * @date 2026
  *
  * @details Gerencia o modo de operação por horário fixo do exaustor
@@ -15,7 +17,24 @@
  *  MODO TIMER (scheduleEnabled = true):
  *  ─────────────────────────────────────
  *  Liga/desliga o exaustor em horários fixos configurados no Firebase.
- *  Exemplo: ligar às 06:00, desligar às 20:00.
+ *  Exemplo: ligar às 06:00, desligar às 20:00. Desde a v1.2 a janela é
+ *  avaliada pelo TimeWindowSchedule (TimeWindows.h): pode cruzar a
+ *  meia-noite e o campo opcional "windows" define várias janelas/dias.
+ *
+ *  MODO CICLO (cycleEnabled = true) — troca de ar "N min a cada M min":
+ *  ─────────────────────────────────────
+ *  - Sem timer: cicla o dia todo (cycleOnMinutes a cada cyclePeriodMinutes).
+ *  - Com timer: dentro da janela usa cycleOnMinutes; fora dela
+ *    cycleOutsideOnMinutes (0 = desligado) — duty por janela.
+ *  - jitterMinutes > 0: fase do ciclo deslocada por dispositivo (semente do
+ *    MAC) e início de cada ciclo sorteado em [0, jitter] de forma
+ *    determinística (hash semente + nº do ciclo) — estufas de um mesmo
+ *    galpão não ligam os exaustores juntas, e o ciclo não muda após reboot.
+ *  - O ciclo é função só do timestamp: nenhum estado a persistir.
+ *  - fitCycleToRelay() ajusta o ciclo às regras de desgaste do relé 4
+ *    (RelayGuard): ligado ≥ minOn, desligado ≥ minOff mesmo com o jitter e
+ *    no máximo maxSwitchesPerHour comutações. Ciclo recebido que as violaria
+ *    é corrigido e os valores efetivos voltam ao Firebase.
  *
  *  PRIORIDADE (ver ActuatorController::controlAutomatically):
  *  ─────────────────────────────────────
@@ -30,7 +49,13 @@
  *    "onHour":   6,       // hora de ligar (0-23)
  *    "onMinute": 0,       // minuto de ligar (0-59)
  *    "offHour":  20,      // hora de desligar (0-23)
- *    "offMinute": 0       // minuto de desligar (0-59)
+ *    "offMinute": 0,      // minuto de desligar (0-59)
+ *    "cycleEnabled": true,          // campos opcionais (v1.1): ausentes =
+ *    "cycleOnMinutes": 5,           // mantém o valor atual; apps antigos
+ *    "cyclePeriodMinutes": 30,      // continuam funcionando
+ *    "cycleOutsideOnMinutes": 0,
+ *    "jitterMinutes": 3,
+ *    "windows": ""                  // opcional (v1.2): substitui onHour..offMinute
  *  }
  */
 class ExhaustScheduler {
@@ -44,6 +69,15 @@ public:
     int  offHour          = 20;   ///< Hora de fim (0-23)
     int  offMinute        = 0;    ///< Minuto de fim (0-59)
 
+    bool cycleEnabled          = false; ///< Ciclo de troca de ar
+    int  cycleOnMinutes        = 5;     ///< Minutos ligado por período (na janela / dia todo)
+    int  cyclePeriodMinutes    = 30;    ///< Período do ciclo
+    int  cycleOutsideOnMinutes = 0;     ///< Minutos ligado por período fora da janela
+    int  jitterMinutes         = 0;     ///< Dessincronização entre dispositivos (0 = alinhado ao relógio)
+
+    /// Janelas do timer — campos on/off acima viram a janela padrão (ver TimeWindows.h)
+    TimeWindowSchedule windows;
+
     // ─── Interface pública ────────────────────────────────────────────────────
 
     /**
@@ -57,10 +91,23 @@ public:
     void update(unsigned long currentTimestamp, bool debugMode);
 
     /**
-     * @brief Retorna se o scheduler está ativo (timer habilitado)
-     * @return true se scheduleEnabled
+     * @brief Retorna se o scheduler está ativo (timer ou ciclo habilitado)
      */
-    bool isActive() const { return scheduleEnabled; }
+    bool isActive() const { return scheduleEnabled || cycleEnabled; }
+
+    /**
+     * @brief Ajusta o ciclo às regras de desgaste do relé do exaustor
+     *
+     * @details Eleva minutos ligados abaixo de minOn, alonga o período para
+     * caber minOff e o limite de comutações/hora e reduz o jitter até que o
+     * intervalo desligado mínimo (período − ligado − jitter) respeite minOff.
+     *
+     * @return true se algum campo do ciclo mudou
+     */
+    bool fitCycleToRelay(const RelayWearConfig& relay);
+
+    /// Semente do deslocamento de fase/jitter (única por dispositivo)
+    void setDeviceSeed(uint32_t seed) { _seed = seed; }
 
     /**
      * @brief Retorna se o scheduler quer o exaustor ligado agora
@@ -69,7 +116,11 @@ public:
     bool wantsExhaustOn() const { return _exhaustOn; }
 
 private:
-    bool _exhaustOn = false; ///< Estado calculado: exaustor deve estar ligado?
+    bool     _exhaustOn = false; ///< Estado calculado: exaustor deve estar ligado?
+    uint32_t _seed      = 0;
+
+    /// Posição no ciclo: ligado por onMinutes a partir do início sorteado
+    bool _cycleWantsOn(unsigned long ts, int onMinutes) const;
 };
 
 #endif // EXHAUST_SCHEDULER_H
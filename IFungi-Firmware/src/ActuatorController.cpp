@@ -6,49 +6,324 @@
  *    Se dhtHealthy=false, Peltier é BLOQUEADO imediatamente e desligado,
  *    pois temperatura=NAN causaria comportamento indefinido nas comparações.
  *  - Temperatura NAN não é mais passada silenciosamente para lógica de controle.
+ *
+ * NOVIDADES (v1.2):
+ *  - Peltier controlado por PID com anti-windup + proporção de tempo (janela
+ *    configurável, tempos mínimos ligado/desligado) no lugar do liga/desliga
+ *    com histerese de ±0.5 °C. Faixa tempMin..tempMax vira banda morta do erro.
+ *    O aquecimento contínuo continua limitado (ver v1.8).
+ *
+ * NOVIDADES (v1.3):
+ *  - Autotune a relé (Åström–Hägglund) para temperatura e umidade, com ganhos
+ *    Ziegler–Nichols persistidos no namespace "setpoints" e carregados em
+ *    loadSetpointsNVS().
+ *
+ * NOVIDADES (v1.4):
+ *  - Todas as escritas nos relés passam por writeRelay() + RelayGuard:
+ *    tempo mínimo ligado/desligado, limite de comutações por hora e
+ *    contadores de vida útil na NVS ("relay-wear"). Caminhos de segurança
+ *    usam force=true (ignoram as regras, mas são contados).
+ *
+ * NOVIDADES (v1.5):
+ *  - LED no LEDC do ESP-IDF (canal/timer dedicados) com fade em hardware
+ *    (ledc_set_fade_with_time). ledPwmTask fica bloqueada em notificação
+ *    até controlLEDs() definir um novo alvo — zero CPU com LED estável.
+ *  - LEDC em 13 bits com correção perceptual CIE 1931 (tabela pré-calculada)
+ *    em ledLogicalToHardwarePwm(). A API lógica 0-255 (Firebase, scheduler)
+ *    não muda; os degraus baixos deixam de ser visivelmente grosseiros.
+ *
+ * NOVIDADES (v1.6):
+ *  - Damper do exaustor só é acionado em mudanças de alvo (setDamperTarget),
+ *    por uma task própria que faz a rampa em damperRampMs e desanexa o servo
+ *    após damperSettleMs — sem torque de retenção, jitter ou timer LEDC ocupado.
+ *  - Abertura do damper proporcional ao excesso de gás sobre o setpoint
+ *    (totalmente aberto em damperFullOpenExcess), com piso de ventilação
+ *    mínima damperMinFraction e quantização em 10 níveis.
+ *
+ * NOVIDADES (v1.7):
+ *  - Umidificador por pulsos (humidifierPulseMode): PI sobre o erro da faixa
+ *    humidityMin..humidityMax + proporção de tempo em R3, com o duty reduzido
+ *    pela taxa de subida filtrada da umidade (antecipa o overshoot da névoa
+ *    dos nebulizadores ultrassônicos). Intertravamentos de água/DHT/modo
+ *    inalterados; humidifierPulseMode=false volta ao liga/desliga com histerese.
+ *  - Umidificador e exaustor passam pelo ClimateArbiter: conflito adiável
+ *    (CO2/TVOC moderados, agenda) alterna rajada de ventilação e recuperação
+ *    de umidade; ventilação obrigatória pausa o umidificador. Tempo em cada
+ *    estado de conflito vai para a telemetria.
+ *
+ * NOVIDADES (v1.8):
+ *  - Limite fixo de aquecimento (5 min + 1 min de cooldown) substituído pelo
+ *    PeltierThermalModel: estimativa de 1ª ordem da temperatura do dissipador
+ *    a partir do histórico de tempo ligado e da temperatura ambiente. Corridas
+ *    mais longas no frio, cooldown antecipado no calor; teto hardMaxOnMs e
+ *    cooldown mínimo minCooldownMs mantidos.
+ *  - Contabilização de energia (EnergyMeter): potência nominal por carga
+ *    (energyRatings) integrada a cada comutação de relé e a cada ciclo de
+ *    controle; acumuladores diário/semanal/total em RTC + checkpoint na NVS.
+ *  - ledPwmTask instrumentada (TimingProbe): atraso entre o novo alvo e o
+ *    início do fade, cálculo até o disparo (exec), duração do fade (espera)
+ *    e prazos perdidos.
+ *
+ * NOVIDADES (v1.9):
+ *  - Regras do usuário (RuleEngine) sincronizadas do Firebase, compiladas
+ *    em bytecode e avaliadas a cada ciclo com orçamento fixo de instruções.
+ *    Entram como intenção (agenda do exaustor, malha de umidade, LED) —
+ *    intertravamentos de segurança e alarme de gás continuam prevalecendo.
+ *
+ * NOVIDADES (v1.10):
+ *  - Rampa de setpoints (SetpointRamp): troca de modo ou de setpoints no app
+ *    só muda o alvo; as faixas efetivas usadas pelo PID do Peltier e pela
+ *    malha de umidade andam tempRatePerHour/humidityRatePerHour por hora.
+ *
+ * NOVIDADES (v1.11):
+ *  - Agendas de LED e exaustor gravam as janelas (TimeWindowSchedule) na
+ *    chave "win" dos namespaces led-sched/exh-sched.
+ *  - Modo solar astronômico: astroEnabled/latitude/longitude nas chaves
+ *    "astEn"/"lat"/"lon" de led-sched.
+ *
+ * NOVIDADES (v1.12):
+ *  - LEDs sem agenda dimerizados em malha fechada pelo LDR (DaylightHarvester)
+ *    no lugar do liga em 255 / desliga no limiar de luxSetpoint.
+ *
+ * NOVIDADES (v1.13):
+ *  - SafetySupervisor: task de alta prioridade (250 ms) que bloqueia e corta
+ *    relés por leitura parada, DHT inoperante, temperatura máxima, água baixa
+ *    e tempo ligado contínuo — também em modo debug e com a loop travada.
+ *    writeRelay() e safetyEnforce() compartilham um portMUX; relé bloqueado
+ *    não liga (nem pelo devmode). Cortes da task são sincronizados no estado,
+ *    energia e RelayGuard por reconcileSafetyCuts() no próximo comando.
  */
 
 #include "ActuatorController.h"
 #include "OperationMode.h"
 #include <Preferences.h>
+#include <driver/ledc.h>
+#include <esp_timer.h>
 #include <cmath>  // isnan()
 
 // =============================================================================
-// LED — driver com PWM invertido (255 no pino = apagado, 0 = máximo brilho)
+// LED — driver com PWM invertido (duty máximo no pino = apagado, 0 = máximo brilho)
+//
+// LEDC do ESP-IDF em canal/timer fixos (LED_LEDC_*). O canal 7 / timer 3 do
+// grupo high-speed é o último que o alocador do Arduino (ESP32Servo,
+// analogWrite do devmode) entregaria, evitando disputa de timer com o servo.
 // =============================================================================
 
+static const ledc_mode_t      LED_LEDC_MODE       = LEDC_HIGH_SPEED_MODE;
+static const ledc_channel_t   LED_LEDC_CHANNEL    = LEDC_CHANNEL_7;
+static const ledc_timer_t     LED_LEDC_TIMER      = LEDC_TIMER_3;
+static const ledc_timer_bit_t LED_LEDC_RESOLUTION = LEDC_TIMER_13_BIT;   // 80 MHz / 2^13 ≥ 5 kHz
+static const uint32_t         LED_LEDC_FREQ_HZ    = 5000;
+static const uint32_t         LED_LEDC_MAX_DUTY   = (1U << 13) - 1;
+
+// Luminosidade CIE 1931 → duty de 13 bits, indexada pela intensidade lógica
+// 0-255. L* = v/255·100; Y = L*/903.3 (L* ≤ 8) ou ((L*+16)/116)³; duty = Y·8191.
+// Gerada offline — o passo de 1 unidade lógica é perceptualmente uniforme.
+static const uint16_t LED_CIE_LUT[256] = {
+       0,    4,    7,   11,   14,   18,   21,   25,   28,   32,   36,   39,   43,   46,   50,   53,
+      57,   60,   64,   68,   71,   75,   78,   82,   86,   90,   94,   99,  103,  108,  112,  117,
+     122,  127,  132,  138,  143,  149,  155,  161,  167,  173,  180,  186,  193,  200,  207,  214,
+     222,  229,  237,  245,  253,  261,  270,  278,  287,  296,  305,  315,  324,  334,  344,  354,
+     364,  375,  386,  396,  408,  419,  430,  442,  454,  466,  479,  491,  504,  517,  531,  544,
+     558,  572,  586,  600,  615,  630,  645,  661,  676,  692,  708,  725,  741,  758,  775,  793,
+     810,  828,  846,  865,  883,  902,  922,  941,  961,  981, 1001, 1022, 1043, 1064, 1085, 1107,
+    1129, 1151, 1174, 1197, 1220, 1244, 1267, 1291, 1316, 1341, 1366, 1391, 1416, 1442, 1469, 1495,
+    1522, 1549, 1577, 1605, 1633, 1661, 1690, 1719, 1749, 1779, 1809, 1840, 1870, 1902, 1933, 1965,
+    1997, 2030, 2063, 2096, 2130, 2164, 2198, 2233, 2268, 2304, 2339, 2376, 2412, 2449, 2487, 2524,
+    2562, 2601, 2640, 2679, 2719, 2759, 2799, 2840, 2881, 2923, 2965, 3007, 3050, 3093, 3136, 3181,
+    3225, 3270, 3315, 3361, 3407, 3453, 3500, 3548, 3595, 3643, 3692, 3741, 3791, 3841, 3891, 3942,
+    3993, 4045, 4097, 4149, 4202, 4256, 4310, 4364, 4419, 4474, 4530, 4586, 4643, 4700, 4757, 4816,
+    4874, 4933, 4993, 5053, 5113, 5174, 5235, 5297, 5360, 5422, 5486, 5550, 5614, 5679, 5744, 5810,
+    5876, 5943, 6010, 6078, 6147, 6215, 6285, 6355, 6425, 6496, 6567, 6639, 6712, 6785, 6858, 6932,
+    7007, 7082, 7158, 7234, 7311, 7388, 7466, 7544, 7623, 7703, 7783, 7863, 7944, 8026, 8108, 8191
+};
+
+/// Duração de um fade de 0 → 255 (fades menores são proporcionais)
+static const uint32_t LED_FADE_FULL_SCALE_MS = 1000;
+
 int ActuatorController::ledLogicalToHardwarePwm(int logical) {
     int v = logical;
     if (v < 0) v = 0;
     if (v > 255) v = 255;
-    return 255 - v;
+    return (int)(LED_LEDC_MAX_DUTY - LED_CIE_LUT[v]);   // PWM invertido
+}
+
+float ActuatorController::ledDutyForLogical(int logical) {
+    return 1.0f - (float)ledLogicalToHardwarePwm(logical) / (float)LED_LEDC_MAX_DUTY;
+}
+
+float ActuatorController::ledLogicalForDuty(float duty) {
+    if (isnan(duty) || duty <= 0.0f) return 0.0f;
+    if (duty >= 1.0f) return 255.0f;
+
+    // Tabela crescente: primeira entrada ≥ alvo + interpolação com a anterior
+    float want = duty * (float)LED_LEDC_MAX_DUTY;
+    int lo = 0, hi = 255;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (LED_CIE_LUT[mid] < want) lo = mid + 1;
+        else                         hi = mid;
+    }
+    if (lo == 0) return 0.0f;
+    float a = LED_CIE_LUT[lo - 1], b = LED_CIE_LUT[lo];
+    return (lo - 1) + (want - a) / (b - a);
+}
+
+void ActuatorController::setupLedHardware() {
+    ledc_timer_config_t timerCfg = {};
+    timerCfg.speed_mode      = LED_LEDC_MODE;
+    timerCfg.duty_resolution = LED_LEDC_RESOLUTION;
+    timerCfg.timer_num       = LED_LEDC_TIMER;
+    timerCfg.freq_hz         = LED_LEDC_FREQ_HZ;
+    timerCfg.clk_cfg         = LEDC_AUTO_CLK;
+    ledc_timer_config(&timerCfg);
+
+    ledc_channel_config_t chCfg = {};
+    chCfg.gpio_num   = _pinLED;
+    chCfg.speed_mode = LED_LEDC_MODE;
+    chCfg.channel    = LED_LEDC_CHANNEL;
+    chCfg.intr_type  = LEDC_INTR_DISABLE;
+    chCfg.timer_sel  = LED_LEDC_TIMER;
+    chCfg.duty       = (uint32_t)ledLogicalToHardwarePwm(0);   // nasce apagado
+    chCfg.hpoint     = 0;
+    ledc_channel_config(&chCfg);
+
+    // Serviço de fade (ISR do LEDC) — instalado uma única vez
+    ledc_fade_func_install(0);
 }
 
 void ActuatorController::writeLedHardwareFromLogical(int logical) {
-    analogWrite(_pinLED, ledLogicalToHardwarePwm(logical));
+    ledc_set_duty(LED_LEDC_MODE, LED_LEDC_CHANNEL, (uint32_t)ledLogicalToHardwarePwm(logical));
+    ledc_update_duty(LED_LEDC_MODE, LED_LEDC_CHANNEL);
+}
+
+void ActuatorController::fadeLedHardwareToLogical(int fromLogical, int toLogical) {
+    int delta = toLogical - fromLogical;
+    if (delta < 0) delta = -delta;
+    uint32_t fadeMs = (uint32_t)delta * LED_FADE_FULL_SCALE_MS / 255U;
+    if (fadeMs == 0) {
+        writeLedHardwareFromLogical(toLogical);
+        return;
+    }
+
+    // O fade do LEDC é linear em duty; a curva CIE não. Um fade longo é
+    // quebrado em trechos de até 32 passos lógicos, cada um linear, para que
+    // o brilho percebido acompanhe a curva (sem "salto" no início da rampa).
+    int segments = (delta + 31) / 32;
+    int step     = (toLogical > fromLogical) ? 1 : -1;
+    for (int i = 1; i <= segments; i++) {
+        int logical = (i == segments) ? toLogical
+                                      : fromLogical + step * (delta * i / segments);
+        ledc_set_fade_with_time(LED_LEDC_MODE, LED_LEDC_CHANNEL,
+                                (uint32_t)ledLogicalToHardwarePwm(logical),
+                                (int)(fadeMs / segments > 0 ? fadeMs / segments : 1));
+        // WAIT_DONE bloqueia esta task num semáforo do driver até o fim do
+        // trecho — medido como espera, não como execução
+        ledProbe.beginWait();
+        ledc_fade_start(LED_LEDC_MODE, LED_LEDC_CHANNEL, LEDC_FADE_WAIT_DONE);
+    }
 }
 
 void ActuatorController::ledPwmTask(void* parameter) {
     ActuatorController* self = static_cast<ActuatorController*>(parameter);
-    const int step = 5;
 
     for (;;) {
-        int current = self->currentLEDIntensity;
-        int target  = self->targetLEDIntensity;
-
-        if (target > current) {
-            current += step;
-            if (current > target) current = target;
-            self->writeLedHardwareFromLogical(current);
-            self->currentLEDIntensity = current;
-        } else if (target < current) {
-            current -= step;
-            if (current < target) current = target;
-            self->writeLedHardwareFromLogical(current);
-            self->currentLEDIntensity = current;
+        // Dorme até controlLEDs() notificar um novo alvo
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Alvos que mudarem durante o fade deixam a notificação pendente e são
+        // atendidos na próxima volta, partindo do duty em que o fade parou.
+        int target = self->targetLEDIntensity;
+        if (target == self->currentLEDIntensity) continue;
+
+        self->ledProbe.release(self->ledReleaseUs);
+        self->ledProbe.start();
+        self->fadeLedHardwareToLogical(self->currentLEDIntensity, target);
+        self->currentLEDIntensity = target;
+        self->ledProbe.stop();
+    }
+}
+
+// =============================================================================
+// DAMPER DO EXAUSTOR — servo acionado só em transições
+// =============================================================================
+
+void ActuatorController::setDamperTarget(int angle) {
+    if (angle < 0)   angle = 0;
+    if (angle > 180) angle = 180;
+    if (angle == targetDamperAngle) return;   // sem mudança → servo não é tocado
+
+    targetDamperAngle = angle;
+    if (damperTaskHandle != nullptr) xTaskNotifyGive(damperTaskHandle);
+}
+
+void ActuatorController::setDamperFraction(float fraction) {
+    if (isnan(fraction) || fraction < 0.0f) fraction = 0.0f;
+    if (fraction > 1.0f) fraction = 1.0f;
+
+    // 10 níveis: pequenas variações de leitura não movem o servo
+    int level = (int)(fraction * DAMPER_LEVELS + 0.5f);
+    setDamperTarget(closedPosition + (openPosition - closedPosition) * level / DAMPER_LEVELS);
+}
+
+float ActuatorController::gasExcess(int co, int co2, int tvocs, bool ccsReady) const {
+    // Excesso relativo do pior gás: (valor - setpoint) / setpoint
+    auto excess = [](int value, int setpoint) -> float {
+        if (setpoint <= 0 || value <= setpoint) return 0.0f;
+        return (float)(value - setpoint) / (float)setpoint;
+    };
+    float e = excess(co, coSetpoint);
+    if (ccsReady) {
+        float e2 = excess(co2, co2Setpoint);
+        float e3 = excess(tvocs, tvocsSetpoint);
+        if (e2 > e) e = e2;
+        if (e3 > e) e = e3;
+    }
+    return e;
+}
+
+void ActuatorController::damperTask(void* parameter) {
+    ActuatorController* self = static_cast<ActuatorController*>(parameter);
+    const TickType_t frame = pdMS_TO_TICKS(20);   // período do sinal do servo (50 Hz)
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int target = self->targetDamperAngle;
+        if (target == self->currentDamperAngle) continue;
+
+        if (!self->myServo.attached()) self->myServo.attach(self->_servoPin);
+
+        int from = self->currentDamperAngle;
+        if (from < 0 || self->damperRampMs < 20) {
+            self->myServo.write(target);
+        } else {
+            // Rampa linear; um novo alvo no meio da rampa é seguido a partir
+            // do ângulo atual (o alvo é relido a cada quadro).
+            unsigned long steps = self->damperRampMs / 20;
+            int cur = from;
+            for (unsigned long i = 1; i <= steps; i++) {
+                if (self->targetDamperAngle != target) {
+                    target = self->targetDamperAngle;
+                    from   = cur;
+                    i      = 0;   // o i++ do for retoma no passo 1 da nova rampa
+                    continue;
+                }
+                cur = from + (int)((long)(target - from) * (long)i / (long)steps);
+                self->myServo.write(cur);
+                vTaskDelay(frame);
+            }
         }
+        self->currentDamperAngle = target;
+        Serial.printf("[damper] Posicao %d graus\n", target);
 
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+        // Espera assentar e solta o servo (o damper não tem carga que o mova)
+        vTaskDelay(pdMS_TO_TICKS(self->damperSettleMs));
+        if (self->targetDamperAngle == self->currentDamperAngle) {
+            self->myServo.detach();
+        } else {
+            xTaskNotifyGive(xTaskGetCurrentTaskHandle());   // novo alvo durante o assentamento
+        }
     }
 }
 
@@ -105,6 +380,46 @@ void ActuatorController::saveSetpointsNVS() {
     Serial.println("[nvs] Setpoints saved to NVS");
 }
 
+void ActuatorController::savePidGainsNVS() {
+    Preferences preferences;
+    if(!preferences.begin("setpoints", false)) {
+        Serial.println("[nvs] Error opening NVS to save PID gains");
+        return;
+    }
+
+    preferences.putFloat("tKp", peltierPid.kp);
+    preferences.putFloat("tKi", peltierPid.ki);
+    preferences.putFloat("tKd", peltierPid.kd);
+    preferences.putFloat("hKp", humidifierPid.kp);
+    preferences.putFloat("hKi", humidifierPid.ki);
+    preferences.putFloat("hKd", humidifierPid.kd);
+
+    preferences.end();
+    Serial.println("[nvs] PID gains saved to NVS");
+}
+
+void ActuatorController::setSetpointRampRates(float tempPerHour, float humidityPerHour) {
+    bool changed = false;
+    if (tempPerHour >= 0.0f && fabsf(tempPerHour - setpointRamp.tempRatePerHour) > 0.001f) {
+        setpointRamp.tempRatePerHour = tempPerHour;
+        changed = true;
+    }
+    if (humidityPerHour >= 0.0f && fabsf(humidityPerHour - setpointRamp.humidityRatePerHour) > 0.001f) {
+        setpointRamp.humidityRatePerHour = humidityPerHour;
+        changed = true;
+    }
+    if (!changed) return;
+
+    Preferences preferences;
+    if (preferences.begin("setpoints", false)) {
+        preferences.putFloat("tRamp", setpointRamp.tempRatePerHour);
+        preferences.putFloat("hRamp", setpointRamp.humidityRatePerHour);
+        preferences.end();
+    }
+    Serial.printf("[setpoints] Rampa: %.2f C/h, %.1f %%UR/h (0 = imediato)\n",
+                  setpointRamp.tempRatePerHour, setpointRamp.humidityRatePerHour);
+}
+
 bool ActuatorController::loadSetpointsNVS() {
     Preferences preferences;
     if(!preferences.begin("setpoints", true)) {
@@ -114,6 +429,25 @@ bool ActuatorController::loadSetpointsNVS() {
         return false;
     }
 
+    // Ganhos das malhas (gravados pelo autotune) — independentes dos setpoints
+    if (preferences.isKey("tKp")) {
+        peltierPid.setGains(preferences.getFloat("tKp", peltierPid.kp),
+                            preferences.getFloat("tKi", peltierPid.ki),
+                            preferences.getFloat("tKd", peltierPid.kd));
+        humidifierPid.setGains(preferences.getFloat("hKp", humidifierPid.kp),
+                               preferences.getFloat("hKi", humidifierPid.ki),
+                               preferences.getFloat("hKd", humidifierPid.kd));
+        Serial.printf("[nvs] Ganhos PID: T(Kp=%.4f Ki=%.6f Kd=%.3f) H(Kp=%.4f Ki=%.6f Kd=%.3f)\n",
+                      peltierPid.kp, peltierPid.ki, peltierPid.kd,
+                      humidifierPid.kp, humidifierPid.ki, humidifierPid.kd);
+    }
+
+    // Taxas da rampa de setpoints — independentes dos setpoints
+    if (preferences.isKey("tRamp")) {
+        setpointRamp.tempRatePerHour     = preferences.getFloat("tRamp", setpointRamp.tempRatePerHour);
+        setpointRamp.humidityRatePerHour = preferences.getFloat("hRamp", setpointRamp.humidityRatePerHour);
+    }
+
     // BUG CORRIGIDO v1.2.1: o fallback de "lux" era 100 (valor absurdo para lux
     // de estufa — era um valor de teste esquecido). Corrigido para 5000, que é o
     // mesmo default usado em applySetpoints() e createInitialGreenhouse().
@@ -146,7 +480,6 @@ bool ActuatorController::loadSetpointsNVS() {
 // HISTERESE
 // =============================================================================
 
-const float HYSTERESIS_TEMP     = 0.5f;
 const float HYSTERESIS_HUMIDITY = 2.0f;
 
 // =============================================================================
@@ -164,20 +497,26 @@ void ActuatorController::begin(uint8_t pinLED, uint8_t pinRelay1, uint8_t pinRel
     _pinRelay4 = pinRelay4;
     _servoPin  = servoPin;
 
-    myServo.attach(servoPin);
-    myServo.write(closedPosition);
-
-    pinMode(_pinLED,    OUTPUT);
     pinMode(_pinRelay1, OUTPUT);
     pinMode(_pinRelay2, OUTPUT);
     pinMode(_pinRelay3, OUTPUT);
     pinMode(_pinRelay4, OUTPUT);
 
-    writeLedHardwareFromLogical(0);
+    setupLedHardware();
     digitalWrite(_pinRelay1, LOW);
     digitalWrite(_pinRelay2, LOW);
     digitalWrite(_pinRelay3, LOW);
     digitalWrite(_pinRelay4, LOW);
+    relay1State = relay2State = relay3State = relay4State = false;
+
+    // Regras de desgaste padrão (ajustáveis via setRelayWearLimits).
+    // R1/R2 acompanham os mínimos da proporção de tempo do Peltier.
+    setRelayWearLimits(1, 20000UL, 20000UL, 60);
+    setRelayWearLimits(2, 20000UL, 20000UL, 60);
+    setRelayWearLimits(3, 30000UL, 30000UL, 40);
+    setRelayWearLimits(4, 60000UL, 60000UL, 20);
+    relayGuard.begin();
+    energyMeter.begin();
 
     humidifierOn        = false;
     peltierActive       = false;
@@ -187,10 +526,30 @@ void ActuatorController::begin(uint8_t pinLED, uint8_t pinRelay1, uint8_t pinRel
     targetLEDIntensity  = 0;
     lastUpdateTime      = 0;
     inCooldown          = false;
+    peltierThermal.reset(millis());
     cooldownStart       = 0;
+    peltierPid.reset();
+    humidifierPid.reset();
+    peltierTpoDirection = OFF;
+    lastPeltierPidTime  = 0;
     blockFirebaseWrite  = false;
     firebaseWriteBlockTime = 0;
 
+    // Damper: posição inicial desconhecida → primeiro comando vai direto ao
+    // fechado (sem rampa); a task desanexa o servo depois de assentar.
+    currentDamperAngle = -1;
+    targetDamperAngle  = closedPosition;
+    xTaskCreatePinnedToCore(
+        damperTask,
+        "Damper_Task",
+        2048,
+        this,
+        1,
+        &damperTaskHandle,
+        0   // ← core 0
+    );
+    xTaskNotifyGive(damperTaskHandle);
+
     // LED PWM Task no core 0 para não interferir com DHT22 no core 1
     xTaskCreatePinnedToCore(
         ledPwmTask,
@@ -204,6 +563,11 @@ void ActuatorController::begin(uint8_t pinLED, uint8_t pinRelay1, uint8_t pinRel
 
     loadLEDScheduleNVS();
     loadExhaustScheduleNVS();
+    daylightHarvester.begin();
+    // Semente do jitter do ciclo do exaustor: única por placa (MAC de fábrica)
+    uint64_t mac = ESP.getEfuseMac();
+    exhaustScheduler.setDeviceSeed((uint32_t)mac ^ (uint32_t)(mac >> 32));
+    loadRulesNVS();
     Serial.println("[init] ActuatorController initialized successfully");
 }
 
@@ -261,8 +625,8 @@ void ActuatorController::applySetpoints(int lux, float tMin, float tMax,
 // MODOS DE OPERAÇÃO
 // =============================================================================
 
-void ActuatorController::applyOperationMode(OperationMode mode) {
-    if (mode == _currentMode) return;
+void ActuatorController::applyOperationMode(OperationMode mode, bool reapply) {
+    if (mode == _currentMode && !reapply) return;
 
     _currentMode = mode;
     ModePreset p = getModePreset(mode);
@@ -304,17 +668,16 @@ void ActuatorController::applyOperationMode(OperationMode mode) {
     }
 
     if (!p.humidifierEnabled && humidifierOn) {
-        controlRelay(3, false);
-        humidifierOn = false;
+        controlRelay(3, false, true);
         Serial.println("[mode] Umidificador desligado pelo modo");
     }
     if (!p.peltierEnabled && peltierActive) {
-        controlPeltier(false, false);
+        controlPeltier(false, false, true);
         Serial.println("[mode] Peltier desligado pelo modo");
     }
     if (p.exhaustForcedOn) {
-        myServo.write(openPosition);
-        controlRelay(4, true);
+        setDamperTarget(openPosition);
+        controlRelay(4, true, true);
         Serial.println("[mode] Exaustor forçado LIGADO pelo modo");
     }
 
@@ -331,7 +694,8 @@ void ActuatorController::applyOperationMode(OperationMode mode) {
 void ActuatorController::controlAutomatically(float temp, float humidity, int light,
                                                int co, int co2, int tvocs,
                                                bool waterLevel, bool dhtHealthy,
-                                               bool allowFirebaseWrite) {
+                                               bool allowFirebaseWrite, bool ccsReady) {
+    reconcileSafetyCuts(millis());
     if (debugMode) {
         return;
     }
@@ -340,63 +704,95 @@ void ActuatorController::controlAutomatically(float temp, float humidity, int li
     // saibam se podem fazer writes Firebase (false quando chamado da lifeSupportTask).
     _allowFirebaseUpdates = allowFirebaseWrite;
 
+    unsigned long nowMs = millis();
+
+    // ── RAMPA DE SETPOINTS ────────────────────────────────────────────────────
+    // Alvos podem ter mudado (Firebase, modo, receita): efetivos avançam no
+    // máximo rate × Δt por ciclo.
+    setpointRamp.setTarget(RAMP_TEMP_MIN,     tempMin);
+    setpointRamp.setTarget(RAMP_TEMP_MAX,     tempMax);
+    setpointRamp.setTarget(RAMP_HUMIDITY_MIN, humidityMin);
+    setpointRamp.setTarget(RAMP_HUMIDITY_MAX, humidityMax);
+    bool ramping = setpointRamp.update(nowMs);
+    if (ramping != _setpointRamping) {
+        _setpointRamping = ramping;
+        if (ramping) {
+            Serial.printf("[setpoints] Rampa iniciada: T %.1f-%.1f -> %.1f-%.1f, H %.1f-%.1f -> %.1f-%.1f\n",
+                          effTempMin(), effTempMax(), tempMin, tempMax,
+                          effHumidityMin(), effHumidityMax(), humidityMin, humidityMax);
+        } else {
+            Serial.println("[setpoints] Rampa concluida — efetivos no alvo");
+        }
+    }
+
     // ── PELTIER ────────────────────────────────────────────────────────────────
-    if (inCooldown && (millis() - cooldownStart >= cooldownTime)) {
+    // Proteção térmica adaptativa: o modelo integra o tempo aquecendo desde
+    // a última chamada; hardMaxOnMs/minCooldownMs continuam como limites fixos.
+    peltierThermal.update(currentPeltierMode == HEATING && peltierActive, temp, nowMs);
+
+    if (inCooldown && nowMs - cooldownStart >= peltierThermal.minCooldownMs &&
+        peltierThermal.canResume()) {
         inCooldown = false;
+        Serial.printf("[peltier] Fim do cooldown apos %lus (dissipador ~%.0f C)\n",
+                      (nowMs - cooldownStart) / 1000UL, peltierThermal.sinkTemp());
     }
 
-    if (currentPeltierMode == HEATING && peltierActive && peltierHeatingStart > 0 &&
-        (millis() - peltierHeatingStart >= operationTime)) {
-        Serial.println("[peltier] Limite de aquecimento contínuo — desligando (cooldown)");
-        controlPeltier(false, false);
-        inCooldown    = true;
-        cooldownStart = millis();
+    if (currentPeltierMode == HEATING && peltierActive && peltierHeatingStart > 0) {
+        bool hardCap = nowMs - peltierHeatingStart >= peltierThermal.hardMaxOnMs;
+        if (hardCap || peltierThermal.overLimit()) {
+            Serial.printf("[peltier] %s apos %lus (dissipador ~%.0f C) — desligando (cooldown)\n",
+                          hardCap ? "Teto de aquecimento continuo" : "Limite termico estimado",
+                          (nowMs - peltierHeatingStart) / 1000UL, peltierThermal.sinkTemp());
+            controlPeltier(false, false, true);
+            peltierTpo.forceOff(nowMs);
+            inCooldown    = true;
+            cooldownStart = nowMs;
+        }
+    }
+
+    // Ensaio de autotune em curso: o autotuner comanda o atuador da malha
+    if (autotuner.isRunning()) {
+        serviceAutotune(temp, humidity, waterLevel, dhtHealthy);
     }
+    bool tuningTemp     = autotuner.isRunning() && autotuneLoop == AUTOTUNE_LOOP_TEMPERATURE;
+    bool tuningHumidity = autotuner.isRunning() && autotuneLoop == AUTOTUNE_LOOP_HUMIDITY;
 
-    if (!_peltierAllowed) {
+    if (tuningTemp) {
+        // Peltier sob controle do autotune (serviceAutotune)
+
+    } else if (!_peltierAllowed) {
         // Modo de operação proíbe Peltier
-        if (peltierActive) controlPeltier(false, false);
+        stopPeltierControl(nullptr);
 
     } else if (!dhtHealthy) {
         // SEGURANÇA CRÍTICA: DHT22 inoperante → temperatura inválida (NAN).
         // Sem leitura confiável de temperatura, o Peltier NÃO PODE tomar decisões.
         // Desliga imediatamente e mantém desligado até o sensor se recuperar.
-        if (peltierActive) {
-            Serial.println("[SAFETY] DHT22 INOPERANTE — Peltier DESLIGADO por segurança");
-            controlPeltier(false, false);
-        }
+        stopPeltierControl("[SAFETY] DHT22 INOPERANTE — Peltier DESLIGADO por segurança");
 
     } else if (isnan(temp)) {
         // Temperatura NAN mesmo com dhtHealthy=true (caso improvável, mas defensivo)
-        if (peltierActive) {
-            Serial.println("[SAFETY] Temperatura NAN — Peltier DESLIGADO por segurança");
-            controlPeltier(false, false);
-        }
+        stopPeltierControl("[SAFETY] Temperatura NAN — Peltier DESLIGADO por segurança");
 
     } else {
-        // DHT OK — lógica normal
-        bool wantHeat = temp < (tempMin - HYSTERESIS_TEMP);
-        bool wantCool = temp > (tempMax + HYSTERESIS_TEMP);
-        if (inCooldown && wantHeat) {
-            wantHeat = false;
-        }
-
-        if (wantHeat) {
-            if (!peltierActive || currentPeltierMode != HEATING) {
-                Serial.printf("[actuator] Temp abaixo (%.1f < %.1f), aquecendo\n", temp, tempMin);
-                controlPeltier(false, true);
-            }
-        } else if (wantCool) {
-            if (!peltierActive || currentPeltierMode != COOLING) {
-                Serial.printf("[actuator] Temp acima (%.1f > %.1f), resfriando\n", temp, tempMax);
-                controlPeltier(true, true);
-            }
-        } else if (peltierActive) {
-            Serial.println("[actuator] Temp OK, desligando Peltier");
-            controlPeltier(false, false);
-        }
+        // DHT OK — PID + proporção de tempo
+        runPeltierControl(temp);
     }
 
+    // ── REGRAS DO USUÁRIO ─────────────────────────────────────────────────────
+    // Avaliadas antes das malhas para que as ações entrem como intenção —
+    // intertravamentos de segurança abaixo continuam valendo.
+    float ruleInputs[RULE_SENSOR_COUNT];
+    ruleInputs[RULE_SENSOR_TEMP]     = temp;
+    ruleInputs[RULE_SENSOR_HUMIDITY] = humidity;
+    ruleInputs[RULE_SENSOR_LIGHT]    = (float)light;
+    ruleInputs[RULE_SENSOR_CO]       = (float)co;
+    ruleInputs[RULE_SENSOR_CO2]      = ccsReady ? (float)co2   : NAN;
+    ruleInputs[RULE_SENSOR_TVOCS]    = ccsReady ? (float)tvocs : NAN;
+    ruleInputs[RULE_SENSOR_WATER]    = waterLevel ? 1.0f : 0.0f;
+    RuleOverrides rules = ruleEngine.evaluate(ruleInputs, nowMs);
+    _ruleLedOverride = rules.led >= 0;
+
     // ── UMIDIFICADOR ──────────────────────────────────────────────────────────
     // BUG CORRIGIDO v1.2.3: humidifierOn e relay3State podiam divergir quando
     // o modo mudava de manual→automático (setManualStates atualiza ambos, mas
@@ -405,52 +801,153 @@ void ActuatorController::controlAutomatically(float temp, float humidity, int li
     // do pino) e mantém humidifierOn sincronizado a partir dele.
     humidifierOn = relay3State;  // garante sincronia antes de qualquer decisão
 
-    auto setHumidifier = [&](bool on, const char* reason) {
+    // force=true nos desligamentos de segurança (água baixa, DHT, modo)
+    auto setHumidifier = [&](bool on, const char* reason, bool force) {
         if (relay3State == on) return;  // já está no estado desejado — não re-aciona
-        if (reason) Serial.printf("[actuator] Umidificador %s: %s\n", on ? "LIGADO" : "DESLIGADO", reason);
-        controlRelay(3, on);
-        humidifierOn = on;
+        if (controlRelay(3, on, force) && reason) {
+            Serial.printf("[actuator] Umidificador %s: %s\n", on ? "LIGADO" : "DESLIGADO", reason);
+        }
     };
 
-    if (!_humidifierAllowed) {
-        setHumidifier(false, "modo de operação desabilita umidificador");
+    // Intenção da malha de umidade — só os caminhos normais passam pelo
+    // árbitro; intertravamentos de segurança desligam direto.
+    bool humidifierManaged = false;
+    bool humidifyWant      = false;   ///< estado de R3 pedido pela malha
+    bool humidifyDemand    = false;   ///< há demanda de umidade (entra no árbitro)
+    char humidifierReason[80] = "";
+
+    if (tuningHumidity) {
+        // Umidificador sob controle do autotune (serviceAutotune)
+
+    } else if (!_humidifierAllowed) {
+        stopHumidifierControl();
+        setHumidifier(false, "modo de operação desabilita umidificador", true);
 
     } else if (waterLevel) {
         // waterLevel=true → água BAIXA
-        setHumidifier(false, "nível de água baixo");
+        stopHumidifierControl();
+        setHumidifier(false, "nível de água baixo", true);
 
     } else if (!dhtHealthy || isnan(humidity)) {
         // Sem leitura de umidade confiável — fail-safe
-        setHumidifier(false, "DHT inoperante — sem leitura de umidade");
+        stopHumidifierControl();
+        setHumidifier(false, "DHT inoperante — sem leitura de umidade", true);
+
+    } else if (humidifierPulseMode) {
+        // PI + proporção de tempo com antecipação pela taxa de subida
+        humidifierManaged = true;
+        humidifyWant      = runHumidifierControl(humidity);
+        humidifyDemand    = humidifierDuty > 0.0f;
+        snprintf(humidifierReason, sizeof(humidifierReason),
+                 "pulso, umidade %.1f (faixa %.1f-%.1f), duty %.0f%%",
+                 humidity, effHumidityMin(), effHumidityMax(), humidifierDuty * 100.0f);
 
     } else {
-        if (humidity < (humidityMin - HYSTERESIS_HUMIDITY)) {
-            char buf[64];
-            snprintf(buf, sizeof(buf), "umidade baixa %.1f < %.1f", humidity, humidityMin);
-            setHumidifier(true, buf);
-        } else if (humidity > (humidityMax + HYSTERESIS_HUMIDITY)) {
-            char buf[64];
-            snprintf(buf, sizeof(buf), "umidade alta %.1f > %.1f", humidity, humidityMax);
-            setHumidifier(false, buf);
+        humidifierManaged = true;
+        humidifyWant      = relay3State;   // dentro da faixa com histerese: mantém
+        if (humidity < (effHumidityMin() - HYSTERESIS_HUMIDITY)) {
+            humidifyWant = true;
+            snprintf(humidifierReason, sizeof(humidifierReason),
+                     "umidade baixa %.1f < %.1f", humidity, effHumidityMin());
+        } else if (humidity > (effHumidityMax() + HYSTERESIS_HUMIDITY)) {
+            humidifyWant = false;
+            snprintf(humidifierReason, sizeof(humidifierReason),
+                     "umidade alta %.1f > %.1f", humidity, effHumidityMax());
         }
-        // Dentro da faixa com histerese: mantém o estado atual (sem ação)
+        humidifyDemand = humidifyWant;
+    }
+
+    if (humidifierManaged && rules.humidifier >= 0) {
+        humidifyWant   = rules.humidifier == 1;
+        humidifyDemand = humidifyWant;
+        snprintf(humidifierReason, sizeof(humidifierReason), "regra do usuario (%s)",
+                 humidifyWant ? "on" : "off");
+    }
+
+    // ── EXAUSTOR (intenção) ───────────────────────────────────────────────────
+    // Prioridade de segurança: gases acima do limite SEMPRE podem forçar o
+    // exaustor, independentemente do scheduler estar ativo ou não. O scheduler
+    // por horário e o modo forçado manual são política de conveniência — nunca
+    // devem impedir a resposta a uma condição de gás perigosa.
+    //
+    // eCO2/TVOC do CCS811 só entram no alarme depois que o sensor sai do
+    // condicionamento (ccsReady) — antes disso o algoritmo interno produz
+    // picos espúrios que abririam o exaustor sem motivo. O MQ-7 (CO) tem seu
+    // próprio aquecimento tratado no SensorController e não depende disto.
+    bool gasAlert = (co > coSetpoint ||
+                     (ccsReady && (co2 > co2Setpoint || tvocs > tvocsSetpoint)));
+    bool scheduledVent = exhaustScheduler.isActive() && exhaustScheduler.wantsExhaustOn();
+    // Regra "exhaust on" equivale à agenda (adiável pelo árbitro); "off" só
+    // prevalece sobre a agenda, nunca sobre alarme de gás ou modo forçado.
+    if (rules.exhaust == 1) {
+        scheduledVent = true;
+    } else if (rules.exhaust == 0) {
+        scheduledVent = false;
     }
+    bool wantExhaustOpen = gasAlert || _exhaustForced || scheduledVent;
+    float excess = gasExcess(co, co2, tvocs, ccsReady);
+
+    if (gasAlert) {
+        Serial.printf("[actuator] Gases acima do limite (CO:%d CO2:%d TVOCs:%d)\n", co, co2, tvocs);
+    }
+
+    // ── ARBITRAGEM UMIDIFICAÇÃO x VENTILAÇÃO ─────────────────────────────────
+    // CO, modo forçado ou excesso grave nunca esperam: o umidificador é que pausa.
+    // CO2/TVOC moderados e a agenda alternam rajada de ventilação e recuperação.
+    ClimateIntents intents;
+    intents.humidify      = humidifierManaged && humidifyDemand;
+    intents.ventilate     = wantExhaustOpen;
+    intents.ventMandatory = co > coSetpoint || _exhaustForced || excess >= ventMandatoryExcess;
+    ClimateDecision decision = climateArbiter.arbitrate(intents, millis());
+
+    if (humidifierManaged) {
+        if (humidifyWant && !decision.humidifier) {
+            // Pausado pelo árbitro: congela o PI como em qualquer bloqueio externo
+            stopHumidifierControl();
+            setHumidifier(false, "pausado durante a ventilação", false);
+        } else {
+            setHumidifier(humidifyWant, humidifierReason[0] ? humidifierReason : nullptr, false);
+        }
+    }
+
+    // Alarme de gás abre sem esperar o tempo mínimo desligado (segurança).
+    bool exhaustOn = decision.exhaust;
+    controlRelay(4, exhaustOn, gasAlert && exhaustOn);
+
+    // Damper: forçado/agenda → totalmente aberto; gás → proporcional ao
+    // excesso; caso contrário (ou exaustor retido desligado) → piso mínimo.
+    float ventFraction = damperMinFraction;
+    if (relay4State) {
+        if (_exhaustForced || scheduledVent) {
+            ventFraction = 1.0f;
+        } else if (gasAlert) {
+            // Ajuste inválido (≤ 0 ou NAN) abre tudo: nunca fecha no alarme
+            float f = damperFullOpenExcess > 0.0f ? excess / damperFullOpenExcess : 1.0f;
+            if (f > ventFraction) ventFraction = f;
+        }
+    }
+    setDamperFraction(ventFraction);
 
     // ── LEDs ──────────────────────────────────────────────────────────────────
     if (!_ledsAllowed) {
         if (currentLEDIntensity > 0) {
             controlLEDs(false, 0);
         }
+    } else if (rules.led >= 0) {
+        if (rules.led != currentLEDIntensity) {
+            controlLEDs(rules.led > 0, rules.led);
+        }
     } else if (ledScheduler.isActive()) {
         int schedIntensity = ledScheduler.wantsLEDsOn() ? ledScheduler.getIntensity() : 0;
         if (schedIntensity != currentLEDIntensity) {
             controlLEDs(schedIntensity > 0, schedIntensity);
         }
     } else {
-        int newIntensity = (light < luxSetpoint) ? 255 : 0;
-        if (newIntensity != currentLEDIntensity) {
-            controlLEDs(newIntensity > 0, newIntensity);
-        }
+        // Sem agenda: completa a luz natural até luxSetpoint. Passos pequenos e
+        // frequentes — o estado vai ao Firebase no envio periódico, não a cada passo.
+        // A calibração do ganho só acende os LEDs na janela de luz configurada.
+        setLEDTarget(daylightHarvester.update(light, currentLEDIntensity, luxSetpoint, millis(),
+                                              ledScheduler.inLightPeriod()));
     }
 
     // ── ATUALIZAÇÃO FIREBASE ──────────────────────────────────────────────────
@@ -464,76 +961,323 @@ void ActuatorController::controlAutomatically(float temp, float humidity, int li
         }
     }
 
-    // ── EXAUSTOR ──────────────────────────────────────────────────────────────
-    // Prioridade de segurança: gases acima do limite SEMPRE podem forçar o
-    // exaustor, independentemente do scheduler estar ativo ou não. O scheduler
-    // por horário e o modo forçado manual são política de conveniência — nunca
-    // devem impedir a resposta a uma condição de gás perigosa.
-    bool gasAlert = (co > coSetpoint || co2 > co2Setpoint || tvocs > tvocsSetpoint);
-    bool wantExhaustOpen = gasAlert || _exhaustForced ||
-                           (exhaustScheduler.isActive() && exhaustScheduler.wantsExhaustOn());
+    relayGuard.flushIfDue(millis());
+    accountEnergy(millis());
+    energyMeter.checkpointIfDue(millis());
+}
 
-    if (gasAlert) {
-        Serial.printf("[actuator] Gases acima do limite (CO:%d CO2:%d TVOCs:%d)\n", co, co2, tvocs);
+// =============================================================================
+// CONTROLE INDIVIDUAL DOS ATUADORES
+// =============================================================================
+
+// =============================================================================
+// AUTOTUNE A RELÉ
+// =============================================================================
+
+bool ActuatorController::startAutotune(AutotuneLoop loop) {
+    if (debugMode) {
+        Serial.println("[autotune] Rejeitado: modo debug ativo");
+        return false;
+    }
+    if (autotuner.isRunning()) {
+        Serial.println("[autotune] Rejeitado: ensaio ja em curso");
+        return false;
+    }
+
+    if (loop == AUTOTUNE_LOOP_TEMPERATURE) {
+        if (!_peltierAllowed) {
+            Serial.println("[autotune] Rejeitado: modo de operacao desabilita o Peltier");
+            return false;
+        }
+        // Relé aquece/resfria (±1 na escala do PID), histerese acima do ruído do DHT22
+        autotuner.start(0.5f * (tempMin + tempMax), 0.3f, 1.0f,
+                        3, 3UL * 3600UL * 1000UL, AUTOTUNE_RULE_PID);
+        peltierPid.hold();
+        peltierTpo.forceOff(millis());
+        peltierTpoDirection = OFF;
+    } else if (loop == AUTOTUNE_LOOP_HUMIDITY) {
+        if (!_humidifierAllowed) {
+            Serial.println("[autotune] Rejeitado: modo de operacao desabilita o umidificador");
+            return false;
+        }
+        // Umidificador 0/1 → d = 0.5; PI (umidade do DHT22 é ruidosa para o termo D)
+        autotuner.start(0.5f * (humidityMin + humidityMax), 1.5f, 0.5f,
+                        3, 2UL * 3600UL * 1000UL, AUTOTUNE_RULE_PI);
+        stopHumidifierControl();
+    } else {
+        return false;
+    }
+
+    autotuneLoop = loop;
+    RLOG_FMT(LOG_INFO, "[autotune]", "Ensaio iniciado (%s)",
+             loop == AUTOTUNE_LOOP_TEMPERATURE ? "temperatura" : "umidade");
+    return true;
+}
+
+void ActuatorController::abortAutotune(const char* reason) {
+    if (!autotuner.isRunning()) return;
+    autotuner.abort(reason);
+    if (autotuneLoop == AUTOTUNE_LOOP_TEMPERATURE) {
+        if (peltierActive) controlPeltier(false, false, true);
+    } else if (autotuneLoop == AUTOTUNE_LOOP_HUMIDITY) {
+        controlRelay(3, false, true);
+    }
+}
+
+void ActuatorController::serviceAutotune(float temp, float humidity, bool waterLevel,
+                                         bool dhtHealthy) {
+    if (!dhtHealthy) {
+        abortAutotune("DHT22 inoperante");
+        return;
     }
 
-    if (wantExhaustOpen) {
-        myServo.write(openPosition);
-        controlRelay(4, true);
+    unsigned long now = millis();
+
+    if (autotuneLoop == AUTOTUNE_LOOP_TEMPERATURE) {
+        if (!_peltierAllowed) {
+            abortAutotune("modo de operacao desabilitou o Peltier");
+            return;
+        }
+        bool heat = autotuner.update(temp, now);
+        if (autotuner.isRunning()) {
+            // O limite de aquecimento contínuo/cooldown continua valendo:
+            // durante o cooldown a meia-onda de aquecimento fica desligada.
+            if (heat && inCooldown)  controlPeltier(false, false, true);
+            else                     controlPeltier(!heat, true);
+            return;
+        }
+        if (peltierActive) controlPeltier(false, false);
+        if (autotuner.state() == AUTOTUNE_DONE) {
+            peltierPid.setGains(autotuner.kp(), autotuner.ki(), autotuner.kd());
+            peltierPid.reset();
+            savePidGainsNVS();
+        }
+
+    } else if (autotuneLoop == AUTOTUNE_LOOP_HUMIDITY) {
+        if (!_humidifierAllowed || waterLevel) {
+            abortAutotune(waterLevel ? "nivel de agua baixo" : "modo de operacao desabilitou o umidificador");
+            return;
+        }
+        bool on = autotuner.update(humidity, now);
+        if (autotuner.isRunning()) {
+            controlRelay(3, on);
+            return;
+        }
+        controlRelay(3, false, true);
+        if (autotuner.state() == AUTOTUNE_DONE) {
+            humidifierPid.setGains(autotuner.kp(), autotuner.ki(), autotuner.kd());
+            humidifierPid.reset();
+            savePidGainsNVS();
+        }
+    }
+
+    if (autotuner.state() == AUTOTUNE_DONE) {
+        RLOG_FMT(LOG_INFO, "[autotune]", "Concluido: Ku=%.3f Pu=%.0fs Kp=%.4f Ki=%.6f Kd=%.3f",
+                 autotuner.ku(), autotuner.pu(), autotuner.kp(), autotuner.ki(), autotuner.kd());
     } else {
-        myServo.write(closedPosition);
-        controlRelay(4, false);
+        RLOG_FMT(LOG_WARN, "[autotune]", "Falhou: %s", autotuner.failReason());
     }
 }
 
 // =============================================================================
-// CONTROLE INDIVIDUAL DOS ATUADORES
+// PELTIER — PID + PROPORÇÃO DE TEMPO
 // =============================================================================
 
-void ActuatorController::controlPeltier(bool cooling, bool on) {
-    bool stateChanged = false;
+void ActuatorController::setPeltierPidGains(float kp, float ki, float kd) {
+    peltierPid.setGains(kp, ki, kd);
+    Serial.printf("[peltier] PID: Kp=%.3f Ki=%.5f Kd=%.2f\n", kp, ki, kd);
+}
+
+void ActuatorController::setPeltierWindow(unsigned long windowMs, unsigned long minOnMs,
+                                          unsigned long minOffMs) {
+    peltierTpo.configure(windowMs, minOnMs, minOffMs);
+    Serial.printf("[peltier] Janela %lus, min on %lus, min off %lus\n",
+                  peltierTpo.windowMs() / 1000UL, peltierTpo.minOnMs() / 1000UL,
+                  peltierTpo.minOffMs() / 1000UL);
+}
+
+void ActuatorController::stopPeltierControl(const char* reason) {
+    // Integrador congelado: o erro acumulado enquanto o Peltier está
+    // bloqueado não pode ser corrigido e viraria overshoot na volta.
+    peltierPid.hold();
+    lastPeltierPidTime = 0;
+    peltierTpo.forceOff(millis());
+    peltierTpoDirection = OFF;
+    if (peltierActive) {
+        if (reason) Serial.println(reason);
+        controlPeltier(false, false, true);
+    }
+}
 
+void ActuatorController::runPeltierControl(float temp) {
+    unsigned long now = millis();
+    float dt = lastPeltierPidTime ? (now - lastPeltierPidTime) / 1000.0f : 0.0f;
+    lastPeltierPidTime = now;
+
+    // Banda morta: dentro da faixa efetiva o erro é zero e o integrador
+    // mantém o duty que segura a temperatura na borda da faixa.
+    float error = 0.0f;
+    if (temp < effTempMin())      error = effTempMin() - temp;
+    else if (temp > effTempMax()) error = effTempMax() - temp;
+
+    // Durante o cooldown o aquecimento está proibido: não integra erro positivo
+    bool heatBlocked = inCooldown && (error > 0.0f || peltierPid.output() > 0.0f);
+    float demand = peltierPid.compute(error, temp, heatBlocked ? 0.0f : dt);
+
+    PeltierMode wanted = OFF;
+    if (demand > 0.0f && !inCooldown) wanted = HEATING;
+    else if (demand < 0.0f)           wanted = COOLING;
+
+    // Inversão de sentido: desliga e aguarda o minOff antes de reverter
+    if (wanted != peltierTpoDirection) {
+        peltierTpo.forceOff(now);
+        peltierTpoDirection = wanted;
+    }
+
+    bool on = (wanted != OFF) && peltierTpo.update(fabsf(demand), now);
+
+    PeltierMode before = currentPeltierMode;
     if (on) {
-        if (cooling) {
-            if (!relay1State || relay2State || currentPeltierMode != COOLING) {
-                digitalWrite(_pinRelay1, HIGH);
-                digitalWrite(_pinRelay2, LOW);
-                currentPeltierMode = COOLING;
-                relay1State = true;
-                relay2State = false;
-                stateChanged = true;
-                peltierHeatingStart = 0;
-                Serial.println("[actuator] Peltier: resfriamento (R1 on, R2 off)");
-            }
-        } else {
-            if (!relay1State || !relay2State || currentPeltierMode != HEATING) {
-                digitalWrite(_pinRelay1, HIGH);
-                digitalWrite(_pinRelay2, HIGH);
-                currentPeltierMode = HEATING;
-                relay1State = true;
-                relay2State = true;
-                stateChanged = true;
-                peltierHeatingStart = millis();
-                Serial.println("[actuator] Peltier: aquecimento (R1 on, R2 on)");
-            }
-        }
-        peltierActive   = true;
-        lastPeltierTime = millis();
+        controlPeltier(wanted == COOLING, true);
+    } else if (peltierActive) {
+        controlPeltier(false, false);
+    }
+    if (currentPeltierMode != before) {
+        Serial.printf("[actuator] Temp %.1f (faixa %.1f-%.1f): %s, duty %.0f%%\n",
+                      temp, effTempMin(), effTempMax(),
+                      currentPeltierMode == HEATING ? "pulso de aquecimento" :
+                      currentPeltierMode == COOLING ? "pulso de resfriamento" : "fim do pulso",
+                      fabsf(demand) * 100.0f);
+    }
+}
+
+// =============================================================================
+// UMIDIFICADOR — PI + PROPORÇÃO DE TEMPO
+// =============================================================================
+
+void ActuatorController::setHumidifierPidGains(float kp, float ki, float kd) {
+    humidifierPid.setGains(kp, ki, kd);
+    Serial.printf("[humidifier] PID: Kp=%.3f Ki=%.5f Kd=%.2f\n", kp, ki, kd);
+}
+
+void ActuatorController::setHumidifierWindow(unsigned long windowMs, unsigned long minOnMs,
+                                             unsigned long minOffMs) {
+    humidifierTpo.configure(windowMs, minOnMs, minOffMs);
+    fitHumidifierWindowToRelay();
+    Serial.printf("[humidifier] Janela %lus, min on %lus, min off %lus\n",
+                  humidifierTpo.windowMs() / 1000UL, humidifierTpo.minOnMs() / 1000UL,
+                  humidifierTpo.minOffMs() / 1000UL);
+}
+
+bool ActuatorController::fitHumidifierWindowToRelay() {
+    const RelayWearConfig& relay = relayGuard.config(3);
+    unsigned long window = humidifierTpo.windowMs();
+    unsigned long minOn  = humidifierTpo.minOnMs();
+    unsigned long minOff = humidifierTpo.minOffMs();
+
+    // Pulso recusado pelo RelayGuard deixaria o TPO e o relé divergentes
+    if (minOn  < relay.minOnMs)  minOn  = relay.minOnMs;
+    if (minOff < relay.minOffMs) minOff = relay.minOffMs;
+    // Cada janela com pulso gasta 2 comutações
+    if (relay.maxSwitchesPerHour > 0) {
+        unsigned long minWindow = (2UL * 3600000UL + relay.maxSwitchesPerHour - 1) /
+                                  relay.maxSwitchesPerHour;
+        if (window < minWindow) window = minWindow;
+    }
+    if (window < minOn + minOff) window = minOn + minOff;
+
+    if (window == humidifierTpo.windowMs() && minOn == humidifierTpo.minOnMs() &&
+        minOff == humidifierTpo.minOffMs()) {
+        return false;
+    }
+    Serial.printf("[humidifier] Janela ajustada ao rele 3 (min %lus/%lus, %u/h): "
+                  "%lus, min on %lus, min off %lus -> %lus, %lus, %lus\n",
+                  relay.minOnMs / 1000UL, relay.minOffMs / 1000UL, relay.maxSwitchesPerHour,
+                  humidifierTpo.windowMs() / 1000UL, humidifierTpo.minOnMs() / 1000UL,
+                  humidifierTpo.minOffMs() / 1000UL,
+                  window / 1000UL, minOn / 1000UL, minOff / 1000UL);
+    humidifierTpo.configure(window, minOn, minOff);
+    return true;
+}
+
+void ActuatorController::stopHumidifierControl() {
+    humidifierPid.hold();
+    lastHumidityPidTime = 0;
+    humidityRiseRate    = 0.0f;
+    humidifierDuty      = 0.0f;
+    humidifierTpo.forceOff(millis());
+}
+
+bool ActuatorController::runHumidifierControl(float humidity) {
+    unsigned long now = millis();
+    float dt = lastHumidityPidTime ? (now - lastHumidityPidTime) / 1000.0f : 0.0f;
+    lastHumidityPidTime = now;
+
+    // Taxa de variação filtrada (%UR/min, EMA com constante HUMIDITY_RATE_TAU_S):
+    // o DHT22 tem passo de 0.1% e ruído — a derivada crua não serve.
+    if (dt > 0.0f) {
+        float rate = (humidity - lastHumiditySample) / dt * 60.0f;
+        humidityRiseRate += (rate - humidityRiseRate) * (dt / (dt + HUMIDITY_RATE_TAU_S));
+    }
+    lastHumiditySample = humidity;
+
+    // Banda morta: dentro da faixa o integrador segura o duty da borda inferior
+    float error = 0.0f;
+    if (humidity < effHumidityMin())      error = effHumidityMin() - humidity;
+    else if (humidity > effHumidityMax()) error = effHumidityMax() - humidity;
+
+    float duty = humidifierPid.compute(error, humidity, dt);
+
+    // A névoa já emitida continua elevando a umidade depois do pulso:
+    // subida rápida corta o duty antes de a leitura cruzar a faixa.
+    if (humidityRiseRate > 0.0f) duty -= humidifierRiseGain * humidityRiseRate;
+    if (duty < 0.0f) duty = 0.0f;
+    humidifierDuty = duty;
+
+    return humidifierTpo.update(duty, now);
+}
+
+void ActuatorController::controlPeltier(bool cooling, bool on, bool force) {
+    // Estado alvo de R1/R2: aquecer = ambos ON; resfriar = R1 ON, R2 OFF
+    bool r1 = on;
+    bool r2 = on && !cooling;
+    PeltierMode mode = !on ? OFF : (cooling ? COOLING : HEATING);
+
+    reconcileSafetyCuts(millis());
+    if (relay1State == r1 && relay2State == r2 && currentPeltierMode == mode) {
+        if (on) lastPeltierTime = millis();
+        return;
+    }
+
+    // Os dois relés mudam juntos ou nenhum muda (evita estado intermediário)
+    unsigned long now = millis();
+    if (!force && (!relayGuard.permit(1, r1, now) || !relayGuard.permit(2, r2, now))) {
+        return;
+    }
+    // Bloqueio do supervisor vale mesmo com force
+    if ((r1 && safetyInhibited(0x01)) || (r2 && safetyInhibited(0x02))) {
+        return;
+    }
+
+    // Desliga antes de ligar: R2 sai primeiro na inversão aquecer→resfriar
+    writeRelay(2, r2, now);
+    writeRelay(1, r1, now);
+
+    currentPeltierMode = mode;
+    peltierActive      = on;
+    if (mode == HEATING) {
+        peltierHeatingStart = now;
+        Serial.println("[actuator] Peltier: aquecimento (R1 on, R2 on)");
+    } else if (mode == COOLING) {
+        peltierHeatingStart = 0;
+        Serial.println("[actuator] Peltier: resfriamento (R1 on, R2 off)");
     } else {
-        if (relay1State || relay2State) {
-            digitalWrite(_pinRelay1, LOW);
-            digitalWrite(_pinRelay2, LOW);
-            peltierActive      = false;
-            currentPeltierMode = OFF;
-            relay1State        = false;
-            relay2State        = false;
-            peltierHeatingStart = 0;
-            stateChanged       = true;
-            Serial.println("[actuator] Peltier: DESLIGADO (R1/R2 off)");
-        }
+        peltierHeatingStart = 0;
+        Serial.println("[actuator] Peltier: DESLIGADO (R1/R2 off)");
     }
+    if (on) lastPeltierTime = now;
 
-    if (stateChanged && _allowFirebaseUpdates &&
+    if (_allowFirebaseUpdates &&
         firebaseHandler != nullptr && firebaseHandler->isAuthenticated() &&
         firebaseHandler->isFirebaseReady() && canWriteToFirebase()) {
         updateFirebaseStateImmediately();
@@ -549,7 +1293,7 @@ void ActuatorController::controlLEDs(bool on, int intensity) {
     int  newTarget     = on ? intensity : 0;
 
     if (newTarget != oldTarget) {
-        targetLEDIntensity = newTarget;
+        setLEDTarget(newTarget);
         stateChanged = true;
         if (newTarget > 0) {
             Serial.printf("[led] LEDs LIGADO (task), alvo: %d/255\n", newTarget);
@@ -565,50 +1309,153 @@ void ActuatorController::controlLEDs(bool on, int intensity) {
     }
 }
 
-void ActuatorController::controlRelay(uint8_t relayNumber, bool state) {
-    bool stateChanged = false;
+void ActuatorController::setLEDTarget(int level) {
+    if (level == targetLEDIntensity) return;
+    targetLEDIntensity = level;
+    ledReleaseUs = esp_timer_get_time();
+    if (ledPwmTaskHandle != nullptr) xTaskNotifyGive(ledPwmTaskHandle);
+}
 
-    switch(relayNumber) {
-        case 1:
-            if (relay1State != state) {
-                digitalWrite(_pinRelay1, state ? HIGH : LOW);
-                relay1State  = state;
-                stateChanged = true;
-            }
-            break;
-        case 2:
-            if (relay2State != state) {
-                digitalWrite(_pinRelay2, state ? HIGH : LOW);
-                relay2State  = state;
-                stateChanged = true;
-            }
-            break;
-        case 3:
-            if (relay3State != state) {
-                digitalWrite(_pinRelay3, state ? HIGH : LOW);
-                relay3State  = state;
-                humidifierOn = state;
-                stateChanged = true;
-            }
-            break;
-        case 4:
-            if (relay4State != state) {
-                digitalWrite(_pinRelay4, state ? HIGH : LOW);
-                relay4State  = state;
-                stateChanged = true;
-            }
-            break;
+bool ActuatorController::controlRelay(uint8_t relayNumber, bool state, bool force) {
+    if (relayNumber < 1 || relayNumber > 4) return false;
+    unsigned long now = millis();
+    reconcileSafetyCuts(now);
+    if (getRelayState(relayNumber) == (state ? 1 : 0)) return true;
+
+    if (!force && !relayGuard.permit(relayNumber, state, now)) {
+        return false;
+    }
+    if (!writeRelay(relayNumber, state, now)) {
+        return false;
     }
 
-    if (stateChanged) {
-        Serial.printf("[actuator] Rele %d: %s\n", relayNumber, state ? "LIGADO" : "DESLIGADO");
+    Serial.printf("[actuator] Rele %d: %s\n", relayNumber, state ? "LIGADO" : "DESLIGADO");
 
-        if (_allowFirebaseUpdates &&
-            firebaseHandler != nullptr && firebaseHandler->isAuthenticated() &&
-            firebaseHandler->isFirebaseReady() && canWriteToFirebase()) {
-            updateFirebaseStateImmediately();
-        }
+    if (_allowFirebaseUpdates &&
+        firebaseHandler != nullptr && firebaseHandler->isAuthenticated() &&
+        firebaseHandler->isFirebaseReady() && canWriteToFirebase()) {
+        updateFirebaseStateImmediately();
     }
+    return true;
+}
+
+bool ActuatorController::writeRelay(uint8_t relayNumber, bool state, unsigned long now) {
+    bool* st  = nullptr;
+    uint8_t pin = 0;
+    switch (relayNumber) {
+        case 1: st = &relay1State; pin = _pinRelay1; break;
+        case 2: st = &relay2State; pin = _pinRelay2; break;
+        case 3: st = &relay3State; pin = _pinRelay3; break;
+        case 4: st = &relay4State; pin = _pinRelay4; break;
+        default: return false;
+    }
+    reconcileSafetyCuts(now);
+    if (*st == state) return true;
+
+    accountEnergy(now);   // fecha o intervalo com a potência antiga
+
+    // Mesma seção crítica de safetyEnforce(): o bloqueio não pode ser
+    // definido entre a verificação e a escrita do pino
+    uint8_t bit = 1 << (relayNumber - 1);
+    portENTER_CRITICAL(&_relayMux);
+    bool blocked = state && (_safetyInhibit & bit);
+    if (!blocked) {
+        digitalWrite(pin, state ? HIGH : LOW);
+        *st = state;
+    }
+    portEXIT_CRITICAL(&_relayMux);
+    if (blocked) return false;
+
+    if (relayNumber == 3) humidifierOn = state;
+    relayGuard.record(relayNumber, state, now);
+    return true;
+}
+
+// =============================================================================
+// SUPERVISOR DE SEGURANÇA
+// =============================================================================
+
+uint8_t ActuatorController::relayOutputs() const {
+    portENTER_CRITICAL(&_relayMux);
+    uint8_t on = (relay1State ? 0x01 : 0) | (relay2State ? 0x02 : 0) |
+                 (relay3State ? 0x04 : 0) | (relay4State ? 0x08 : 0);
+    on &= ~_safetyCut;
+    portEXIT_CRITICAL(&_relayMux);
+    return on;
+}
+
+uint8_t ActuatorController::safetyEnforce(uint8_t inhibitMask) {
+    const uint8_t pins[4] = {_pinRelay1, _pinRelay2, _pinRelay3, _pinRelay4};
+
+    portENTER_CRITICAL(&_relayMux);
+    _safetyInhibit = inhibitMask;
+    uint8_t on = (relay1State ? 0x01 : 0) | (relay2State ? 0x02 : 0) |
+                 (relay3State ? 0x04 : 0) | (relay4State ? 0x08 : 0);
+    on &= ~_safetyCut;
+    uint8_t cut = on & inhibitMask;
+    // Par do Peltier: sem R1 R2 não serve; R2 sai com R1 ligado inverteria o sentido em carga
+    if (cut & 0x03) cut |= on & 0x03;
+    // R1 (potência) antes de R2 (sentido). Bloqueados são reescritos em nível
+    // baixo a cada período — cobre escrita direta no pino pelo devmode.
+    for (uint8_t i = 0; i < 4; i++) {
+        if ((cut | inhibitMask) & (1 << i)) digitalWrite(pins[i], LOW);
+    }
+    _safetyCut |= cut;
+    portEXIT_CRITICAL(&_relayMux);
+    return cut;
+}
+
+void ActuatorController::reconcileSafetyCuts(unsigned long now) {
+    if (_safetyCut == 0) return;
+
+    accountEnergy(now);   // o corte ocorreu há no máximo um ciclo de controle
+
+    bool* states[4] = {&relay1State, &relay2State, &relay3State, &relay4State};
+    portENTER_CRITICAL(&_relayMux);
+    uint8_t cut = _safetyCut;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (cut & (1 << i)) *states[i] = false;
+    }
+    _safetyCut = 0;
+    portEXIT_CRITICAL(&_relayMux);
+
+    for (uint8_t i = 0; i < 4; i++) {
+        if (cut & (1 << i)) relayGuard.record(i + 1, false, now);
+    }
+    if (cut & 0x03) {
+        currentPeltierMode  = OFF;
+        peltierActive       = false;
+        peltierHeatingStart = 0;
+        peltierTpo.forceOff(now);
+    }
+    if (cut & 0x04) {
+        humidifierOn = false;
+        humidifierTpo.forceOff(now);
+    }
+    Serial.printf("[safety] Reles 0x%X cortados pelo supervisor — estado sincronizado\n", cut);
+}
+
+void ActuatorController::accountEnergy(unsigned long now) {
+    float w[ENERGY_CHANNELS] = {0.0f, 0.0f, 0.0f, 0.0f};
+    if (relay1State) w[ENERGY_PELTIER] = relay2State ? energyRatings.peltierHeatW
+                                                     : energyRatings.peltierCoolW;
+    if (relay3State) w[ENERGY_HUMIDIFIER] = energyRatings.humidifierW;
+    if (relay4State) w[ENERGY_EXHAUST]    = energyRatings.exhaustW;
+
+    // Potência do LED proporcional ao duty efetivo no pino (após a curva CIE)
+    int intensity = currentLEDIntensity;
+    if (intensity > 0) {
+        w[ENERGY_LED] = energyRatings.ledFullW * ledDutyForLogical(intensity);
+    }
+    energyMeter.integrate(w, now);
+}
+
+void ActuatorController::setRelayWearLimits(uint8_t relayNumber, unsigned long minOnMs,
+                                            unsigned long minOffMs, uint16_t maxSwitchesPerHour) {
+    if (relayNumber < 1 || relayNumber > 4) return;
+    RelayWearConfig cfg = {minOnMs, minOffMs, maxSwitchesPerHour};
+    relayGuard.configure(relayNumber, cfg);
+    if (relayNumber == 3) fitHumidifierWindowToRelay();
 }
 
 // =============================================================================
@@ -650,13 +1497,9 @@ int ActuatorController::getLEDsWatts() const {
 }
 
 int ActuatorController::getRelayState(uint8_t relayNumber) const {
-    switch(relayNumber) {
-        case 1: return relay1State;
-        case 2: return relay2State;
-        case 3: return relay3State;
-        case 4: return relay4State;
-        default: return -1;
-    }
+    if (relayNumber < 1 || relayNumber > 4) return -1;
+    // Saída efetiva: corte do supervisor ainda não sincronizado conta como desligado
+    return (relayOutputs() >> (relayNumber - 1)) & 1;
 }
 
 // =============================================================================
@@ -669,6 +1512,7 @@ void ActuatorController::setDebugMode(bool debug) {
         Serial.println(debugMode ? "[debug] DEBUG MODE: ON" : "[debug] DEBUG MODE: OFF");
 
         if (debugMode) {
+            abortAutotune("modo debug ativado");
             setFirebaseWriteBlock(true);
         }
 
@@ -687,30 +1531,29 @@ void ActuatorController::setManualStates(bool relay1, bool relay2, bool relay3,
 
     bool anyChange = false;
 
+    // Comando manual explícito: ignora as regras de desgaste, mas é contado.
+    // Bloqueio do SafetySupervisor continua valendo.
+    unsigned long now = millis();
+    reconcileSafetyCuts(now);
     if (relay1 != relay1State) {
-        digitalWrite(_pinRelay1, relay1 ? HIGH : LOW);
-        relay1State = relay1;
+        bool ok = writeRelay(1, relay1, now);
         anyChange   = true;
-        Serial.printf("[debug] Relay 1: %s\n", relay1 ? "ON" : "OFF");
+        Serial.printf("[debug] Relay 1: %s\n", !ok ? "BLOQUEADO (seguranca)" : relay1 ? "ON" : "OFF");
     }
     if (relay2 != relay2State) {
-        digitalWrite(_pinRelay2, relay2 ? HIGH : LOW);
-        relay2State = relay2;
+        bool ok = writeRelay(2, relay2, now);
         anyChange   = true;
-        Serial.printf("[debug] Relay 2: %s\n", relay2 ? "ON" : "OFF");
+        Serial.printf("[debug] Relay 2: %s\n", !ok ? "BLOQUEADO (seguranca)" : relay2 ? "ON" : "OFF");
     }
     if (relay3 != relay3State) {
-        digitalWrite(_pinRelay3, relay3 ? HIGH : LOW);
-        relay3State  = relay3;
-        humidifierOn = relay3;
+        bool ok = writeRelay(3, relay3, now);
         anyChange    = true;
-        Serial.printf("[debug] Relay 3 (Humidifier): %s\n", relay3 ? "ON" : "OFF");
+        Serial.printf("[debug] Relay 3 (Humidifier): %s\n", !ok ? "BLOQUEADO (seguranca)" : relay3 ? "ON" : "OFF");
     }
     if (relay4 != relay4State) {
-        digitalWrite(_pinRelay4, relay4 ? HIGH : LOW);
-        relay4State = relay4;
+        bool ok = writeRelay(4, relay4, now);
         anyChange   = true;
-        Serial.printf("[debug] Relay 4: %s\n", relay4 ? "ON" : "OFF");
+        Serial.printf("[debug] Relay 4: %s\n", !ok ? "BLOQUEADO (seguranca)" : relay4 ? "ON" : "OFF");
     }
 
     int requestedIntensity = ledsOn ? ledsIntensity : 0;
@@ -754,6 +1597,16 @@ void ActuatorController::executeDevModeOperations() {
         }
     }
 
+    // Relé bloqueado pelo SafetySupervisor não liga por escrita direta no pino
+    const int relayPins[4] = {_pinRelay1, _pinRelay2, _pinRelay3, _pinRelay4};
+    for (uint8_t i = 0; i < 4; i++) {
+        if (devModePin == relayPins[i] && (devModeDigitalWrite || devModePWM) &&
+            devModePWMValue > 0 && safetyInhibited(1 << i)) {
+            Serial.printf("[debug] BLOQUEADO - rele %u bloqueado pelo supervisor de seguranca\n", i + 1);
+            return;
+        }
+    }
+
     if (devModeAnalogRead) {
         int analogValue = analogRead(devModePin);
         Serial.printf("[debug] Analog Read - Pin %d: %d\n", devModePin, analogValue);
@@ -810,7 +1663,8 @@ void ActuatorController::handleDevMode() {
 void ActuatorController::applyLEDSchedule(unsigned long ts) {
     ledScheduler.update(ts, debugMode);
     persistLEDScheduleIfChanged();
-    if (ledScheduler.isActive() && !debugMode) {
+    // Regra de LED ativa tem precedência — aplicada em controlAutomatically()
+    if (ledScheduler.isActive() && !debugMode && !_ruleLedOverride) {
         int schedIntensity = ledScheduler.wantsLEDsOn() ? ledScheduler.getIntensity() : 0;
         if (schedIntensity != currentLEDIntensity) {
             controlLEDs(schedIntensity > 0, schedIntensity);
@@ -832,6 +1686,10 @@ void ActuatorController::saveLEDScheduleNVS() {
     preferences.putInt("offH", ledScheduler.offHour);
     preferences.putInt("offM", ledScheduler.offMinute);
     preferences.putInt("int",  ledScheduler.configIntensity);
+    preferences.putString("win", ledScheduler.windows.text());
+    preferences.putBool("astEn", ledScheduler.astroEnabled);
+    preferences.putFloat("lat", ledScheduler.latitude);
+    preferences.putFloat("lon", ledScheduler.longitude);
     preferences.putUInt("rev", millis());
     preferences.end();
 }
@@ -854,8 +1712,16 @@ bool ActuatorController::loadLEDScheduleNVS() {
     ledScheduler.offHour         = preferences.getInt("offH", 20);
     ledScheduler.offMinute       = preferences.getInt("offM", 0);
     ledScheduler.configIntensity = preferences.getInt("int",  255);
+    String windows = preferences.getString("win", "");
+    ledScheduler.astroEnabled    = preferences.getBool("astEn", false);
+    ledScheduler.latitude        = preferences.getFloat("lat", ledScheduler.latitude);
+    ledScheduler.longitude       = preferences.getFloat("lon", ledScheduler.longitude);
     preferences.end();
 
+    // Chave "win" (v1.11) ausente em NVS antiga → janela única dos campos acima
+    String error;
+    ledScheduler.windows.setText(windows, error);
+
     _loadedScheduleFromNvs = true;
     Serial.printf("[led] Restored led_schedule from NVS (%s%s %02d:%02d-%02d:%02d int=%d)\n",
                   ledScheduler.scheduleEnabled ? "timer " : "",
@@ -874,10 +1740,17 @@ void ActuatorController::persistLEDScheduleIfChanged() {
     static int  lastOffHour         = -1;
     static int  lastOffMinute       = -1;
     static int  lastIntensity       = -1;
+    static uint32_t lastWindowsRev  = 0;
+    static bool  lastAstroEnabled   = false;
+    static float lastLatitude       = 0.0f;
+    static float lastLongitude      = 0.0f;
     static bool initialized         = false;
 
     if (!initialized) {
         initialized         = true;
+        lastAstroEnabled    = ledScheduler.astroEnabled;
+        lastLatitude        = ledScheduler.latitude;
+        lastLongitude       = ledScheduler.longitude;
         lastScheduleEnabled = ledScheduler.scheduleEnabled;
         lastSolarEnabled    = ledScheduler.solarSimEnabled;
         lastOnHour          = ledScheduler.onHour;
@@ -885,6 +1758,7 @@ void ActuatorController::persistLEDScheduleIfChanged() {
         lastOffHour         = ledScheduler.offHour;
         lastOffMinute       = ledScheduler.offMinute;
         lastIntensity       = ledScheduler.configIntensity;
+        lastWindowsRev      = ledScheduler.windows.revision();
         if (_loadedScheduleFromNvs) return;
     }
 
@@ -896,6 +1770,10 @@ void ActuatorController::persistLEDScheduleIfChanged() {
     if (lastOffHour         != ledScheduler.offHour)         changed = true;
     if (lastOffMinute       != ledScheduler.offMinute)       changed = true;
     if (lastIntensity       != ledScheduler.configIntensity) changed = true;
+    if (lastWindowsRev      != ledScheduler.windows.revision()) changed = true;
+    if (lastAstroEnabled    != ledScheduler.astroEnabled)    changed = true;
+    if (lastLatitude        != ledScheduler.latitude)        changed = true;
+    if (lastLongitude       != ledScheduler.longitude)       changed = true;
 
     if (!changed) return;
 
@@ -906,10 +1784,62 @@ void ActuatorController::persistLEDScheduleIfChanged() {
     lastOffHour         = ledScheduler.offHour;
     lastOffMinute       = ledScheduler.offMinute;
     lastIntensity       = ledScheduler.configIntensity;
+    lastWindowsRev      = ledScheduler.windows.revision();
+    lastAstroEnabled    = ledScheduler.astroEnabled;
+    lastLatitude        = ledScheduler.latitude;
+    lastLongitude       = ledScheduler.longitude;
 
     saveLEDScheduleNVS();
 }
 
+// =============================================================================
+// REGRAS DO USUÁRIO
+// =============================================================================
+
+bool ActuatorController::loadRules(const String& source, int version, bool persist, String& error) {
+    if (!ruleEngine.load(source, error)) {
+        Serial.printf("[rules] Versao %d rejeitada: %s\n", version, error.c_str());
+        return false;
+    }
+    _rulesVersion    = version;
+    _ruleLedOverride = false;
+    Serial.printf("[rules] Versao %d carregada: %u regra(s), %u bytes de bytecode\n",
+                  version, ruleEngine.ruleCount(), ruleEngine.codeSize());
+    if (persist) {
+        saveRulesNVS(source);
+    }
+    return true;
+}
+
+void ActuatorController::saveRulesNVS(const String& source) {
+    Preferences preferences;
+    if (!preferences.begin("rules", false)) {
+        Serial.println("[rules] Failed opening NVS to save rules");
+        return;
+    }
+    preferences.putString("src", source);
+    preferences.putInt("ver", _rulesVersion);
+    preferences.end();
+}
+
+bool ActuatorController::loadRulesNVS() {
+    Preferences preferences;
+    if (!preferences.begin("rules", true)) {
+        return false;
+    }
+    if (!preferences.isKey("src")) {
+        preferences.end();
+        return false;
+    }
+    String source = preferences.getString("src", "");
+    int version   = preferences.getInt("ver", 0);
+    preferences.end();
+
+    // Fonte salva já compilou uma vez; falha aqui só com firmware mais antigo
+    String error;
+    return loadRules(source, version, false, error);
+}
+
 // =============================================================================
 // AGENDADOR DO EXAUSTOR
 // =============================================================================
@@ -935,6 +1865,12 @@ void ActuatorController::saveExhaustScheduleNVS() {
     preferences.putInt("onM",  exhaustScheduler.onMinute);
     preferences.putInt("offH", exhaustScheduler.offHour);
     preferences.putInt("offM", exhaustScheduler.offMinute);
+    preferences.putBool("cyEn",  exhaustScheduler.cycleEnabled);
+    preferences.putInt("cyOn",  exhaustScheduler.cycleOnMinutes);
+    preferences.putInt("cyPer", exhaustScheduler.cyclePeriodMinutes);
+    preferences.putInt("cyOut", exhaustScheduler.cycleOutsideOnMinutes);
+    preferences.putInt("cyJit", exhaustScheduler.jitterMinutes);
+    preferences.putString("win", exhaustScheduler.windows.text());
     preferences.putUInt("rev", millis());
     preferences.end();
 }
@@ -955,13 +1891,26 @@ bool ActuatorController::loadExhaustScheduleNVS() {
     exhaustScheduler.onMinute        = preferences.getInt("onM",  0);
     exhaustScheduler.offHour         = preferences.getInt("offH", 20);
     exhaustScheduler.offMinute       = preferences.getInt("offM", 0);
+    // Chaves do ciclo (v1.1) ausentes em NVS antiga → defaults da classe
+    exhaustScheduler.cycleEnabled          = preferences.getBool("cyEn", false);
+    exhaustScheduler.cycleOnMinutes        = preferences.getInt("cyOn",  exhaustScheduler.cycleOnMinutes);
+    exhaustScheduler.cyclePeriodMinutes    = preferences.getInt("cyPer", exhaustScheduler.cyclePeriodMinutes);
+    exhaustScheduler.cycleOutsideOnMinutes = preferences.getInt("cyOut", exhaustScheduler.cycleOutsideOnMinutes);
+    exhaustScheduler.jitterMinutes         = preferences.getInt("cyJit", exhaustScheduler.jitterMinutes);
+    String windows = preferences.getString("win", "");
     preferences.end();
 
+    String error;
+    exhaustScheduler.windows.setText(windows, error);
+    exhaustScheduler.fitCycleToRelay(relayGuard.config(4));   // ciclo salvo antes do ajuste
+
     _loadedExhaustScheduleFromNvs = true;
-    Serial.printf("[exhaust] Restored exhaust_schedule from NVS (%s %02d:%02d-%02d:%02d)\n",
+    Serial.printf("[exhaust] Restored exhaust_schedule from NVS (%s %02d:%02d-%02d:%02d, ciclo %s %d/%d min)\n",
                   exhaustScheduler.scheduleEnabled ? "on" : "off",
                   exhaustScheduler.onHour, exhaustScheduler.onMinute,
-                  exhaustScheduler.offHour, exhaustScheduler.offMinute);
+                  exhaustScheduler.offHour, exhaustScheduler.offMinute,
+                  exhaustScheduler.cycleEnabled ? "on" : "off",
+                  exhaustScheduler.cycleOnMinutes, exhaustScheduler.cyclePeriodMinutes);
     return true;
 }
 
@@ -971,15 +1920,27 @@ void ActuatorController::persistExhaustScheduleIfChanged() {
     static int  lastOnMinute        = -1;
     static int  lastOffHour         = -1;
     static int  lastOffMinute       = -1;
+    static bool lastCycleEnabled    = false;
+    static int  lastCycleOn         = -1;
+    static int  lastCyclePeriod     = -1;
+    static int  lastCycleOutside    = -1;
+    static int  lastJitter          = -1;
+    static uint32_t lastWindowsRev  = 0;
     static bool initialized         = false;
 
     if (!initialized) {
         initialized         = true;
+        lastCycleEnabled    = exhaustScheduler.cycleEnabled;
+        lastCycleOn         = exhaustScheduler.cycleOnMinutes;
+        lastCyclePeriod     = exhaustScheduler.cyclePeriodMinutes;
+        lastCycleOutside    = exhaustScheduler.cycleOutsideOnMinutes;
+        lastJitter          = exhaustScheduler.jitterMinutes;
         lastScheduleEnabled = exhaustScheduler.scheduleEnabled;
         lastOnHour          = exhaustScheduler.onHour;
         lastOnMinute        = exhaustScheduler.onMinute;
         lastOffHour          = exhaustScheduler.offHour;
         lastOffMinute        = exhaustScheduler.offMinute;
+        lastWindowsRev       = exhaustScheduler.windows.revision();
         if (_loadedExhaustScheduleFromNvs) return;
     }
 
@@ -989,9 +1950,22 @@ void ActuatorController::persistExhaustScheduleIfChanged() {
     if (lastOnMinute        != exhaustScheduler.onMinute)        changed = true;
     if (lastOffHour         != exhaustScheduler.offHour)         changed = true;
     if (lastOffMinute       != exhaustScheduler.offMinute)       changed = true;
+    if (lastCycleEnabled    != exhaustScheduler.cycleEnabled)          changed = true;
+    if (lastCycleOn         != exhaustScheduler.cycleOnMinutes)        changed = true;
+    if (lastCyclePeriod     != exhaustScheduler.cyclePeriodMinutes)    changed = true;
+    if (lastCycleOutside    != exhaustScheduler.cycleOutsideOnMinutes) changed = true;
+    if (lastJitter          != exhaustScheduler.jitterMinutes)         changed = true;
+    if (lastWindowsRev      != exhaustScheduler.windows.revision())    changed = true;
 
     if (!changed) return;
 
+    lastCycleEnabled    = exhaustScheduler.cycleEnabled;
+    lastCycleOn         = exhaustScheduler.cycleOnMinutes;
+    lastCyclePeriod     = exhaustScheduler.cyclePeriodMinutes;
+    lastCycleOutside    = exhaustScheduler.cycleOutsideOnMinutes;
+    lastJitter          = exhaustScheduler.jitterMinutes;
+    lastWindowsRev      = exhaustScheduler.windows.revision();
+
     lastScheduleEnabled = exhaustScheduler.scheduleEnabled;
     lastOnHour          = exhaustScheduler.onHour;
     lastOnMinute        = exhaustScheduler.onMinute;
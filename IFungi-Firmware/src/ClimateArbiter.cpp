@@ -0,0 +1,70 @@
+/**
+ * @file ClimateArbiter.cpp
+ * @brief Implementação da arbitragem umidificação x ventilação
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "ClimateArbiter.h"
+
+static const char* const ARB_STATE_NAMES[ARB_STATES] = {
+    "semConflito", "rajadaVentilacao", "recuperacaoUmidade", "umidificadorPausado"
+};
+
+const char* ClimateArbiter::stateName(ArbiterState s) {
+    return s < ARB_STATES ? ARB_STATE_NAMES[s] : "?";
+}
+
+void ClimateArbiter::_enter(ArbiterState s, unsigned long now) {
+    if (s == _state) return;
+    _accum[_state] += now - _enteredAt;
+    _state     = s;
+    _enteredAt = now;
+    _entries[s]++;
+    Serial.printf("[arbiter] Estado: %s\n", stateName(s));
+}
+
+uint32_t ClimateArbiter::timeInState(ArbiterState s, unsigned long now) const {
+    if (s >= ARB_STATES) return 0;
+    uint32_t t = _accum[s];
+    if (s == _state) t += now - _enteredAt;
+    return t;
+}
+
+ClimateDecision ClimateArbiter::arbitrate(const ClimateIntents& in, unsigned long now) {
+    ClimateDecision d = {in.humidify, in.ventilate};
+
+    if (!in.humidify || !in.ventilate) {
+        // Sem conflito: cada malha decide sozinha
+        _enter(ARB_IDLE, now);
+        return d;
+    }
+
+    if (in.ventMandatory) {
+        _enter(ARB_HUMIDIFIER_PAUSED, now);
+        d.humidifier = false;
+        return d;
+    }
+
+    // Conflito adiável: alterna rajada de ventilação e recuperação de umidade.
+    // Vindo de uma pausa obrigatória o ar já foi renovado → começa recuperando.
+    switch (_state) {
+        case ARB_VENT_BURST:
+            if (now - _enteredAt >= ventBurstMs) _enter(ARB_HUMIDITY_RECOVERY, now);
+            break;
+        case ARB_HUMIDITY_RECOVERY:
+            if (now - _enteredAt >= recoveryMs) _enter(ARB_VENT_BURST, now);
+            break;
+        case ARB_HUMIDIFIER_PAUSED:
+            _enter(ARB_HUMIDITY_RECOVERY, now);
+            break;
+        default:
+            _enter(ARB_VENT_BURST, now);
+            break;
+    }
+
+    bool venting = (_state == ARB_VENT_BURST);
+    d.exhaust    = venting;
+    d.humidifier = !venting;
+    return d;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file DaylightHarvester.cpp
+ * @brief Calibração do ganho dos LEDs no LDR e malha de dimerização
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "DaylightHarvester.h"
+#include "ActuatorController.h"
+#include <Preferences.h>
+#include <cmath>
+
+// =============================================================================
+// PERSISTÊNCIA
+// =============================================================================
+
+void DaylightHarvester::begin() {
+    Preferences preferences;
+    if (!preferences.begin("daylight", true)) return;
+    if (preferences.isKey("ledFull")) {
+        _gain   = preferences.getFloat("ledFull", 0.0f);
+        _calDue = false;
+        Serial.printf("[led] Ganho LED->LDR restaurado da NVS: %.0f em 100%%%s\n",
+                      _gain, closedLoop() ? "" : " (malha aberta)");
+    }
+    preferences.end();
+}
+
+void DaylightHarvester::_save() {
+    Preferences preferences;
+    if (!preferences.begin("daylight", false)) {
+        Serial.println("[led] Failed opening NVS to save daylight gain");
+        return;
+    }
+    preferences.putFloat("ledFull", _gain);
+    preferences.end();
+}
+
+// =============================================================================
+// MALHA
+// =============================================================================
+
+void DaylightHarvester::_restart(int applied) {
+    _commanded  = applied;
+    _settledAt  = 0;
+    _lastSample = 0;
+    _daylight   = NAN;
+    _state      = HARVEST_RUN;   // calibração interrompida continua pendente
+    _trim.reset();
+}
+
+int DaylightHarvester::_command(int level) {
+    if (level != _commanded) {
+        _commanded = level;
+        _settledAt = 0;
+    }
+    return _commanded;
+}
+
+int DaylightHarvester::update(int light, int applied, float target, unsigned long now,
+                              bool calibrationAllowed) {
+    if (_commanded < 0 || now - _lastCall > RESTART_GAP_MS) {
+        _restart(applied);
+    }
+    _lastCall = now;
+
+    // Fade em curso ou recém-concluído: a leitura ainda não corresponde ao nível
+    if (applied != _commanded) {
+        _settledAt = 0;
+        return _commanded;
+    }
+    if (_settledAt == 0) {
+        _settledAt = now;
+        return _commanded;
+    }
+    if (now - _settledAt < (_state == HARVEST_RUN ? SETTLE_MS : CAL_SETTLE_MS)) {
+        return _commanded;
+    }
+
+    // Varredura 0 → 255 só no período claro da agenda; no escuro fica pendente
+    if (_state == HARVEST_RUN && calibrationAllowed && (_calDue || now - _calAt >= CAL_INTERVAL_MS)) {
+        Serial.println("[led] Calibrando ganho LED->LDR (apagado/255)...");
+        _state = HARVEST_CAL_DARK;
+        return _command(0);
+    }
+    if (_state != HARVEST_RUN) {
+        return _calibrate(light, now) < 0 ? _regulate(light, target, now) : _commanded;
+    }
+    return _regulate(light, target, now);
+}
+
+/// @return -1 quando a calibração terminou e a malha deve rodar neste passo
+int DaylightHarvester::_calibrate(int light, unsigned long now) {
+    if (_state == HARVEST_CAL_DARK) {
+        _calDark = light;
+        _state   = HARVEST_CAL_BRIGHT;
+        return _command(255);
+    }
+
+    float gain = (light - _calDark) / ActuatorController::ledDutyForLogical(255);
+    _gain   = gain >= GAIN_MIN ? gain : 0.0f;
+    _calDue = false;
+    _calAt  = now;
+    _state  = HARVEST_RUN;
+    _save();
+    if (closedLoop()) {
+        Serial.printf("[led] Ganho LED->LDR: %.0f em 100%% (apagado %.0f, 255 -> %d)\n",
+                      _gain, _calDark, light);
+    } else {
+        Serial.printf("[led] WARN: LDR nao enxerga os LEDs (%.0f -> %d), liga/desliga por limiar\n",
+                      _calDark, light);
+    }
+    return -1;
+}
+
+int DaylightHarvester::_regulate(int light, float target, unsigned long now) {
+    float dt = _lastSample ? (now - _lastSample) / 1000.0f : 0.0f;
+    _lastSample = now;
+
+    if (!closedLoop()) {
+        if (light < target * (1.0f - DEADBAND_FRACTION)) return _command(255);
+        if (light > target * (1.0f + DEADBAND_FRACTION)) return _command(0);
+        return _commanded;
+    }
+
+    // Luz natural: leitura menos a contribuição dos LEDs no duty aplicado
+    float duty   = ActuatorController::ledDutyForLogical(_commanded);
+    float sample = light - _gain * duty;
+    if (isnan(_daylight) || dt <= 0.0f) {
+        _daylight = sample;
+    } else {
+        _daylight += (sample - _daylight) * (dt / (dt + FILTER_TAU_S));
+    }
+
+    float total = _daylight + _gain * duty;
+    float error = target - total;
+    if (fabsf(error) <= target * DEADBAND_FRACTION) error = 0.0f;
+
+    // Feedforward e PI em duty; o comando volta ao nível lógico pela curva
+    float trim  = _trim.compute(error / _gain, total / _gain, dt);
+    float level = ActuatorController::ledLogicalForDuty((target - _daylight) / _gain + trim);
+
+    // Abaixo do mínimo útil desliga; histerese evita liga/desliga no limite
+    if (level < MIN_ON_LEVEL) {
+        bool hold = _commanded >= MIN_ON_LEVEL && level >= MIN_ON_LEVEL / 2;
+        level = hold ? MIN_ON_LEVEL : 0.0f;
+    }
+
+    float maxStep = MAX_SLEW_PER_S * (dt > 0.0f ? dt : SETTLE_MS / 1000.0f);
+    float slewed  = level;
+    if (slewed > _commanded + maxStep) slewed = _commanded + maxStep;
+    if (slewed < _commanded - maxStep) slewed = _commanded - maxStep;
+    int next = (int)(slewed + 0.5f);
+    if (next < MIN_ON_LEVEL) next = level > 0.0f ? MIN_ON_LEVEL : 0;
+
+    // Passos menores que LEVEL_STEP só para chegar ao destino final
+    if (abs(next - _commanded) < LEVEL_STEP && next != (int)(level + 0.5f)) {
+        return _commanded;
+    }
+    return _command(next);
+}
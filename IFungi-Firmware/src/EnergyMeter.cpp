@@ -0,0 +1,167 @@
+/**
+ * @file EnergyMeter.cpp
+ * @brief Implementação da contabilização de energia por atuador
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "EnergyMeter.h"
+#include <Preferences.h>
+#include <esp_attr.h>
+#include <stddef.h>
+#include <string.h>
+
+static const uint32_t ENERGY_MAGIC = 0x454E5231;   // "ENR1"
+
+/// Imagem persistida (RTC e NVS usam o mesmo layout)
+struct EnergyState {
+    uint32_t     magic;
+    uint32_t     day;    ///< Dia (epoch local / 86400) de "hoje"; 0 = desconhecido
+    uint32_t     week;   ///< Semana iniciada na segunda-feira
+    EnergyTotals period[ENERGY_PERIODS];
+    uint32_t     checksum;
+};
+
+RTC_NOINIT_ATTR static EnergyState s_energy;
+
+static uint32_t energyChecksum(const EnergyState& st) {
+    // FNV-1a sobre tudo menos o próprio checksum
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&st);
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < offsetof(EnergyState, checksum); i++) {
+        h ^= p[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static bool energyValid(const EnergyState& st) {
+    return st.magic == ENERGY_MAGIC && st.checksum == energyChecksum(st);
+}
+
+static const char* const ENERGY_CHANNEL_NAMES[ENERGY_CHANNELS] = {
+    "peltier", "umidificador", "exaustor", "led"
+};
+static const char* const ENERGY_PERIOD_NAMES[ENERGY_PERIODS] = {
+    "hoje", "ontem", "semana", "semanaAnterior", "total"
+};
+
+const char* EnergyMeter::channelName(EnergyChannel c) {
+    return c < ENERGY_CHANNELS ? ENERGY_CHANNEL_NAMES[c] : "?";
+}
+
+const char* EnergyMeter::periodName(EnergyPeriod p) {
+    return p < ENERGY_PERIODS ? ENERGY_PERIOD_NAMES[p] : "?";
+}
+
+void EnergyMeter::begin() {
+    const char* source = "RTC";
+    if (!energyValid(s_energy)) {
+        source = "NVS";
+        memset(&s_energy, 0, sizeof(s_energy));
+        Preferences prefs;
+        if (prefs.begin("energy", true)) {
+            EnergyState saved;
+            if (prefs.getBytesLength("state") == sizeof(saved) &&
+                prefs.getBytes("state", &saved, sizeof(saved)) == sizeof(saved) &&
+                energyValid(saved)) {
+                s_energy = saved;
+            } else {
+                source = "zero";
+            }
+            prefs.end();
+        } else {
+            source = "zero";   // primeiro boot
+        }
+        s_energy.magic    = ENERGY_MAGIC;
+        s_energy.checksum = energyChecksum(s_energy);
+    }
+
+    _lastIntegrate  = millis();
+    _lastCheckpoint = _lastIntegrate;
+    _lastClockCheck = 0;
+    _started        = true;
+
+    Serial.printf("[energy] Acumuladores retomados (%s): hoje %.1f Wh, total %.2f kWh\n",
+                  source, totalWh(ENERGY_TODAY), totalWh(ENERGY_LIFETIME) / 1000.0);
+}
+
+void EnergyMeter::integrate(const float watts[ENERGY_CHANNELS], unsigned long now) {
+    if (!_started) return;
+    double dtSec = (now - _lastIntegrate) / 1000.0;
+    _lastIntegrate = now;
+    if (dtSec <= 0.0) return;
+
+    for (uint8_t c = 0; c < ENERGY_CHANNELS; c++) {
+        if (watts[c] <= 0.0f) continue;
+        double wh = watts[c] * dtSec / 3600.0;
+        for (uint8_t p = 0; p < ENERGY_PERIODS; p++) {
+            if (p == ENERGY_YESTERDAY || p == ENERGY_LAST_WEEK) continue;
+            s_energy.period[p].wh[c]    += wh;
+            s_energy.period[p].onSec[c] += dtSec;
+        }
+    }
+    s_energy.checksum = energyChecksum(s_energy);
+}
+
+void EnergyMeter::_rollover(uint32_t day) {
+    uint32_t week = (day + 3) / 7;   // 01/01/1970 foi quinta-feira → semanas começam na segunda
+
+    if (s_energy.day == 0) {
+        // Primeira hora conhecida: o que já acumulou pertence a hoje
+        s_energy.day  = day;
+        s_energy.week = week;
+    } else if (day != s_energy.day) {
+        EnergyTotals& today = s_energy.period[ENERGY_TODAY];
+        Serial.printf("[energy] Fim do dia: %.1f Wh\n", totalWh(ENERGY_TODAY));
+        if (day == s_energy.day + 1) s_energy.period[ENERGY_YESTERDAY] = today;
+        else memset(&s_energy.period[ENERGY_YESTERDAY], 0, sizeof(EnergyTotals));
+        memset(&today, 0, sizeof(EnergyTotals));
+
+        if (week != s_energy.week) {
+            if (week == s_energy.week + 1) s_energy.period[ENERGY_LAST_WEEK] = s_energy.period[ENERGY_WEEK];
+            else memset(&s_energy.period[ENERGY_LAST_WEEK], 0, sizeof(EnergyTotals));
+            memset(&s_energy.period[ENERGY_WEEK], 0, sizeof(EnergyTotals));
+        }
+        s_energy.day  = day;
+        s_energy.week = week;
+    } else {
+        return;
+    }
+    s_energy.checksum = energyChecksum(s_energy);
+    checkpoint();
+}
+
+void EnergyMeter::checkpointIfDue(unsigned long now) {
+    if (!_started) return;
+
+    if (_clock != nullptr && (_lastClockCheck == 0 || now - _lastClockCheck >= ENERGY_CLOCK_CHECK_MS)) {
+        _lastClockCheck = now;
+        unsigned long ts = _clock();
+        if (ts > 1609459200UL) _rollover(ts / 86400UL);   // só com hora plausível (> 2021)
+    }
+
+    if (now - _lastCheckpoint >= ENERGY_CHECKPOINT_MS) checkpoint();
+}
+
+void EnergyMeter::checkpoint() {
+    _lastCheckpoint = millis();
+    Preferences prefs;
+    if (!prefs.begin("energy", false)) {
+        Serial.println("[nvs] Error opening NVS to save energy counters");
+        return;
+    }
+    prefs.putBytes("state", &s_energy, sizeof(s_energy));
+    prefs.end();
+}
+
+const EnergyTotals& EnergyMeter::totals(EnergyPeriod p) const {
+    return s_energy.period[p < ENERGY_PERIODS ? p : ENERGY_LIFETIME];
+}
+
+double EnergyMeter::totalWh(EnergyPeriod p) const {
+    const EnergyTotals& t = totals(p);
+    double sum = 0.0;
+    for (uint8_t c = 0; c < ENERGY_CHANNELS; c++) sum += t.wh[c];
+    return sum;
+}
@@ -1166,6 +1166,24 @@ void FirebaseHandler::receiveSetpoints(ActuatorController& actuators) {
         return;
     }
 
+    // Taxas da rampa (opcionais, fora do baseline de 8 campos): nó pequeno
+    // /setpoints/rampa lido inteiro numa só requisição e só a cada
+    // RAMP_RATES_INTERVAL — mudam raramente. Ausente = mantém.
+    static const unsigned long RAMP_RATES_INTERVAL = 60000;
+    static unsigned long lastRampRead = 0;
+    static bool          rampReadOnce = false;
+    if (!rampReadOnce || millis() - lastRampRead >= RAMP_RATES_INTERVAL) {
+        lastRampRead = millis();
+        rampReadOnce = true;
+        if (Firebase.getJSON(fbdo, (base+"rampa").c_str()) && fbdo.dataType() == "json") {
+            FirebaseJson* json = fbdo.jsonObjectPtr();
+            float rampTemp = -1.0f, rampHumidity = -1.0f;
+            if (json->get(result, "temp")) rampTemp     = result.floatValue;
+            if (json->get(result, "umid")) rampHumidity = result.floatValue;
+            actuators.setSetpointRampRates(rampTemp, rampHumidity);
+        }
+    }
+
     // BUG CORRIGIDO v1.2.1: os statics abaixo representam "o que o ESP32 tem
     // carregado agora" — não um snapshot de defaults do firmware.
     //
@@ -1362,6 +1380,20 @@ void FirebaseHandler::receiveLEDSchedule(ActuatorController& actuators) {
     if (json->get(result, "offHour"))         actuators.ledScheduler.offHour         = result.intValue;
     if (json->get(result, "offMinute"))       actuators.ledScheduler.offMinute       = result.intValue;
     if (json->get(result, "intensity"))       actuators.ledScheduler.configIntensity = result.intValue;
+
+    // Janelas múltiplas/noturnas (opcional — ausente mantém o atual)
+    if (json->get(result, "windows")) {
+        String error;
+        if (!actuators.ledScheduler.windows.setText(result.stringValue, error)) {
+            Serial.printf("[led] windows rejeitado (mantendo anterior): %s\n", error.c_str());
+        }
+    }
+
+    // Modo solar astronômico (opcional)
+    LEDScheduler& ls = actuators.ledScheduler;
+    if (json->get(result, "astroEnabled")) ls.astroEnabled = result.boolValue;
+    if (json->get(result, "latitude")  && fabsf(result.floatValue) <= 90.0f)  ls.latitude  = result.floatValue;
+    if (json->get(result, "longitude") && fabsf(result.floatValue) <= 180.0f) ls.longitude = result.floatValue;
 }
 
 // =============================================================================
@@ -1416,6 +1448,10 @@ void FirebaseHandler::ensureLEDScheduleExists(ActuatorController& actuators) {
     ls.set("offHour",         actuators.ledScheduler.offHour);
     ls.set("offMinute",       actuators.ledScheduler.offMinute);
     ls.set("intensity",       actuators.ledScheduler.configIntensity);
+    ls.set("windows",         actuators.ledScheduler.windows.text());
+    ls.set("astroEnabled",    actuators.ledScheduler.astroEnabled);
+    ls.set("latitude",        actuators.ledScheduler.latitude);
+    ls.set("longitude",       actuators.ledScheduler.longitude);
 
     if (Firebase.updateNode(fbdo, path.c_str(), ls)) {
         Serial.println("[led] No led_schedule criado pelo ESP32");
@@ -1445,6 +1481,34 @@ void FirebaseHandler::receiveExhaustSchedule(ActuatorController& actuators) {
     if (json->get(result, "onMinute"))        actuators.exhaustScheduler.onMinute        = result.intValue;
     if (json->get(result, "offHour"))         actuators.exhaustScheduler.offHour         = result.intValue;
     if (json->get(result, "offMinute"))       actuators.exhaustScheduler.offMinute       = result.intValue;
+
+    // Ciclo de troca de ar (opcional — nó antigo sem estes campos mantém o atual)
+    ExhaustScheduler& es = actuators.exhaustScheduler;
+    if (json->get(result, "cycleEnabled"))          es.cycleEnabled = result.boolValue;
+    if (json->get(result, "cycleOnMinutes")        && result.intValue >= 0) es.cycleOnMinutes        = result.intValue;
+    if (json->get(result, "cyclePeriodMinutes")    && result.intValue >  0) es.cyclePeriodMinutes    = result.intValue;
+    if (json->get(result, "cycleOutsideOnMinutes") && result.intValue >= 0) es.cycleOutsideOnMinutes = result.intValue;
+    if (json->get(result, "jitterMinutes")         && result.intValue >= 0) es.jitterMinutes         = result.intValue;
+
+    if (json->get(result, "windows")) {
+        String error;
+        if (!es.windows.setText(result.stringValue, error)) {
+            Serial.printf("[exhaust] windows rejeitado (mantendo anterior): %s\n", error.c_str());
+        }
+    }
+
+    // Ciclo que violaria as regras de desgaste do relé 4 é corrigido; os
+    // valores efetivos voltam ao nó para o app mostrar o que está valendo
+    if (es.fitCycleToRelay(actuators.getRelayGuard().config(4))) {
+        FirebaseJson fix;
+        fix.set("cycleOnMinutes",        es.cycleOnMinutes);
+        fix.set("cyclePeriodMinutes",    es.cyclePeriodMinutes);
+        fix.set("cycleOutsideOnMinutes", es.cycleOutsideOnMinutes);
+        fix.set("jitterMinutes",         es.jitterMinutes);
+        if (!Firebase.updateNode(fbdo, path.c_str(), fix)) {
+            Serial.println("[exhaust] Falha ao publicar ciclo ajustado: " + fbdo.errorReason());
+        }
+    }
 }
 
 // exhaust_schedule — criação autônoma pelo ESP32
@@ -1466,6 +1530,12 @@ void FirebaseHandler::ensureExhaustScheduleExists(ActuatorController& actuators)
     es.set("onMinute",        actuators.exhaustScheduler.onMinute);
     es.set("offHour",         actuators.exhaustScheduler.offHour);
     es.set("offMinute",       actuators.exhaustScheduler.offMinute);
+    es.set("cycleEnabled",          actuators.exhaustScheduler.cycleEnabled);
+    es.set("cycleOnMinutes",        actuators.exhaustScheduler.cycleOnMinutes);
+    es.set("cyclePeriodMinutes",    actuators.exhaustScheduler.cyclePeriodMinutes);
+    es.set("cycleOutsideOnMinutes", actuators.exhaustScheduler.cycleOutsideOnMinutes);
+    es.set("jitterMinutes",         actuators.exhaustScheduler.jitterMinutes);
+    es.set("windows",               actuators.exhaustScheduler.windows.text());
 
     if (Firebase.updateNode(fbdo, path.c_str(), es)) {
         Serial.println("[exhaust] No exhaust_schedule criado pelo ESP32");
@@ -1532,14 +1602,18 @@ void FirebaseHandler::receiveOperationMode(ActuatorController& actuators) {
             ls.set("offHour",         actuators.ledScheduler.offHour);
             ls.set("offMinute",       actuators.ledScheduler.offMinute);
             ls.set("intensity",       actuators.ledScheduler.configIntensity);
+            ls.set("windows",         actuators.ledScheduler.windows.text());
+            ls.set("astroEnabled",    actuators.ledScheduler.astroEnabled);
+            ls.set("latitude",        actuators.ledScheduler.latitude);
+            ls.set("longitude",       actuators.ledScheduler.longitude);
             Firebase.updateNode(fbdo, schedPath.c_str(), ls);
         }
     }
 }
 
-void FirebaseHandler::publishOperationMode(OperationMode mode) {
-    if (!authenticated || !Firebase.ready()) return;
-    if (mode == _lastPublishedMode) return;
+bool FirebaseHandler::publishOperationMode(OperationMode mode, bool force) {
+    if (!authenticated || !Firebase.ready()) return false;
+    if (mode == _lastPublishedMode && !force) return true;
 
     String base = "/greenhouses/" + greenhouseId + "/operation_mode";
     FirebaseJson opMode;
@@ -1550,8 +1624,307 @@ void FirebaseHandler::publishOperationMode(OperationMode mode) {
     if (Firebase.updateNode(fbdo, base.c_str(), opMode)) {
         _lastPublishedMode = mode;
         Serial.printf("[mode] Modo publicado: %s\n", operationModeLabel(mode).c_str());
+        return true;
+    }
+    Serial.println("[mode] Falha ao publicar modo: " + fbdo.errorReason());
+    return false;
+}
+
+// =============================================================================
+// TELEMETRIA DOS ATUADORES
+// =============================================================================
+
+bool FirebaseHandler::sendActuatorTelemetry(ActuatorController& actuators) {
+    if (!authenticated || !Firebase.ready()) return false;
+
+    const RelayGuard& guard = actuators.getRelayGuard();
+    unsigned long now = millis();
+
+    String base = "/greenhouses/" + greenhouseId + "/telemetria";
+    FirebaseJson json;
+    for (uint8_t r = 1; r <= RelayGuard::RELAYS; r++) {
+        String key = "reles/rele" + String(r) + "/";
+        json.set(key + "comutacoes",   (int)guard.lifetimeSwitches(r));
+        json.set(key + "ultimaHora",   (int)guard.switchesLastHour(r, now));
+        json.set(key + "adiadas",      (int)guard.blockedSwitches(r));
+    }
+
+    // Arbitragem umidificação x ventilação: tempo (s) e entradas por estado
+    const ClimateArbiter& arb = actuators.getClimateArbiter();
+    json.set("arbitragem/estado", ClimateArbiter::stateName(arb.state()));
+    for (uint8_t st = 0; st < ARB_STATES; st++) {
+        String key = String("arbitragem/") + ClimateArbiter::stateName((ArbiterState)st) + "/";
+        json.set(key + "segundos", (int)(arb.timeInState((ArbiterState)st, now) / 1000UL));
+        json.set(key + "entradas", (int)arb.entries((ArbiterState)st));
+    }
+
+    // Energia estimada por atuador: Wh e horas ligado por período
+    const EnergyMeter& energy = actuators.getEnergyMeter();
+    for (uint8_t p = 0; p < ENERGY_PERIODS; p++) {
+        const EnergyTotals& t = energy.totals((EnergyPeriod)p);
+        String period = String("energia/") + EnergyMeter::periodName((EnergyPeriod)p) + "/";
+        for (uint8_t c = 0; c < ENERGY_CHANNELS; c++) {
+            String key = period + EnergyMeter::channelName((EnergyChannel)c) + "/";
+            json.set(key + "wh",    (float)t.wh[c]);
+            json.set(key + "horas", (float)(t.onSec[c] / 3600.0));
+        }
+        json.set(period + "totalKWh", (float)(energy.totalWh((EnergyPeriod)p) / 1000.0));
+    }
+    // Setpoints: alvo configurado x efetivo usado pelas malhas (rampa)
+    const SetpointRamp& ramp = actuators.getSetpointRamp();
+    static const char* const RAMP_KEYS[RAMP_CHANNELS] = {"tMin", "tMax", "uMin", "uMax"};
+    for (uint8_t ch = 0; ch < RAMP_CHANNELS; ch++) {
+        String key = String("setpoints/") + RAMP_KEYS[ch] + "/";
+        json.set(key + "alvo",    ramp.target((RampChannel)ch));
+        json.set(key + "efetivo", ramp.effective((RampChannel)ch));
+    }
+    json.set("setpoints/rampaAtiva", ramp.ramping());
+    // Dimerização pela luz natural: ganho calibrado e luz natural estimada
+    const DaylightHarvester& harvest = actuators.getDaylightHarvester();
+    json.set("luz/ganhoLed",     harvest.ledGain());
+    json.set("luz/malhaFechada", harvest.closedLoop());
+    if (!isnan(harvest.daylight())) json.set("luz/natural", harvest.daylight());
+    // Supervisor de segurança: intervenções por motivo e relés bloqueados agora
+    const SafetySupervisor& safety = actuators.getSafetySupervisor();
+    for (uint8_t r = 0; r < SAFETY_REASONS; r++) {
+        json.set(String("seguranca/") + SafetySupervisor::reasonName((SafetyReason)r),
+                 (int)safety.interventions((SafetyReason)r));
+    }
+    json.set("seguranca/total",     (int)safety.totalInterventions());
+    json.set("seguranca/bloqueios", (int)safety.inhibitMask());
+
+    json.set("lastUpdate", (int)getCurrentTimestamp());
+
+    if (!Firebase.updateNode(fbdo, base.c_str(), json)) {
+        Serial.println("[firebase] Falha ao enviar telemetria: " + fbdo.errorReason());
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// AUTOTUNE
+// =============================================================================
+
+void FirebaseHandler::receiveAutotuneRequest(ActuatorController& actuators) {
+    if (!authenticated || !Firebase.ready()) return;
+
+    String path = "/greenhouses/" + greenhouseId + "/autotune/request";
+    if (!Firebase.getString(fbdo, path.c_str())) return;   // nó ausente = sem pedido
+
+    String req = fbdo.stringData();
+    if (req.length() == 0 || req == "none") return;
+
+    Serial.printf("[autotune] Pedido do app: %s\n", req.c_str());
+    if (req == "temperature") {
+        actuators.startAutotune(AUTOTUNE_LOOP_TEMPERATURE);
+    } else if (req == "humidity") {
+        actuators.startAutotune(AUTOTUNE_LOOP_HUMIDITY);
+    } else if (req == "abort") {
+        actuators.abortAutotune("abortado pelo app");
+    } else {
+        Serial.printf("[autotune] Pedido desconhecido ignorado: %s\n", req.c_str());
+    }
+
+    Firebase.setString(fbdo, path.c_str(), "none");
+    _lastAutotuneStatus = -1;   // força publicar o resultado do pedido
+}
+
+void FirebaseHandler::publishAutotuneStatus(ActuatorController& actuators) {
+    if (!authenticated || !Firebase.ready()) return;
+
+    const RelayAutotuner& at = actuators.getAutotuner();
+    int status = (int)at.state() * 256 + at.cyclesDone();
+    if (status == _lastAutotuneStatus) return;
+
+    static const char* const STATES[] = {"idle", "running", "done", "failed"};
+    AutotuneLoop loop = actuators.getAutotuneLoop();
+
+    String base = "/greenhouses/" + greenhouseId + "/autotune";
+    FirebaseJson json;
+    json.set("status",     STATES[at.state() & 3]);
+    json.set("loop",       loop == AUTOTUNE_LOOP_TEMPERATURE ? "temperature" :
+                           loop == AUTOTUNE_LOOP_HUMIDITY    ? "humidity"    : "none");
+    json.set("cycles",     (int)at.cyclesDone());
+    json.set("lastUpdate", (int)getCurrentTimestamp());
+    if (at.state() == AUTOTUNE_DONE) {
+        json.set("ku", at.ku());
+        json.set("pu", at.pu());
+        json.set("kp", at.kp());
+        json.set("ki", at.ki());
+        json.set("kd", at.kd());
+    }
+    json.set("reason", at.state() == AUTOTUNE_FAILED ? at.failReason() : "");
+
+    if (Firebase.updateNode(fbdo, base.c_str(), json)) {
+        _lastAutotuneStatus = status;
+    } else {
+        Serial.println("[autotune] Falha ao publicar estado: " + fbdo.errorReason());
+    }
+}
+
+// =============================================================================
+// CALIBRAÇÃO DO LDR
+// =============================================================================
+
+bool FirebaseHandler::fetchLightCalibrationCommand(String& command) {
+    if (!authenticated || !Firebase.ready()) return false;
+
+    String path = "/greenhouses/" + greenhouseId + "/calibracao_ldr/comando";
+    if (!Firebase.getString(fbdo, path.c_str())) return false;   // nó ausente = sem comando
+
+    command = fbdo.stringData();
+    command.trim();
+    if (command.length() == 0 || command == "none") return false;
+
+    Serial.printf("[sensor] Calibracao do LDR, comando do app: %s\n", command.c_str());
+    Firebase.setString(fbdo, path.c_str(), "none");
+    return true;
+}
+
+void FirebaseHandler::publishLightCalibrationStatus(const LightCalibration& cal, bool ok,
+                                                    const String& message, int adc) {
+    if (!authenticated || !Firebase.ready()) return;
+
+    // Pontos como "adc:lux;adc:lux" — mesmo formato curto das janelas de horário
+    String points;
+    for (uint8_t i = 0; i < cal.count(); i++) {
+        if (i) points += ";";
+        points += String(cal.point(i).adc) + ":" + String(cal.point(i).lux, 1);
+    }
+
+    String path = "/greenhouses/" + greenhouseId + "/calibracao_ldr/status";
+    FirebaseJson json;
+    json.set("ok",         ok);
+    json.set("mensagem",   message);
+    json.set("adc",        adc);
+    json.set("calibrada",  cal.calibrated());
+    json.set("pontos",     points);
+    json.set("lastUpdate", (int)getCurrentTimestamp());
+    if (!Firebase.updateNode(fbdo, path.c_str(), json)) {
+        Serial.println("[sensor] Falha ao publicar calibracao do LDR: " + fbdo.errorReason());
+    }
+}
+
+// =============================================================================
+// REGRAS DE AUTOMAÇÃO
+// =============================================================================
+
+bool FirebaseHandler::fetchVersionedSource(const String& base, const char* sourceKey,
+                                           int currentVersion, int& lastTried,
+                                           String& source, int& version) {
+    if (!authenticated || !Firebase.ready()) return false;
+
+    if (!Firebase.getInt(fbdo, (base + "/versao").c_str())) return false;   // nó ausente = nada a aplicar
+
+    version = fbdo.intData();
+    if (version == currentVersion || version == lastTried) return false;
+    lastTried = version;
+
+    if (!Firebase.getString(fbdo, (base + "/" + sourceKey).c_str())) {
+        // Versão sem texto: conteúdo vazio desativa o anterior
+        if (fbdo.dataType() != "null") {
+            Serial.println("[firebase] Falha ao ler " + base + "/" + sourceKey + ": " + fbdo.errorReason());
+            lastTried = -1;   // tenta de novo no próximo ciclo
+            return false;
+        }
+        source = "";
+    } else {
+        source = fbdo.stringData();
+    }
+    return true;
+}
+
+bool FirebaseHandler::fetchRules(int currentVersion, String& source, int& version) {
+    return fetchVersionedSource("/greenhouses/" + greenhouseId + "/regras", "fonte",
+                                currentVersion, _lastRulesVersionTried, source, version);
+}
+
+void FirebaseHandler::publishRulesStatus(int version, bool ok, const String& error, int ruleCount) {
+    if (!authenticated || !Firebase.ready()) return;
+
+    String path = "/greenhouses/" + greenhouseId + "/regras/status";
+    FirebaseJson json;
+    json.set("versao",     version);
+    json.set("ok",         ok);
+    json.set("erro",       error);
+    json.set("regras",     ruleCount);
+    json.set("lastUpdate", (int)getCurrentTimestamp());
+    if (!Firebase.updateNode(fbdo, path.c_str(), json)) {
+        Serial.println("[rules] Falha ao publicar status: " + fbdo.errorReason());
+    }
+}
+
+// =============================================================================
+// TABELA DE MODOS
+// =============================================================================
+
+bool FirebaseHandler::fetchModeTable(int currentVersion, String& source, int& version) {
+    return fetchVersionedSource("/greenhouses/" + greenhouseId + "/operation_mode/presets", "tabela",
+                                currentVersion, _lastModesVersionTried, source, version);
+}
+
+void FirebaseHandler::publishModeTableStatus(int version, bool ok, const String& error) {
+    if (!authenticated || !Firebase.ready()) return;
+
+    String path = "/greenhouses/" + greenhouseId + "/operation_mode/presets/status";
+    FirebaseJson json;
+    json.set("versao",     version);
+    json.set("ok",         ok);
+    json.set("erro",       error);
+    json.set("modos",      ModeTable::keyList());
+    json.set("lastUpdate", (int)getCurrentTimestamp());
+    if (!Firebase.updateNode(fbdo, path.c_str(), json)) {
+        Serial.println("[mode] Falha ao publicar status da tabela: " + fbdo.errorReason());
+    }
+}
+
+// =============================================================================
+// RECEITA DE CULTIVO
+// =============================================================================
+
+bool FirebaseHandler::fetchRecipe(int currentVersion, String& source, int& version) {
+    return fetchVersionedSource("/greenhouses/" + greenhouseId + "/receita", "fases",
+                                currentVersion, _lastRecipeVersionTried, source, version);
+}
+
+String FirebaseHandler::receiveRecipeCommand() {
+    if (!authenticated || !Firebase.ready()) return "";
+
+    String path = "/greenhouses/" + greenhouseId + "/receita/comando";
+    if (!Firebase.getString(fbdo, path.c_str())) return "";   // nó ausente = sem comando
+
+    String cmd = fbdo.stringData();
+    if (cmd.length() == 0 || cmd == "none") return "";
+
+    Firebase.setString(fbdo, path.c_str(), "none");
+    return cmd;
+}
+
+void FirebaseHandler::publishRecipeStatus(const GrowRecipe& recipe, bool force) {
+    if (!authenticated || !Firebase.ready()) return;
+
+    unsigned long now = getCurrentTimestamp();
+    long status = (recipe.isActive() ? 1L : 0L) + recipe.phase() * 2L +
+                  (long)(recipe.phaseDays(now) * 24.0f) * 64L;
+    if (!force && status == _lastRecipeStatus) return;
+
+    String path = "/greenhouses/" + greenhouseId + "/receita/status";
+    FirebaseJson json;
+    json.set("ativa",      recipe.isActive());
+    json.set("versao",     recipe.version());
+    json.set("fase",       recipe.phase() + 1);
+    json.set("fases",      (int)recipe.phaseCount());
+    json.set("modo",       recipe.phaseCount() ? operationModeToString(recipe.mode()) : String("manual"));
+    json.set("diasNaFase", recipe.isActive() ? recipe.phaseDays(now) : 0.0f);
+    json.set("diasTotais", recipe.isActive() ? recipe.totalDays(now) : 0.0f);
+    json.set("inicio",     (int)recipe.startedAt());
+    json.set("motivo",     recipe.lastReason());
+    json.set("lastUpdate", (int)now);
+    if (Firebase.updateNode(fbdo, path.c_str(), json)) {
+        _lastRecipeStatus = status;
     } else {
-        Serial.println("[mode] Falha ao publicar modo: " + fbdo.errorReason());
+        Serial.println("[recipe] Falha ao publicar status: " + fbdo.errorReason());
     }
 }
 
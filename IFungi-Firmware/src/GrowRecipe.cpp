@@ -0,0 +1,302 @@
+/**
+ * @file GrowRecipe.cpp
+ * @brief Decodificação, avanço de fases e persistência da receita de cultivo
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "GrowRecipe.h"
+#include <Preferences.h>
+#include <cstring>
+#include <cstdlib>
+
+/// Versão do layout do blob na NVS (2: fases guardam a chave do modo)
+static const uint16_t RECIPE_FORMAT = 2;
+/// Epoch mínimo considerado hora válida (2021-01-01)
+static const unsigned long RECIPE_MIN_EPOCH = 1609459200UL;
+
+// =============================================================================
+// PERSISTÊNCIA
+// =============================================================================
+
+void GrowRecipe::begin() {
+    Preferences preferences;
+    if (!preferences.begin("recipe", true)) return;
+
+    State saved;
+    size_t len = preferences.getBytes("st", &saved, sizeof(saved));
+    preferences.end();
+
+    if (len != sizeof(saved) || saved.format != RECIPE_FORMAT ||
+        saved.count > RECIPE_MAX_PHASES || (saved.active && saved.phase >= saved.count)) {
+        return;
+    }
+    _s = saved;
+    for (uint8_t i = 0; i < _s.count; i++) _resolvePhase(i);
+    if (_s.active && !_resolvePhase(_s.phase)) {
+        stop("modo da fase removido da tabela");
+        return;
+    }
+    if (_s.active) {
+        snprintf(_reason, sizeof(_reason), "retomada apos reinicio");
+        Serial.printf("[recipe] Receita v%d retomada na fase %u/%u (%s)\n",
+                      (int)_s.version, _s.phase + 1, _s.count,
+                      operationModeLabel(mode()).c_str());
+    }
+}
+
+// =============================================================================
+// MODOS DAS FASES
+// =============================================================================
+
+bool GrowRecipe::_resolvePhase(uint8_t phase) {
+    const char*   key  = _s.phases[phase].modeKey;
+    OperationMode mode = ModeTable::find(key);
+    _modes[phase] = (uint8_t)mode;
+    return mode != MODE_MANUAL || strcmp(key, "manual") == 0;
+}
+
+void GrowRecipe::resolveModes() {
+    for (uint8_t i = 0; i < _s.count; i++) {
+        if (!_resolvePhase(i)) {
+            Serial.printf("[recipe] Fase %u: modo %s ausente da tabela\n", i + 1, _s.phases[i].modeKey);
+        }
+    }
+    if (_s.active && !_resolvePhase(_s.phase)) {
+        stop("modo da fase removido da tabela");
+    }
+}
+
+void GrowRecipe::_save() {
+    Preferences preferences;
+    if (!preferences.begin("recipe", false)) {
+        Serial.println("[recipe] Failed opening NVS to save recipe");
+        return;
+    }
+    preferences.putBytes("st", &_s, sizeof(_s));
+    preferences.end();
+}
+
+// =============================================================================
+// DECODIFICAÇÃO
+// =============================================================================
+
+static bool parseRecipeDays(const char* text, float& days) {
+    char* end;
+    days = strtof(text, &end);
+    return end != text && *end == '\0' && days >= 0.0f && days * 24.0f <= 65535.0f;
+}
+
+bool GrowRecipe::_parseLine(char* line, RecipePhase& phase, String& error) {
+    char* field[3] = {};
+    uint8_t n = 0;
+    char* save = nullptr;
+    for (char* f = strtok_r(line, ",", &save); f; f = strtok_r(nullptr, ",", &save)) {
+        if (n == 3) { error = "campos demais"; return false; }
+        while (*f == ' ' || *f == '\t') f++;
+        char* end = f + strlen(f);
+        while (end > f && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) *--end = '\0';
+        field[n++] = f;
+    }
+    if (n < 2) { error = "esperado modo,dias[,condicao]"; return false; }
+
+    OperationMode mode = ModeTable::find(field[0]);
+    if (mode == MODE_MANUAL && strcmp(field[0], "manual") != 0) {
+        error = "modo desconhecido: " + String(field[0]);
+        return false;
+    }
+
+    float minDays, maxDays;
+    char* dash = strchr(field[1], '-');
+    if (dash) {
+        *dash = '\0';
+        if (!parseRecipeDays(field[1], minDays) || !parseRecipeDays(dash + 1, maxDays) ||
+            maxDays < minDays) {
+            error = "faixa de dias invalida";
+            return false;
+        }
+    } else {
+        if (!parseRecipeDays(field[1], minDays)) { error = "dias invalidos"; return false; }
+        maxDays = minDays;
+    }
+
+    phase = RecipePhase();
+    strncpy(phase.modeKey, field[0], sizeof(phase.modeKey) - 1);
+    phase.trigger  = RECIPE_TRIGGER_TIME;
+    phase.minHours = (uint16_t)(minDays * 24.0f + 0.5f);
+    phase.maxHours = (uint16_t)(maxDays * 24.0f + 0.5f);
+
+    if (n == 3) {
+        if (strncmp(field[2], "co2plato:", 9) != 0) {
+            error = "condicao desconhecida: " + String(field[2]);
+            return false;
+        }
+        char* end;
+        long ppm = strtol(field[2] + 9, &end, 10);
+        if (end == field[2] + 9 || *end || ppm <= 0 || ppm > 5000) {
+            error = "faixa de CO2 invalida";
+            return false;
+        }
+        phase.trigger    = RECIPE_TRIGGER_CO2_PLATEAU;
+        phase.plateauPpm = (uint16_t)ppm;
+    } else if (dash) {
+        error = "faixa de dias exige condicao";
+        return false;
+    }
+    return true;
+}
+
+bool GrowRecipe::load(const String& source, int version, String& error) {
+    RecipePhase phases[RECIPE_MAX_PHASES];
+    uint8_t count = 0;
+
+    char line[96];
+    uint8_t lineNo = 0;
+    unsigned int i = 0, n = source.length();
+    while (i < n) {
+        uint8_t k = 0;
+        bool truncated = false;
+        while (i < n && source[i] != '\n' && source[i] != ';') {
+            if (k < sizeof(line) - 1) line[k++] = source[i];
+            else truncated = true;
+            i++;
+        }
+        i++;
+        line[k] = '\0';
+        lineNo++;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        const char* t = line;
+        while (*t == ' ' || *t == '\t' || *t == '\r') t++;
+        if (*t == '\0') continue;
+
+        String e;
+        if (truncated)                     e = "linha longa demais";
+        else if (count >= RECIPE_MAX_PHASES) e = "fases demais";
+        if (e.length() || !_parseLine(line, phases[count], e)) {
+            error = "linha " + String(lineNo) + ": " + e;
+            Serial.printf("[recipe] Receita v%d rejeitada: %s\n", version, error.c_str());
+            return false;
+        }
+        count++;
+    }
+
+    bool keep = _s.active && _s.phase < count;
+    if (_s.active && !keep) {
+        stop("receita substituida sem a fase atual");
+    }
+    _s.format  = RECIPE_FORMAT;
+    _s.version = version;
+    _s.count   = count;
+    memcpy(_s.phases, phases, sizeof(RecipePhase) * count);
+    for (uint8_t p = 0; p < count; p++) _resolvePhase(p);   // chaves já validadas
+    _save();
+
+    error = "";
+    Serial.printf("[recipe] Receita v%d carregada: %u fase(s)%s\n",
+                  version, count, keep ? " — progresso mantido" : "");
+    return true;
+}
+
+// =============================================================================
+// EXECUÇÃO
+// =============================================================================
+
+bool GrowRecipe::start(unsigned long epoch) {
+    if (_s.count == 0 || epoch < RECIPE_MIN_EPOCH) {
+        Serial.println("[recipe] Inicio recusado: receita vazia ou relogio invalido");
+        return false;
+    }
+    _s.active      = true;
+    _s.recipeStart = epoch;
+    _enterPhase(0, epoch, "iniciada");
+    return true;
+}
+
+void GrowRecipe::stop(const char* reason) {
+    if (!_s.active) return;
+    _s.active = false;
+    snprintf(_reason, sizeof(_reason), "%s", reason);
+    Serial.printf("[recipe] Receita interrompida na fase %u: %s\n", _s.phase + 1, reason);
+    _save();
+}
+
+bool GrowRecipe::skip(unsigned long epoch) {
+    if (!_s.active || epoch < RECIPE_MIN_EPOCH) return false;
+    _enterPhase(_s.phase + 1, epoch, "avancada pelo operador");
+    return true;
+}
+
+void GrowRecipe::_enterPhase(uint8_t phase, unsigned long epoch, const char* reason) {
+    _co2Count = 0;
+    _co2Head  = 0;
+
+    if (phase >= _s.count) {
+        _s.active = false;
+        snprintf(_reason, sizeof(_reason), "concluida (%s)", reason);
+        Serial.printf("[recipe] Receita concluida apos %.1f dias\n", totalDays(epoch));
+    } else if (!_resolvePhase(phase)) {
+        _s.active = false;
+        snprintf(_reason, sizeof(_reason), "modo %s ausente da tabela", _s.phases[phase].modeKey);
+        Serial.printf("[recipe] Receita interrompida antes da fase %u: %s\n", phase + 1, _reason);
+    } else {
+        _s.phase      = phase;
+        _s.phaseStart = epoch;
+        snprintf(_reason, sizeof(_reason), "%s", reason);
+        Serial.printf("[recipe] Fase %u/%u: %s (%s)\n", phase + 1, _s.count,
+                      operationModeLabel(mode()).c_str(), reason);
+    }
+    _save();
+}
+
+bool GrowRecipe::_co2Plateau(uint16_t ppm) const {
+    if (_co2Count < RECIPE_CO2_WINDOW) return false;
+    int lo = _co2[0], hi = _co2[0];
+    for (uint8_t i = 1; i < RECIPE_CO2_WINDOW; i++) {
+        if (_co2[i] < lo) lo = _co2[i];
+        if (_co2[i] > hi) hi = _co2[i];
+    }
+    return hi - lo <= (int)ppm;
+}
+
+bool GrowRecipe::update(unsigned long epoch, int co2, bool ccsReady, unsigned long nowMs) {
+    if (!_s.active || epoch < RECIPE_MIN_EPOCH) return false;
+
+    const RecipePhase& p = _s.phases[_s.phase];
+
+    if (p.trigger == RECIPE_TRIGGER_CO2_PLATEAU) {
+        if (!ccsReady) {
+            _co2Count = 0;   // janela precisa ser contínua
+        } else if (_co2Count == 0 || nowMs - _lastSample >= RECIPE_CO2_SAMPLE_MS) {
+            _lastSample      = nowMs;
+            _co2[_co2Head]   = co2;
+            _co2Head         = (_co2Head + 1) % RECIPE_CO2_WINDOW;
+            if (_co2Count < RECIPE_CO2_WINDOW) _co2Count++;
+        }
+    }
+
+    unsigned long elapsed = epoch > _s.phaseStart ? epoch - _s.phaseStart : 0;
+    char reason[64];
+    if (elapsed >= (unsigned long)p.maxHours * 3600UL) {
+        snprintf(reason, sizeof(reason), "%.1f dias decorridos", p.maxHours / 24.0f);
+    } else if (p.trigger == RECIPE_TRIGGER_CO2_PLATEAU &&
+               elapsed >= (unsigned long)p.minHours * 3600UL && _co2Plateau(p.plateauPpm)) {
+        snprintf(reason, sizeof(reason), "CO2 estabilizou (faixa <= %u ppm)", p.plateauPpm);
+    } else {
+        return false;
+    }
+
+    _enterPhase(_s.phase + 1, epoch, reason);
+    return true;
+}
+
+float GrowRecipe::phaseDays(unsigned long epoch) const {
+    if (epoch < RECIPE_MIN_EPOCH || epoch < _s.phaseStart) return 0.0f;
+    return (epoch - _s.phaseStart) / 86400.0f;
+}
+
+float GrowRecipe::totalDays(unsigned long epoch) const {
+    if (epoch < RECIPE_MIN_EPOCH || epoch < _s.recipeStart) return 0.0f;
+    return (epoch - _s.recipeStart) / 86400.0f;
+}
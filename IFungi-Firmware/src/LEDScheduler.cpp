@@ -1,7 +1,7 @@
 /**
  * @file LEDScheduler.cpp
  * @brief Implementação do agendador e simulador solar de LEDs
- * @version 1.3.0
+ * @version 1.5.0
  * @date 2026
  */
 
@@ -17,11 +17,13 @@ void LEDScheduler::secondsToHM(unsigned long secondsOfDay, int& hour, int& minut
 
 // ─── Modo simulação solar ─────────────────────────────────────────────────────
 
-int LEDScheduler::_solarIntensity(int nowMinutes, int startMinutes, int endMinutes) {
-    if (endMinutes <= startMinutes) return 0; // Janela inválida
+int LEDScheduler::_solarIntensity(unsigned long now, unsigned long start, unsigned long end) {
+    // Bloco sem início/fim conhecidos (luz contínua) — sem arco
+    if (start == 0 || end == TimeWindowSchedule::TW_NEVER) return 255;
+    if (end <= start) return 0;
 
-    // Posição normalizada dentro da janela (0.0 = início, 1.0 = fim)
-    float t = (float)(nowMinutes - startMinutes) / (float)(endMinutes - startMinutes);
+    // Posição normalizada dentro do bloco (0.0 = início, 1.0 = fim)
+    float t = (float)(now - start) / (float)(end - start);
 
     if (t <= 0.0f || t >= 1.0f) return 0;
 
@@ -36,16 +38,90 @@ int LEDScheduler::_solarIntensity(int nowMinutes, int startMinutes, int endMinut
     return constrain((int)intensity, 0, 255);
 }
 
+// ─── Modo astronômico ────────────────────────────────────────────────────────
+
+static const float ASTRO_DEG = 0.01745329252f;
+
+/// Dia do ano (0-365) do dia local contado desde 01/01/1970
+static int astroDayOfYear(long day, int& yearDays) {
+    for (int y = 1970; ; y++) {
+        bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+        yearDays = leap ? 366 : 365;
+        if (day < yearDays) return (int)day;
+        day -= yearDays;
+    }
+}
+
+void LEDScheduler::_buildAstroTable(long day) {
+    _astroDay = day;
+    _astroLat = latitude;
+    _astroLon = longitude;
+
+    // Equação do tempo (min) e declinação (rad) ao meio-dia — NOAA
+    int   yearDays;
+    int   doy    = astroDayOfYear(day, yearDays);
+    float g      = 2.0f * 3.14159265f / yearDays * doy;
+    float eqTime = 229.18f * (0.000075f + 0.001868f * cosf(g) - 0.032077f * sinf(g)
+                              - 0.014615f * cosf(2 * g) - 0.040849f * sinf(2 * g));
+    float decl   = 0.006918f - 0.399912f * cosf(g) + 0.070257f * sinf(g)
+                 - 0.006758f * cosf(2 * g) + 0.000907f * sinf(2 * g)
+                 - 0.002697f * cosf(3 * g) + 0.00148f  * sinf(3 * g);
+
+    float lat   = latitude * ASTRO_DEG;
+    float sinSd = sinf(lat) * sinf(decl);
+    float cosCd = cosf(lat) * cosf(decl);
+    float noon  = 720.0f - 4.0f * longitude - eqTime + ASTRO_UTC_OFFSET_MIN;
+
+    // Nascer/pôr: zênite 90,833° (refração + raio do disco solar)
+    float cosH = (cosf(90.833f * ASTRO_DEG) - sinSd) / cosCd;
+    if (cosH >= 1.0f) {
+        _sunrise = _sunset = 0;                 // noite polar
+    } else if (cosH <= -1.0f) {
+        _sunrise = 0;                           // sol da meia-noite
+        _sunset  = 24 * 60;
+    } else {
+        float h  = acosf(cosH) / ASTRO_DEG * 4.0f;   // graus → minutos
+        _sunrise = constrain((int)(noon - h + 0.5f), 0, 24 * 60);
+        _sunset  = constrain((int)(noon + h + 0.5f), 0, 24 * 60);
+    }
+
+    // sen(elevação) normalizado pelo meio-dia do dia, com piso de 10%
+    float peak = sinSd + cosCd;
+    for (int i = 0; i <= ASTRO_SLOTS; i++) {
+        float ha    = (i * ASTRO_STEP_MIN - noon) / 4.0f * ASTRO_DEG;
+        float sinEl = sinSd + cosCd * cosf(ha);
+        float s     = peak > 0.0f ? constrain(sinEl / peak, 0.0f, 1.0f) : 0.0f;
+        _astroTable[i] = (uint8_t)((0.10f + 0.90f * s) * 255.0f);
+    }
+}
+
+int LEDScheduler::_astroIntensity(unsigned long secondsOfDay) const {
+    unsigned long sunrise = (unsigned long)_sunrise * 60UL;
+    unsigned long sunset  = (unsigned long)_sunset  * 60UL;
+    if (secondsOfDay < sunrise || secondsOfDay >= sunset) return 0;
+
+    const unsigned long step = ASTRO_STEP_MIN * 60UL;
+    unsigned long i    = secondsOfDay / step;
+    unsigned long frac = secondsOfDay % step;
+    return _astroTable[i] + ((int)_astroTable[i + 1] - (int)_astroTable[i]) * (long)frac / (long)step;
+}
+
 // ─── Loop principal ───────────────────────────────────────────────────────────
 
 void LEDScheduler::update(unsigned long currentTimestamp, bool debugMode) {
     // Scheduler fica completamente inativo no modo debug
     if (debugMode) {
-        _ledsOn    = false;
-        _intensity = 0;
+        _ledsOn      = false;
+        _intensity   = 0;
+        _lightPeriod = false;
         return;
     }
 
+    // Janela de luz configurada, mesmo sem modo ativo: limita a calibração do
+    // DaylightHarvester ao período claro. Campos antigos viram a janela padrão.
+    windows.setDefaultWindow(onHour * 60 + onMinute, offHour * 60 + offMinute);
+    _lightPeriod = windows.count() > 0 && windows.isOn(currentTimestamp);
+
     // Nenhum modo ativo — não interfere
     if (!scheduleEnabled && !solarSimEnabled) {
         _ledsOn    = false;
@@ -59,25 +135,44 @@ void LEDScheduler::update(unsigned long currentTimestamp, bool debugMode) {
     int nowHour, nowMinute;
     secondsToHM(secondsOfDay, nowHour, nowMinute);
 
-    int nowMinutes   = nowHour   * 60 + nowMinute;
-    int startMinutes = onHour    * 60 + onMinute;
-    int endMinutes   = offHour   * 60 + offMinute;
+    int nowMinutes = nowHour * 60 + nowMinute;
+
+    // ─── Modo astronômico — tabela refeita uma vez por dia ──────────────────
+    if (solarSimEnabled && astroEnabled) {
+        long day = (long)(currentTimestamp / 86400UL);
+        if (day != _astroDay || latitude != _astroLat || longitude != _astroLon) {
+            _buildAstroTable(day);
+            Serial.printf("[led] Astro: lat %.2f lon %.2f | nascer %02d:%02d | por %02d:%02d\n",
+                          latitude, longitude,
+                          _sunrise / 60, _sunrise % 60, _sunset / 60, _sunset % 60);
+        }
+        _intensity = _astroIntensity(secondsOfDay);
+        _ledsOn    = _intensity > 0;
+
+        static int lastReportedMinAstro = -1;
+        if (nowMinutes != lastReportedMinAstro) {
+            Serial.printf("[led] Astro: %02d:%02d | Intensidade: %d/255 (%d%%)\n",
+                          nowHour, nowMinute, _intensity, (_intensity * 100) / 255);
+            lastReportedMinAstro = nowMinutes;
+        }
+        return;
+    }
 
-    // Valida janela
-    if (endMinutes <= startMinutes) {
-        Serial.println("[led] WARN: Horario de fim <= horario de inicio, scheduler ignorado.");
+    // Campos antigos viram a janela padrão (sem efeito com "windows" definido)
+    windows.setDefaultWindow(onHour * 60 + onMinute, offHour * 60 + offMinute);
+    if (windows.count() == 0) {
         _ledsOn    = false;
         _intensity = 0;
         return;
     }
 
-    bool withinWindow = (nowMinutes >= startMinutes && nowMinutes < endMinutes);
+    bool withinWindow = windows.isOn(currentTimestamp);
 
     // ─── Modo simulação solar ───────────────────────────────────────────────
     if (solarSimEnabled) {
         if (withinWindow) {
             _ledsOn    = true;
-            _intensity = _solarIntensity(nowMinutes, startMinutes, endMinutes);
+            _intensity = _solarIntensity(currentTimestamp, windows.blockStart(), windows.nextChange());
         } else {
             _ledsOn    = false;
             _intensity = 0;
@@ -85,10 +180,9 @@ void LEDScheduler::update(unsigned long currentTimestamp, bool debugMode) {
 
         static int lastReportedMin = -1;
         if (nowMinutes != lastReportedMin) {
-            Serial.printf("[led] Solar: %02d:%02d | Janela: %02d:%02d-%02d:%02d | "
+            Serial.printf("[led] Solar: %02d:%02d | Janelas: %s | "
                           "Intensidade: %d/255 (%d%%)\n",
-                          nowHour, nowMinute,
-                          onHour, onMinute, offHour, offMinute,
+                          nowHour, nowMinute, windows.label().c_str(),
                           _intensity, (_intensity * 100) / 255);
             lastReportedMin = nowMinutes;
         }
@@ -107,10 +201,9 @@ void LEDScheduler::update(unsigned long currentTimestamp, bool debugMode) {
 
         static int lastReportedMinTimer = -1;
         if (nowMinutes != lastReportedMinTimer) {
-            Serial.printf("[led] Timer: %02d:%02d | Janela: %02d:%02d-%02d:%02d | "
+            Serial.printf("[led] Timer: %02d:%02d | Janelas: %s | "
                           "%s (int: %d)\n",
-                          nowHour, nowMinute,
-                          onHour, onMinute, offHour, offMinute,
+                          nowHour, nowMinute, windows.label().c_str(),
                           _ledsOn ? "LIGADO" : "DESLIGADO",
                           _intensity);
             lastReportedMinTimer = nowMinutes;
@@ -0,0 +1,154 @@
+/**
+ * @file LightCalibration.cpp
+ * @brief Pontos de referência do LDR, curva log-linear e persistência
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "LightCalibration.h"
+#include <Preferences.h>
+#include <cmath>
+#include <cstring>
+
+/// Versão do layout do blob na NVS
+static const uint8_t LCAL_FORMAT = 1;
+
+struct LightCalBlob {
+    uint8_t       format;
+    uint8_t       count;
+    LightCalPoint points[LightCalibration::LCAL_MAX_POINTS];
+};
+
+// =============================================================================
+// PERSISTÊNCIA
+// =============================================================================
+
+void LightCalibration::begin() {
+    Preferences preferences;
+    if (!preferences.begin("ldrcal", true)) return;
+
+    LightCalBlob blob;
+    size_t len = preferences.getBytes("pts", &blob, sizeof(blob));
+    preferences.end();
+
+    String error;
+    if (len != sizeof(blob) || blob.format != LCAL_FORMAT || blob.count > LCAL_MAX_POINTS ||
+        !_validate(blob.points, blob.count, error)) {
+        return;
+    }
+    memcpy(_points, blob.points, sizeof(_points));
+    _count = blob.count;
+    _build();
+    if (calibrated()) {
+        Serial.printf("[sensor] Calibracao do LDR restaurada: %u ponto(s), %d-%d lux\n",
+                      _count, toLux(0), toLux(LCAL_ADC_MAX));
+    }
+}
+
+void LightCalibration::_save() {
+    Preferences preferences;
+    if (!preferences.begin("ldrcal", false)) {
+        Serial.println("[sensor] Failed opening NVS to save LDR calibration");
+        return;
+    }
+    LightCalBlob blob = {};
+    blob.format = LCAL_FORMAT;
+    blob.count  = _count;
+    memcpy(blob.points, _points, sizeof(_points));
+    preferences.putBytes("pts", &blob, sizeof(blob));
+    preferences.end();
+}
+
+// =============================================================================
+// PONTOS
+// =============================================================================
+
+bool LightCalibration::_validate(const LightCalPoint* pts, uint8_t n, String& error) {
+    int direction = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        if (pts[i].adc > LCAL_ADC_MAX || !(pts[i].lux >= 0.0f) || pts[i].lux > 65535.0f) {
+            error = "ponto fora da faixa";
+            return false;
+        }
+        if (i == 0) continue;
+        if (pts[i].adc <= pts[i - 1].adc) {
+            error = "ADC repetido";
+            return false;
+        }
+        int d = pts[i].lux > pts[i - 1].lux ? 1 : (pts[i].lux < pts[i - 1].lux ? -1 : 0);
+        if (d == 0 || (direction != 0 && d != direction)) {
+            error = "lux nao monotonico no ADC (leitura instavel?)";
+            return false;
+        }
+        direction = d;
+    }
+    return true;
+}
+
+bool LightCalibration::addPoint(int adc, float lux, String& error) {
+    if (adc < 0 || adc > LCAL_ADC_MAX || !(lux >= 0.0f) || lux > 65535.0f) {
+        error = "ponto fora da faixa";
+        return false;
+    }
+
+    LightCalPoint pts[LCAL_MAX_POINTS];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (abs((int)_points[i].adc - adc) < LCAL_MERGE_ADC) continue;   // substituído
+        pts[n++] = _points[i];
+    }
+    if (n >= LCAL_MAX_POINTS) {
+        error = "pontos demais (limpar e recomecar)";
+        return false;
+    }
+
+    // Inserção ordenada por ADC
+    uint8_t j = n;
+    while (j > 0 && pts[j - 1].adc > adc) { pts[j] = pts[j - 1]; j--; }
+    pts[j].adc = (uint16_t)adc;
+    pts[j].lux = lux;
+    n++;
+
+    if (!_validate(pts, n, error)) return false;
+
+    memcpy(_points, pts, sizeof(LightCalPoint) * n);
+    _count = n;
+    _build();
+    _save();
+    error = "";
+    Serial.printf("[sensor] LDR: ponto ADC %d = %.1f lux (%u ponto(s))\n", adc, lux, _count);
+    return true;
+}
+
+void LightCalibration::clear() {
+    _count = 0;
+    _save();
+    Serial.println("[sensor] Calibracao do LDR apagada — leitura crua do ADC");
+}
+
+// =============================================================================
+// CURVA
+// =============================================================================
+
+void LightCalibration::_build() {
+    if (_count < 2) return;
+
+    float logLux[LCAL_MAX_POINTS];
+    for (uint8_t i = 0; i < _count; i++) {
+        logLux[i] = logf(_points[i].lux > LCAL_MIN_LUX ? _points[i].lux : LCAL_MIN_LUX);
+    }
+
+    uint8_t seg = 0;
+    for (uint16_t k = 0; k < LCAL_LUT_SIZE; k++) {
+        float adc = (float)(k << LCAL_LUT_SHIFT);
+        // Segmento que contém o ADC; nas pontas prolonga o primeiro/último
+        while (seg + 2 < _count && adc >= _points[seg + 1].adc) seg++;
+
+        float a0 = _points[seg].adc, a1 = _points[seg + 1].adc;
+        float t  = (adc - a0) / (a1 - a0);
+        float lux = expf(logLux[seg] + t * (logLux[seg + 1] - logLux[seg]));
+        if (lux < LCAL_MIN_LUX) lux = 0.0f;
+        if (lux > 65535.0f)     lux = 65535.0f;
+        _lut[k] = (uint16_t)(lux + 0.5f);
+    }
+}
@@ -1,7 +1,7 @@
 /**
  * @file MainController.cpp
  * @brief Controlador principal do sistema IFungi Greenhouse
- * @version 1.3.0
+ * @version 1.6.0
  * @date 2026
  *
  * CORREÇÕES (v1.2.2):
@@ -26,6 +26,25 @@
  *  - CORREÇÃO: controlAutomatically() passa sensors.isDHTHealthy() para bloquear
  *    Peltier quando o DHT22 está inoperante.
  *  - CORREÇÃO: RemoteLogger::flush() chamado no loop principal.
+ *
+ * NOVIDADES (v1.4.0):
+ *  - Controle dos atuadores disparado por notificação de snapshot novo do
+ *    SensorController (teto de 1 s), com fallback periódico de 5 s.
+ *  - TimingProbe em handleActuators, lifeSupportTask e ledPwmTask: atraso de
+ *    ativação, duração e prazos perdidos em histogramas; resumo no relatório
+ *    de saúde e pior estágio em RTC ao lado do rtcLastStage.
+ *
+ * NOVIDADES (v1.5.0):
+ *  - Receita de cultivo (GrowRecipe) em handleGrowRecipe(): fases por dias
+ *    e/ou platô de CO2 aplicam o modo de operação e publicam /receita/status.
+ *    Troca de modo pelo app interrompe a receita.
+ *
+ * NOVIDADES (v1.6.0):
+ *  - Calibração do LDR no modo debug/calibração: /calibracao_ldr/comando
+ *    ("ponto:<lux>" / "limpar") aplicado sob sensorMutex; resultado e curva
+ *    em /calibracao_ldr/status; ganho LED→LDR recalibrado a cada mudança.
+ *  - SafetySupervisor iniciado junto dos atuadores; intervenções novas vão
+ *    para o RemoteLogger em handleActuators().
  */
 
 #include <Arduino.h>
@@ -37,6 +56,8 @@
 #include "LEDScheduler.h"
 #include "OperationMode.h"
 #include "RemoteLogger.h"
+#include "TimingProbe.h"
+#include "GrowRecipe.h"
 #include <WiFiManager.h>
 #include <Preferences.h>
 #include <cstdint>
@@ -44,6 +65,7 @@
 #include <cstring>
 #include <esp_attr.h>
 #include <esp_system.h>
+#include <esp_timer.h>
 
 #ifndef IFUNGI_WIFI_AP_NAME
     #error "IFUNGI_WIFI_AP_NAME nao definida. Verifique seu arquivo .env"
@@ -67,6 +89,12 @@ SensorController   sensors;
 ActuatorController actuators;
 QRCodeGenerator    qrGenerator;
 OTAHandler         otaHandler;
+GrowRecipe         recipe;
+
+// Modo aplicado pela receita ainda não escrito no Firebase: publicado antes da
+// próxima leitura de /operation_mode (senão o modo antigo do nó pareceria
+// troca feita pelo app e interromperia a receita)
+bool recipeModePending = false;
 
 const String FIRMWARE_VERSION = "1.3.0";
 
@@ -95,21 +123,27 @@ unsigned long lastHistoryUpdate      = 0;
 unsigned long lastLocalSave          = 0;
 unsigned long lastRepairCheck        = 0;
 unsigned long lastOperationModeCheck = 0;
+unsigned long lastRecipeCheck        = 0;
 unsigned long lastSensorHealthUpdate = 0;
 unsigned long lastSetpointSync       = 0;
 unsigned long lastLEDScheduleSync    = 0;
 unsigned long lastExhaustScheduleSync = 0;
+unsigned long lastTelemetryUpdate    = 0;
 
 const unsigned long REPAIR_CHECK_INTERVAL        = 300000;
 const unsigned long OPERATION_MODE_CHECK_INTERVAL = 5000;
+const unsigned long MODE_TABLE_CHECK_INTERVAL     = 30000;
+const unsigned long RECIPE_CHECK_INTERVAL         = 60000;
 const unsigned long SENSOR_READ_INTERVAL          = 2000;
-const unsigned long ACTUATOR_CONTROL_INTERVAL     = 5000;
+const unsigned long ACTUATOR_CONTROL_INTERVAL     = 5000;   ///< Fallback sem snapshot novo (janelas/agendas)
+const unsigned long ACTUATOR_MIN_INTERVAL         = 1000;   ///< Teto de taxa do controle disparado por snapshot
 const unsigned long FIREBASE_UPDATE_INTERVAL      = 5000;
 const unsigned long SENSOR_HEALTH_INTERVAL        = 30000;
 const unsigned long SETPOINT_SYNC_INTERVAL        = 30000;
 const unsigned long LED_SCHEDULE_SYNC_INTERVAL    = 30000;
 const unsigned long EXHAUST_SCHEDULE_SYNC_INTERVAL = 30000;
 const unsigned long HEARTBEAT_INTERVAL            = 30000;
+const unsigned long TELEMETRY_INTERVAL            = 60000;
 const unsigned long HISTORY_UPDATE_INTERVAL       = 300000;
 const unsigned long LOCAL_SAVE_INTERVAL           = 60000;
 
@@ -128,6 +162,8 @@ volatile bool lifeSupportTaskRunning = false;
 bool lastDebugMode   = false;
 unsigned long lastDebugCheck = 0;
 const unsigned long DEBUG_CHECK_INTERVAL = 2000;
+const unsigned long AUTOTUNE_CHECK_INTERVAL = 10000;
+const unsigned long RULES_CHECK_INTERVAL    = 30000;
 
 // =============================================================================
 // DIAGNOSTICO DE TRAVAMENTOS
@@ -136,6 +172,11 @@ const unsigned long DEBUG_CHECK_INTERVAL = 2000;
 RTC_DATA_ATTR char rtcLastStage[32] = "cold_boot";
 RTC_DATA_ATTR uint32_t rtcBootCount = 0;
 
+// Regularidade do controle: atraso entre o instante devido e a execução,
+// duração e prazos perdidos (resposta > 1 s). Pior estágio fica em RTC.
+TimingProbe loopActuatorProbe("handleActuators", 1000000UL);
+TimingProbe lifeSupportProbe("lifeSupportTask", 1000000UL);
+
 unsigned long lastHealthReport = 0;
 unsigned long maxLoopDuration = 0;
 uint32_t minFreeHeap = UINT32_MAX;
@@ -216,6 +257,16 @@ void reportRuntimeHealth(const char* reason) {
                 lifeStack,
                 maxLoopDuration,
                 rtcLastStage);
+
+    char line[160];
+    const TimingProbe* probes[] = {&loopActuatorProbe, &lifeSupportProbe, &actuators.getLedProbe()};
+    for (const TimingProbe* probe : probes) {
+        if (probe->count() == 0) continue;
+        probe->summary(line, sizeof(line));
+        diagLogInfo("timing %s", line);
+    }
+    diagLogInfo("timing pior estagio: %s (%lums)",
+                TimingProbe::worstStage(), (unsigned long)(TimingProbe::worstStageUs() / 1000UL));
 }
 
 void runTimedHandler(const char* name, void (*handler)()) {
@@ -226,11 +277,64 @@ void runTimedHandler(const char* name, void (*handler)()) {
     handler();
     unsigned long elapsed = millis() - start;
 
+    TimingProbe::noteStage(name, elapsed * 1000UL);
     if (elapsed > SLOW_HANDLER_WARN_MS) {
         diagLogWarn("Handler lento: %s levou %lums", name, elapsed);
     }
 }
 
+// =============================================================================
+// CONTROLE DISPARADO POR SNAPSHOT
+//
+// SensorController notifica (xTaskNotifyGive) a loopTask e a lifeSupportTask
+// quando publica um snapshot com algum valor alterado. O controle roda assim
+// que chega um snapshot novo — latência = período de amostragem — limitado a
+// uma execução por ACTUATOR_MIN_INTERVAL. Sem snapshot novo, roda no máximo a
+// cada ACTUATOR_CONTROL_INTERVAL para avançar janelas de tempo (proporção de
+// tempo do Peltier, cooldown, agendas).
+// =============================================================================
+
+// Deve ser chamada pela própria task registrada como listener.
+// Quando devido, informa à sonda o instante em que o controle passou a ser
+// devido: publicação do snapshot (ou fim do teto de taxa) ou fallback vencido.
+static bool actuatorControlDue(bool& pendingSnapshot, unsigned long now, unsigned long lastRun,
+                               TimingProbe& probe) {
+    if (ulTaskNotifyTake(pdTRUE, 0) > 0) pendingSnapshot = true;
+    unsigned long since = now - lastRun;
+    unsigned long dueAt;
+    if (pendingSnapshot) {
+        if (since < ACTUATOR_MIN_INTERVAL) return false;
+        dueAt = lastRun + ACTUATOR_MIN_INTERVAL;
+        unsigned long snap = sensors.snapshotMillis();
+        if ((long)(snap - dueAt) > 0 && (long)(now - snap) >= 0) dueAt = snap;
+    } else {
+        if (since < ACTUATOR_CONTROL_INTERVAL) return false;
+        dueAt = lastRun + ACTUATOR_CONTROL_INTERVAL;
+    }
+    if (lastRun == 0) dueAt = now;   // primeira execução: sem referência
+    // millis() e esp_timer_get_time() compartilham a mesma base de tempo
+    probe.release(esp_timer_get_time() - (int64_t)(now - dueAt) * 1000LL);
+    return true;
+}
+
+// Chamador deve segurar actuatorMutex
+static void runActuatorControl(bool allowFirebaseWrite) {
+    actuators.applyLEDSchedule(firebase.getCurrentTimestamp());
+    actuators.applyExhaustSchedule(firebase.getCurrentTimestamp());
+    actuators.controlAutomatically(
+        sensors.getTemperature(),
+        sensors.getHumidity(),
+        sensors.getLight(),
+        sensors.getCO(),
+        sensors.getCO2(),
+        sensors.getTVOCs(),
+        sensors.getWaterLevel(),
+        sensors.isDHTHealthy(),     // ← CORREÇÃO: bloqueia Peltier se DHT falhou
+        allowFirebaseWrite,
+        sensors.isCCS811Ready()     // CO2/TVOCs só contam após condicionamento
+    );
+}
+
 // =============================================================================
 // TAREFA DE SUPORTE DE VIDA (DURANTE PORTAL CAPTIVO / OFFLINE)
 //
@@ -246,8 +350,15 @@ void runTimedHandler(const char* name, void (*handler)()) {
 // =============================================================================
 
 void lifeSupportTask(void* parameter) {
-    unsigned long lastSensorTs = 0;
-    unsigned long lastActTs    = 0;
+    unsigned long lastSensorTs    = 0;
+    unsigned long lastActTs       = 0;
+    bool          pendingSnapshot = false;
+
+    // Recebe os snapshots do SensorController (mutex serializa com update())
+    if (xSemaphoreTake(sensorMutex, portMAX_DELAY) == pdTRUE) {
+        sensors.addSnapshotListener(xTaskGetCurrentTaskHandle());
+        xSemaphoreGive(sensorMutex);
+    }
 
     for (;;) {
         if (!lifeSupportTaskRunning) {
@@ -268,32 +379,35 @@ void lifeSupportTask(void* parameter) {
             lastSensorTs = now;
         }
 
-        if (now - lastActTs > ACTUATOR_CONTROL_INTERVAL) {
+        if (actuatorControlDue(pendingSnapshot, millis(), lastActTs, lifeSupportProbe)) {
             // Re-verifica a flag antes de agir — evita corrida na transição para o loop
             if (lifeSupportTaskRunning &&
                 xSemaphoreTake(actuatorMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                 if (lifeSupportTaskRunning) {
-                    actuators.applyLEDSchedule(firebase.getCurrentTimestamp());
-                    actuators.applyExhaustSchedule(firebase.getCurrentTimestamp());
-                    actuators.controlAutomatically(
-                        sensors.getTemperature(),
-                        sensors.getHumidity(),
-                        sensors.getLight(),
-                        sensors.getCO(),
-                        sensors.getCO2(),
-                        sensors.getTVOCs(),
-                        sensors.getWaterLevel(),
-                        sensors.isDHTHealthy(),
-                        false   // allowFirebaseWrite=false: Firebase (TLS/lwip) não pode ser
-                                // chamado de uma FreeRTOS task fora da loopTask (pthread TLS inválido)
-                    );
+                    // allowFirebaseWrite=false: Firebase (TLS/lwip) não pode ser
+                    // chamado de uma FreeRTOS task fora da loopTask (pthread TLS inválido)
+                    lifeSupportProbe.start();
+                    runActuatorControl(false);
+                    lifeSupportProbe.stop();
                 }
                 xSemaphoreGive(actuatorMutex);
             }
-            lastActTs = now;
+            pendingSnapshot = false;
+            lastActTs       = millis();
         }
 
-        vTaskDelay(50 / portTICK_PERIOD_MS);
+        // Dorme até o próximo prazo (leitura, fim do teto de taxa ou fallback)
+        // em vez de acordar a cada 50 ms. Limite de 500 ms mantém a troca
+        // loop↔task (lifeSupportTaskRunning) responsiva.
+        now = millis();
+        unsigned long wait = SENSOR_READ_INTERVAL + 1 - (now - lastSensorTs);
+        unsigned long actDeadline = pendingSnapshot ? ACTUATOR_MIN_INTERVAL : ACTUATOR_CONTROL_INTERVAL;
+        unsigned long actElapsed  = now - lastActTs;
+        if (actElapsed < actDeadline && actDeadline - actElapsed < wait) wait = actDeadline - actElapsed;
+        if (wait > SENSOR_READ_INTERVAL + 1) wait = 10;   // prazo vencido (underflow)
+        if (wait > 500) wait = 500;
+        if (wait < 10)  wait = 10;
+        vTaskDelay(pdMS_TO_TICKS(wait));
     }
 }
 
@@ -301,6 +415,54 @@ void lifeSupportTask(void* parameter) {
 // DEBUG E CALIBRAÇÃO
 // =============================================================================
 
+/**
+ * @brief Comando de calibração do LDR (só no modo debug/calibração)
+ * @details "ponto:<lux>" pareia a leitura crua atual com o luxímetro; "limpar"
+ * volta à contagem crua. A curva muda sob sensorMutex; o ganho LED→LDR da
+ * dimerização é recalibrado porque a unidade da leitura mudou.
+ */
+static void handleLightCalibration() {
+    String command;
+    if (!firebase.fetchLightCalibrationCommand(command)) return;
+
+    float lux = NAN;
+    bool  isPoint = command.startsWith("ponto:");
+    if (isPoint) {
+        const char* text = command.c_str() + 6;
+        char* end = nullptr;
+        lux = strtof(text, &end);
+        if (end == text || *end != '\0') lux = NAN;
+    }
+
+    bool   ok = false;
+    String message;
+    if (xSemaphoreTake(sensorMutex, pdMS_TO_TICKS(200)) != pdTRUE) {
+        firebase.publishLightCalibrationStatus(LightCalibration(), false, "sensores ocupados", -1);
+        return;
+    }
+    int adc = sensors.getLightRaw();
+    if (command == "limpar") {
+        sensors.clearLightCalibration();
+        ok = true;
+        message = "calibracao apagada";
+    } else if (isPoint && !isnan(lux)) {
+        ok = sensors.captureLightPoint(lux, message);
+        if (ok) message = "ponto gravado";
+    } else {
+        message = "comando invalido: " + command;
+    }
+    LightCalibration cal = sensors.lightCalibration();   // publicada fora do mutex
+    xSemaphoreGive(sensorMutex);
+
+    if (ok && xSemaphoreTake(actuatorMutex, pdMS_TO_TICKS(200)) == pdTRUE) {
+        actuators.recalibrateDaylightGain();
+        xSemaphoreGive(actuatorMutex);
+    }
+    RLOG_FMT(ok ? LOG_INFO : LOG_WARN, "[sensor]", "Calibracao do LDR (%s): %s",
+             command.c_str(), message.c_str());
+    firebase.publishLightCalibrationStatus(cal, ok, message, adc);
+}
+
 void handleDebugAndCalibration() {
     if (millis() - lastDebugCheck > DEBUG_CHECK_INTERVAL) {
         lastDebugCheck = millis();
@@ -331,6 +493,40 @@ void handleDebugAndCalibration() {
             }
         }
 
+        // Autotune a relé: pedido via /autotune/request (app / tela de calibração)
+        static unsigned long lastAutotuneCheck = 0;
+        if (millis() - lastAutotuneCheck > AUTOTUNE_CHECK_INTERVAL &&
+            firebase.isAuthenticated() && firebase.isFirebaseReady()) {
+            lastAutotuneCheck = millis();
+            firebase.receiveAutotuneRequest(actuators);
+            firebase.publishAutotuneStatus(actuators);
+        }
+
+        // Regras de automação: só a versão é lida a cada ciclo; a compilação
+        // troca o programa sob actuatorMutex (a lifeSupportTask também avalia).
+        static unsigned long lastRulesCheck = 0;
+        if (millis() - lastRulesCheck > RULES_CHECK_INTERVAL &&
+            firebase.isAuthenticated() && firebase.isFirebaseReady()) {
+            lastRulesCheck = millis();
+            String source;
+            int version = 0;
+            if (firebase.fetchRules(actuators.getRulesVersion(), source, version)) {
+                if (xSemaphoreTake(actuatorMutex, pdMS_TO_TICKS(200)) == pdTRUE) {
+                    String error;
+                    bool ok = actuators.loadRules(source, version, true, error);
+                    int count = actuators.getRuleEngine().ruleCount();
+                    xSemaphoreGive(actuatorMutex);
+                    firebase.publishRulesStatus(version, ok, error, count);
+                } else {
+                    firebase.retryRules();   // não compilada: baixa de novo no próximo ciclo
+                }
+            }
+        }
+
+        if (currentDebugMode && firebase.isAuthenticated() && firebase.isFirebaseReady()) {
+            handleLightCalibration();
+        }
+
         if (currentDebugMode && firebase.isAuthenticated() && firebase.isFirebaseReady()) {
             bool analogReadMode, digitalWriteMode, pwm;
             int pin, pwmValue;
@@ -471,8 +667,24 @@ void setupLEDTask() {
 void setupSensorsAndActuators() {
     Serial.println("[init] Initializing sensors and actuators...");
 
+    // Relógio para datar o baseline do CCS811 (NTP online / NVS+millis offline)
+    sensors.setClock([]() -> unsigned long { return firebase.getCurrentTimestamp(); });
     sensors.begin();
+    actuators.getEnergyMeter().setClock([]() -> unsigned long { return firebase.getCurrentTimestamp(); });
+    ModeTable::begin();   // presets antes de qualquer applyOperationMode()
     actuators.begin(4, 23, 14, 18, 19, 13);
+    // Limites rígidos nos relés em task própria — independe do modo e da rede.
+    // Sem a task, handleActuators() roda o supervisor pela loop.
+    if (!actuators.startSafetySupervisor(sensors)) {
+        diagLogWarn("SafetySupervisor sem task — limites dos reles verificados pela loop");
+    }
+
+    // Receita em andamento retoma o modo da fase sem esperar o Firebase
+    recipe.begin();
+    if (recipe.isActive()) {
+        actuators.applyOperationMode(recipe.mode());
+        recipeModePending = true;
+    }
 
     // BUG CORRIGIDO v1.2.1: quando loadSetpointsNVS() falha (namespace não existe
     // ainda, ou flash recém-apagada), NÃO gravamos os defaults na NVS.
@@ -752,26 +964,43 @@ void handleSensors() {
 // =============================================================================
 
 void handleActuators() {
-    if (millis() - lastActuatorControl > ACTUATOR_CONTROL_INTERVAL) {
-        if (xSemaphoreTake(actuatorMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            actuators.applyLEDSchedule(firebase.getCurrentTimestamp());
-            actuators.applyExhaustSchedule(firebase.getCurrentTimestamp());
-
-            actuators.controlAutomatically(
-                sensors.getTemperature(),
-                sensors.getHumidity(),
-                sensors.getLight(),
-                sensors.getCO(),
-                sensors.getCO2(),
-                sensors.getTVOCs(),
-                sensors.getWaterLevel(),
-                sensors.isDHTHealthy()   // ← CORREÇÃO: bloqueia Peltier se DHT falhou
-            );
+    static bool pendingSnapshot = false;
 
+    actuators.pollSafetySupervisor();   // só age se a Safety_Task não existe
+
+    if (actuatorControlDue(pendingSnapshot, millis(), lastActuatorControl, loopActuatorProbe)) {
+        if (xSemaphoreTake(actuatorMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            loopActuatorProbe.start();
+            runActuatorControl(true);
+            loopActuatorProbe.stop();
             xSemaphoreGive(actuatorMutex);
         }
+        pendingSnapshot     = false;
         lastActuatorControl = millis();
     }
+
+    // Bloqueios e intervenções do SafetySupervisor: a task (prioridade 10)
+    // só grava contadores/máscaras; Serial e log remoto saem daqui
+    static uint8_t  reportedInhibit       = 0;
+    static uint32_t reportedInterventions = 0;
+    static bool     reportedNoTask        = false;
+    const SafetySupervisor& safety = actuators.getSafetySupervisor();
+    if (!safety.running() && !reportedNoTask && firebase.isAuthenticated()) {
+        reportedNoTask = true;
+        RLOG_FMT(LOG_ERROR, "[safety]", "Safety_Task nao criada — supervisor rodando pela loop");
+    }
+    uint8_t inhibit = safety.inhibitMask();
+    if (inhibit != reportedInhibit) {
+        Serial.printf("[safety] Bloqueio dos reles: 0x%X -> 0x%X\n", reportedInhibit, inhibit);
+        reportedInhibit = inhibit;
+    }
+    uint32_t total = safety.totalInterventions();
+    if (total != reportedInterventions) {
+        reportedInterventions = total;
+        RLOG_FMT(LOG_WARN, "[safety]", "Intervencao do supervisor: %s — reles 0x%X cortados (total %u, bloqueio 0x%X, T=%.1f C)",
+                 SafetySupervisor::reasonName(safety.lastReason()), safety.lastCutMask(),
+                 total, inhibit, sensors.getTemperature());
+    }
 }
 
 // =============================================================================
@@ -851,6 +1080,10 @@ void handleFirebase() {
                 firebase.receiveExhaustSchedule(actuators);
                 lastExhaustScheduleSync = millis();
             }
+            if (millis() - lastTelemetryUpdate > TELEMETRY_INTERVAL) {
+                firebase.sendActuatorTelemetry(actuators);
+                lastTelemetryUpdate = millis();
+            }
         }
 
         lastFirebaseUpdate = millis();
@@ -880,21 +1113,138 @@ void handleOperationMode() {
 
     if (millis() - lastOperationModeCheck > OPERATION_MODE_CHECK_INTERVAL) {
         lastOperationModeCheck = millis();
-        OperationMode prevMode = actuators.getOperationMode();
-        firebase.receiveOperationMode(actuators);
-        OperationMode newMode = actuators.getOperationMode();
-        if (newMode != prevMode) {
-            RLOG_FMT(LOG_INFO, "[mode]", "Modo alterado: %s -> %s",
-                     operationModeLabel(prevMode).c_str(),
-                     operationModeLabel(newMode).c_str());
-            // Manual: restaura setpoints cacheados da NVS (valores do Firebase)
-            if (newMode == MODE_MANUAL) {
-                actuators.loadSetpointsNVS();
+        // Modo aplicado pela receita: escrita forçada antes de ler o nó, que
+        // pode ter o modo de antes do reinício/queda
+        if (recipeModePending &&
+            (!recipe.isActive() || firebase.publishOperationMode(actuators.getOperationMode(), true))) {
+            recipeModePending = false;
+        }
+        if (!recipeModePending) {
+            OperationMode prevMode = actuators.getOperationMode();
+            firebase.receiveOperationMode(actuators);
+            OperationMode newMode = actuators.getOperationMode();
+            if (newMode != prevMode) {
+                RLOG_FMT(LOG_INFO, "[mode]", "Modo alterado: %s -> %s",
+                         operationModeLabel(prevMode).c_str(),
+                         operationModeLabel(newMode).c_str());
+                // Manual: restaura setpoints cacheados da NVS (valores do Firebase)
+                if (newMode == MODE_MANUAL) {
+                    actuators.loadSetpointsNVS();
+                }
+                // Troca feita pelo operador prevalece sobre a receita
+                if (recipe.isActive() && newMode != recipe.mode()) {
+                    recipe.stop("modo alterado pelo app");
+                    firebase.publishRecipeStatus(recipe, true);
+                }
+            }
+        }
+    }
+
+    // Tabela de presets: só a versão é lida a cada ciclo
+    static unsigned long lastModeTableCheck = 0;
+    if (millis() - lastModeTableCheck > MODE_TABLE_CHECK_INTERVAL && firebase.isFirebaseReady()) {
+        lastModeTableCheck = millis();
+        String source;
+        int version = 0;
+        if (firebase.fetchModeTable(ModeTable::version(), source, version)) {
+            // Carga e reaplicação sob a mesma tomada do mutex: sem ele a versão
+            // não é carregada e volta no próximo ciclo
+            if (xSemaphoreTake(actuatorMutex, pdMS_TO_TICKS(200)) == pdTRUE) {
+                // Ids de modos personalizados seguem a ordem da tabela: o modo
+                // ativo é guardado pela chave e resolvido de novo após a carga
+                OperationMode mode = actuators.getOperationMode();
+                char activeKey[sizeof(ModeEntry::key)];
+                strncpy(activeKey, ModeTable::key(mode), sizeof(activeKey) - 1);
+                activeKey[sizeof(activeKey) - 1] = '\0';
+
+                String error;
+                bool ok = ModeTable::load(source, version, true, error);
+                if (ok && mode != MODE_MANUAL) {
+                    OperationMode resolved = ModeTable::find(activeKey);
+                    if (resolved == MODE_MANUAL) {
+                        RLOG_FMT(LOG_WARN, "[mode]", "Modo %s removido da tabela — voltando ao manual", activeKey);
+                        actuators.applyOperationMode(MODE_MANUAL);
+                        actuators.loadSetpointsNVS();
+                    } else {
+                        actuators.applyOperationMode(resolved, true);
+                    }
+                }
+                if (ok) recipe.resolveModes();   // fases guardam chaves; ids mudam
+                xSemaphoreGive(actuatorMutex);
+                firebase.publishModeTableStatus(version, ok, error);
+            } else {
+                firebase.retryModeTable();
             }
         }
     }
 }
 
+// =============================================================================
+// RECEITA DE CULTIVO
+// =============================================================================
+
+void handleGrowRecipe() {
+    if (millis() - lastRecipeCheck <= RECIPE_CHECK_INTERVAL) return;
+    lastRecipeCheck = millis();
+
+    unsigned long epoch = firebase.getCurrentTimestamp();
+    bool online = firebase.isAuthenticated() && WiFi.status() == WL_CONNECTED &&
+                  firebase.isFirebaseReady();
+    bool phaseChanged = false;
+    bool force = false;
+
+    if (online) {
+        String source;
+        int version = 0;
+        if (firebase.fetchRecipe(recipe.version(), source, version)) {
+            String error;
+            if (!recipe.load(source, version, error)) {
+                RLOG_FMT(LOG_WARN, "[recipe]", "Receita v%d rejeitada: %s", version, error.c_str());
+            }
+            force = true;
+        }
+
+        String cmd = firebase.receiveRecipeCommand();
+        if (cmd == "start") {
+            phaseChanged = recipe.start(epoch);
+        } else if (cmd == "next") {
+            phaseChanged = recipe.skip(epoch);
+        } else if (cmd == "stop") {
+            recipe.stop("parada pelo app");
+        } else if (cmd.length()) {
+            Serial.printf("[recipe] Comando desconhecido ignorado: %s\n", cmd.c_str());
+        }
+        force = force || cmd.length() > 0;
+    }
+
+    // Sem Firebase a receita também avança: os dias vêm do relógio (NVS + millis)
+    if (recipe.update(epoch, sensors.getCO2(), sensors.isCCS811Ready(), millis())) {
+        phaseChanged = true;
+    }
+
+    if (phaseChanged) {
+        RLOG_FMT(LOG_INFO, "[recipe]", "Receita: %s", recipe.lastReason());
+        force = true;
+    }
+
+    // Conferido a cada ciclo, não só na troca de fase: mutex ocupado, nova
+    // versão da receita ou da tabela de modos não deixam o modo da fase para trás
+    if (recipe.isActive() && recipe.mode() != actuators.getOperationMode() &&
+        xSemaphoreTake(actuatorMutex, pdMS_TO_TICKS(200)) == pdTRUE) {
+        OperationMode prevMode = actuators.getOperationMode();
+        actuators.applyOperationMode(recipe.mode());
+        xSemaphoreGive(actuatorMutex);
+        if (prevMode != MODE_MANUAL && recipe.mode() == MODE_MANUAL) {
+            actuators.loadSetpointsNVS();
+        }
+        // Publica já (ou antes da próxima leitura do modo, se offline) para
+        // receiveOperationMode() não tomar o modo antigo como troca do app
+        recipeModePending = !(online && firebase.publishOperationMode(recipe.mode(), true));
+    }
+
+    if (online) firebase.publishRecipeStatus(recipe, force);
+}
+
 void handleRepairAndOTA() {
     if (!firebase.isAuthenticated() || WiFi.status() != WL_CONNECTED) return;
 
@@ -922,6 +1272,11 @@ void setup() {
                 rtcBootCount,
                 resetReasonLabel(esp_reset_reason()),
                 rtcLastStage);
+    if (TimingProbe::worstStageUs() > 0) {
+        diagLogInfo("Pior estagio no boot anterior: %s (%lums)",
+                    TimingProbe::worstStage(), (unsigned long)(TimingProbe::worstStageUs() / 1000UL));
+    }
+    TimingProbe::resetWorstStage();
     setRuntimeStage("setup");
 
     // Mutex deve ser criado antes de qualquer tarefa que use sensores/atuadores
@@ -947,6 +1302,10 @@ void setup() {
 
     setupSensorsAndActuators();
 
+    // setup() roda na loopTask: registra-a para receber os snapshots dos
+    // sensores (handleActuators). A lifeSupportTask se registra sozinha.
+    sensors.addSnapshotListener(xTaskGetCurrentTaskHandle());
+
     // LifeSupport no core 0 — DHT22 (1-Wire) fica livre no core 1
     // Começa ativo para cobrir o período de setupWiFiAndFirebase()
     lifeSupportTaskRunning = true;
@@ -1000,6 +1359,7 @@ void loop() {
         runTimedHandler("handleFirebase", handleFirebase);
         runTimedHandler("handleHistoryAndLocalData", handleHistoryAndLocalData);
         runTimedHandler("handleDebugAndCalibration", handleDebugAndCalibration);
+        runTimedHandler("handleGrowRecipe", handleGrowRecipe);
         runTimedHandler("handleOperationMode", handleOperationMode);
         runTimedHandler("handleRepairAndOTA", handleRepairAndOTA);
         runTimedHandler("verifyConnectionStatus", verifyConnectionStatus);
@@ -0,0 +1,363 @@
+/**
+ * @file OperationMode.cpp
+ * @brief Tabela de modos: presets embutidos, índice hash e decodificação
+ * @version 1.1
+ * @date 2026
+ */
+
+#include "OperationMode.h"
+#include <Preferences.h>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+// =============================================================================
+// PRESETS EMBUTIDOS
+// =============================================================================
+
+// Valores baseados em literatura de cultivo de fungos comestíveis
+// (Pleurotus ostreatus, Lentinula edodes, Ganoderma lucidum).
+// A ordem segue o enum OperationMode — o id do modo é o índice.
+static const ModeEntry BUILTIN_MODES[MODE_BUILTIN_COUNT] = {
+
+    // ─── MANUAL (padrão) ─────────────────────────────────────────────────────
+    // Sem restrições. Tudo controlado pelos setpoints do app.
+    { "manual", "Manual", {
+        /* tempMin */          20.0f,
+        /* tempMax */          30.0f,
+        /* humidityMin */      60.0f,
+        /* humidityMax */      80.0f,
+        /* co2Setpoint */      1000,
+        /* luxSetpoint */      5000,
+        /* humidifierEnabled*/ true,
+        /* ledsEnabled */      true,
+        /* peltierEnabled */   true,
+        /* exhaustForcedOn */  false,
+        /* schedulerActive */  false,
+        /* solarSim */         false,
+        /* ledOnHour */        6,
+        /* ledOnMinute */      0,
+        /* ledOffHour */       20,
+        /* ledOffMinute */     0,
+        /* ledIntensity */     255
+    } },
+
+    // ─── INCUBAÇÃO ────────────────────────────────────────────────────────────
+    // Substrato selado em sacos. Micélio coloniza em escuro e seco.
+    // Temp ideal Pleurotus: 22-28°C. Sem luz. Sem umidade externa.
+    { "incubacao", "Incubação", {
+        /* tempMin */          22.0f,
+        /* tempMax */          28.0f,
+        /* humidityMin */      50.0f,  // irrelevante (umidif. desligado)
+        /* humidityMax */      70.0f,  // irrelevante
+        /* co2Setpoint */      2000,   // tolerância maior (sacos fechados produzem CO2)
+        /* luxSetpoint */      0,      // sem setpoint de luz
+        /* humidifierEnabled*/ false,  // ← DESLIGADO: sacos são selados
+        /* ledsEnabled */      false,  // ← DESLIGADO: fase escura
+        /* peltierEnabled */   true,   // ← ATIVO: controla temperatura
+        /* exhaustForcedOn */  false,  // exaustor apenas por CO2
+        /* schedulerActive */  false,
+        /* solarSim */         false,
+        /* ledOnHour */        0,
+        /* ledOnMinute */      0,
+        /* ledOffHour */       0,
+        /* ledOffMinute */     0,
+        /* ledIntensity */     0
+    } },
+
+    // ─── FRUTIFICAÇÃO ─────────────────────────────────────────────────────────
+    // Sacos abertos ou blocos expostos. Alta umidade, ciclo de luz 12h.
+    // Temp ideal Pleurotus frutificação: 18-24°C.
+    { "frutificacao", "Frutificação", {
+        /* tempMin */          18.0f,
+        /* tempMax */          24.0f,
+        /* humidityMin */      85.0f,  // ← alta umidade essencial
+        /* humidityMax */      95.0f,
+        /* co2Setpoint */      800,    // ← baixo CO2 estimula primórdios
+        /* luxSetpoint */      3000,
+        /* humidifierEnabled*/ true,   // ← ATIVO: umidade alta
+        /* ledsEnabled */      true,   // ← ATIVO: ciclo de luz
+        /* peltierEnabled */   true,
+        /* exhaustForcedOn */  false,
+        /* schedulerActive */  true,   // ← ativa scheduler automaticamente
+        /* solarSim */         false,  // timer fixo (12h)
+        /* ledOnHour */        6,
+        /* ledOnMinute */      0,
+        /* ledOffHour */       18,
+        /* ledOffMinute */     0,
+        /* ledIntensity */     180     // ~70% de intensidade
+    } },
+
+    // ─── SECAGEM ─────────────────────────────────────────────────────────────
+    // Pós-colheita. Reduz umidade. Exaustor contínuo para secar o ambiente.
+    { "secagem", "Secagem", {
+        /* tempMin */          20.0f,
+        /* tempMax */          35.0f,  // faixa larga — sem controle ativo
+        /* humidityMin */      30.0f,
+        /* humidityMax */      50.0f,  // umidade baixa desejada
+        /* co2Setpoint */      1000,
+        /* luxSetpoint */      0,
+        /* humidifierEnabled*/ false,  // ← DESLIGADO
+        /* ledsEnabled */      false,  // ← DESLIGADO
+        /* peltierEnabled */   false,  // ← DESLIGADO: economia de energia
+        /* exhaustForcedOn */  true,   // ← exaustor SEMPRE ligado para secar
+        /* schedulerActive */  false,
+        /* solarSim */         false,
+        /* ledOnHour */        0,
+        /* ledOnMinute */      0,
+        /* ledOffHour */       0,
+        /* ledOffMinute */     0,
+        /* ledIntensity */     0
+    } },
+
+    // ─── MANUTENÇÃO ──────────────────────────────────────────────────────────
+    // Sem cultivo. Tudo desligado. Ideal para limpeza/esterilização.
+    { "manutencao", "Manutenção", {
+        /* tempMin */          10.0f,  // faixa muito larga = Peltier nunca aciona
+        /* tempMax */          40.0f,
+        /* humidityMin */      0.0f,
+        /* humidityMax */      100.0f,
+        /* co2Setpoint */      5000,   // exaustor nunca aciona
+        /* luxSetpoint */      0,
+        /* humidifierEnabled*/ false,
+        /* ledsEnabled */      false,
+        /* peltierEnabled */   false,
+        /* exhaustForcedOn */  false,
+        /* schedulerActive */  false,
+        /* solarSim */         false,
+        /* ledOnHour */        0,
+        /* ledOnMinute */      0,
+        /* ledOffHour */       0,
+        /* ledOffMinute */     0,
+        /* ledIntensity */     0
+    } },
+};
+
+/// Versão do layout do blob na NVS — mudar ModeEntry/ModePreset exige incrementar
+static const uint16_t MODE_TABLE_FORMAT = 1;
+
+ModeTable::Table ModeTable::_table = {};
+uint8_t          ModeTable::_index[ModeTable::HASH_SLOTS] = {};
+
+// =============================================================================
+// ÍNDICE HASH
+// =============================================================================
+
+static uint32_t modeKeyHash(const char* key) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    while (*key) {
+        h ^= (uint8_t)*key++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void ModeTable::_rebuildIndex() {
+    memset(_index, 0, sizeof(_index));
+    for (uint8_t id = 0; id < _table.count; id++) {
+        uint32_t slot = modeKeyHash(_table.entries[id].key) & (HASH_SLOTS - 1);
+        while (_index[slot] != 0) slot = (slot + 1) & (HASH_SLOTS - 1);
+        _index[slot] = id + 1;
+    }
+}
+
+OperationMode ModeTable::find(const char* key) {
+    uint32_t slot = modeKeyHash(key) & (HASH_SLOTS - 1);
+    while (_index[slot] != 0) {
+        uint8_t id = _index[slot] - 1;
+        if (strcmp(_table.entries[id].key, key) == 0) return (OperationMode)id;
+        slot = (slot + 1) & (HASH_SLOTS - 1);
+    }
+    return MODE_MANUAL;
+}
+
+String ModeTable::keyList() {
+    String list;
+    for (uint8_t id = 0; id < _table.count; id++) {
+        if (id) list += ",";
+        list += _table.entries[id].key;
+    }
+    return list;
+}
+
+// =============================================================================
+// CARGA (NVS / EMBUTIDOS)
+// =============================================================================
+
+void ModeTable::_loadBuiltins(Table& t) {
+    t = Table();
+    t.format  = MODE_TABLE_FORMAT;
+    t.version = 0;
+    t.count   = MODE_BUILTIN_COUNT;
+    memcpy(t.entries, BUILTIN_MODES, sizeof(BUILTIN_MODES));
+}
+
+void ModeTable::begin() {
+    _loadBuiltins(_table);
+
+    Preferences preferences;
+    if (preferences.begin("modes", true)) {
+        Table saved;
+        size_t len = preferences.getBytes("tbl", &saved, sizeof(saved));
+        preferences.end();
+
+        if (len == sizeof(saved) && saved.format == MODE_TABLE_FORMAT &&
+            saved.count >= MODE_BUILTIN_COUNT && saved.count <= MODE_TABLE_MAX) {
+            _table = saved;
+            Serial.printf("[mode] Tabela de modos v%d restaurada da NVS (%u modos)\n",
+                          (int)_table.version, _table.count);
+        }
+    }
+    _rebuildIndex();
+}
+
+// =============================================================================
+// DECODIFICAÇÃO DA TABELA DE TEXTO
+// =============================================================================
+
+static bool parseModeClock(const char* text, int& hour, int& minute) {
+    return sscanf(text, "%d:%d", &hour, &minute) == 2 &&
+           hour >= 0 && hour <= 23 && minute >= 0 && minute <= 59;
+}
+
+bool ModeTable::_parseLine(char* line, Table& t, String& error) {
+    static const uint8_t FIELDS = 12;
+    char* field[FIELDS];
+    uint8_t n = 0;
+    // Divisão manual: strtok_r juntaria separadores seguidos e descartaria
+    // campos vazios, deslocando as colunas
+    for (char* f = line; ; ) {
+        if (n == FIELDS) { error = "campos demais"; return false; }
+        char* comma = strchr(f, ',');
+        if (comma) *comma = '\0';
+        while (*f == ' ' || *f == '\t') f++;
+        char* end = f + strlen(f);
+        while (end > f && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) *--end = '\0';
+        field[n++] = f;
+        if (!comma) break;
+        f = comma + 1;
+    }
+    if (n != FIELDS) { error = "esperados 12 campos"; return false; }
+
+    const char* key = field[0];
+    size_t keyLen = strlen(key);
+    if (keyLen == 0 || keyLen >= sizeof(ModeEntry::key)) { error = "chave vazia ou longa demais"; return false; }
+    for (const char* c = key; *c; c++) {
+        if (!((*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9') || *c == '_')) {
+            error = "chave aceita apenas [a-z0-9_]";
+            return false;
+        }
+    }
+    if (strcmp(key, "manual") == 0) { error = "modo manual nao e redefinivel"; return false; }
+
+    ModePreset p = {};
+    float* ranges[4] = { &p.tempMin, &p.tempMax, &p.humidityMin, &p.humidityMax };
+    for (uint8_t i = 0; i < 4; i++) {
+        char* end;
+        *ranges[i] = strtof(field[2 + i], &end);
+        if (end == field[2 + i] || *end) { error = "numero invalido: " + String(field[2 + i]); return false; }
+    }
+    if (p.tempMin >= p.tempMax || p.humidityMin >= p.humidityMax ||
+        p.humidityMin < 0.0f || p.humidityMax > 100.0f) {
+        error = "faixa de temperatura/umidade invalida";
+        return false;
+    }
+
+    char* end;
+    p.co2Setpoint = (int)strtol(field[6], &end, 10);
+    if (end == field[6] || *end || p.co2Setpoint <= 0) { error = "co2 invalido"; return false; }
+    p.luxSetpoint = (int)strtol(field[7], &end, 10);
+    if (end == field[7] || *end || p.luxSetpoint < 0) { error = "lux invalido"; return false; }
+
+    for (const char* c = field[8]; *c; c++) {
+        switch (*c) {
+            case 'H': p.humidifierEnabled = true; break;
+            case 'L': p.ledsEnabled       = true; break;
+            case 'P': p.peltierEnabled    = true; break;
+            case 'X': p.exhaustForcedOn   = true; break;
+            case 'S': p.schedulerActive   = true; break;
+            case 'O': p.solarSim          = true; break;
+            case '-': break;
+            default:  error = "flag desconhecida: " + String(*c); return false;
+        }
+    }
+
+    if (!parseModeClock(field[9],  p.ledOnHour,  p.ledOnMinute) ||
+        !parseModeClock(field[10], p.ledOffHour, p.ledOffMinute)) {
+        error = "horario invalido (HH:MM)";
+        return false;
+    }
+    p.ledIntensity = (int)strtol(field[11], &end, 10);
+    if (end == field[11] || *end || p.ledIntensity < 0 || p.ledIntensity > 255) {
+        error = "intensidade invalida (0-255)";
+        return false;
+    }
+
+    // Chave existente (embutida ou repetida) mantém o id; nova vai ao fim
+    uint8_t id = 0;
+    while (id < t.count && strcmp(t.entries[id].key, key) != 0) id++;
+    if (id == t.count) {
+        if (t.count >= MODE_TABLE_MAX) { error = "tabela cheia"; return false; }
+        t.count++;
+    }
+    ModeEntry& e = t.entries[id];
+    strncpy(e.key, key, sizeof(e.key) - 1);
+    e.key[sizeof(e.key) - 1] = '\0';
+    strncpy(e.label, field[1][0] ? field[1] : key, sizeof(e.label) - 1);
+    e.label[sizeof(e.label) - 1] = '\0';
+    e.preset = p;
+    return true;
+}
+
+bool ModeTable::load(const String& source, int version, bool persist, String& error) {
+    // Cada versão parte dos embutidos: modo removido da tabela deixa de existir
+    Table next;
+    _loadBuiltins(next);
+    next.version = version;
+
+    char line[160];
+    uint8_t lineNo = 0;
+    unsigned int i = 0, n = source.length();
+    while (i < n) {
+        uint8_t k = 0;
+        bool truncated = false;
+        while (i < n && source[i] != '\n') {
+            if (k < sizeof(line) - 1) line[k++] = source[i];
+            else truncated = true;
+            i++;
+        }
+        i++;
+        line[k] = '\0';
+        lineNo++;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        const char* t = line;
+        while (*t == ' ' || *t == '\t' || *t == '\r') t++;
+        if (*t == '\0') continue;
+
+        String e;
+        if (truncated) e = "linha longa demais";
+        if (truncated || !_parseLine(line, next, e)) {
+            error = "linha " + String(lineNo) + ": " + e;
+            Serial.printf("[mode] Tabela v%d rejeitada: %s\n", version, error.c_str());
+            return false;
+        }
+    }
+
+    _table = next;
+    _rebuildIndex();
+    error = "";
+    Serial.printf("[mode] Tabela de modos v%d carregada (%u modos)\n", version, _table.count);
+
+    if (persist) {
+        Preferences preferences;
+        if (preferences.begin("modes", false)) {
+            preferences.putBytes("tbl", &_table, sizeof(_table));
+            preferences.end();
+        } else {
+            Serial.println("[mode] Failed opening NVS to save mode table");
+        }
+    }
+    return true;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file PIDController.cpp
+ * @brief Implementação do PID com anti-windup e da saída por proporção de tempo
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "PIDController.h"
+#include <cmath>
+
+// =============================================================================
+// PID
+// =============================================================================
+
+void PIDController::setOutputLimits(float outMin, float outMax) {
+    if (outMin >= outMax) return;
+    _outMin = outMin;
+    _outMax = outMax;
+    if (_integral > _outMax) _integral = _outMax;
+    if (_integral < _outMin) _integral = _outMin;
+}
+
+void PIDController::reset() {
+    _integral = 0.0f;
+    _hasLast  = false;
+    _output   = 0.0f;
+}
+
+float PIDController::compute(float error, float measurement, float dtSec) {
+    if (isnan(error) || isnan(measurement)) return _output;
+
+    float pTerm = kp * error;
+    float dTerm = 0.0f;
+
+    if (dtSec > 0.0f) {
+        // Derivada sobre a medição: uma mudança de setpoint não gera pico
+        if (_hasLast && kd != 0.0f) {
+            dTerm = -kd * (measurement - _lastMeas) / dtSec;
+        }
+
+        // Integração condicional: só acumula se não empurrar a saída
+        // ainda mais para dentro da saturação.
+        float candidate = _integral + ki * error * dtSec;
+        float unclamped = pTerm + candidate + dTerm;
+        bool  pushesHigh = unclamped > _outMax && error > 0.0f;
+        bool  pushesLow  = unclamped < _outMin && error < 0.0f;
+        if (!pushesHigh && !pushesLow) {
+            _integral = candidate;
+        }
+        if (_integral > _outMax) _integral = _outMax;
+        if (_integral < _outMin) _integral = _outMin;
+    }
+
+    _lastMeas = measurement;
+    _hasLast  = true;
+
+    float out = pTerm + _integral + dTerm;
+    if (out > _outMax) out = _outMax;
+    if (out < _outMin) out = _outMin;
+    _output = out;
+    return out;
+}
+
+// =============================================================================
+// PROPORÇÃO DE TEMPO
+// =============================================================================
+
+void TimeProportionalOutput::configure(unsigned long windowMs, unsigned long minOnMs,
+                                       unsigned long minOffMs) {
+    if (windowMs == 0) return;
+    _window = windowMs;
+    _minOn  = minOnMs  < windowMs ? minOnMs  : windowMs;
+    _minOff = minOffMs < windowMs ? minOffMs : windowMs;
+}
+
+bool TimeProportionalOutput::update(float duty, unsigned long now) {
+    if (isnan(duty) || duty < 0.0f) duty = 0.0f;
+    if (duty > 1.0f) duty = 1.0f;
+
+    // Pulsos menores que o mínimo viram 0/100% — evita cliques curtos do relé
+    unsigned long onTime = (unsigned long)(duty * (float)_window);
+    if (onTime < _minOn) onTime = 0;
+    if (onTime > 0 && _window - onTime < _minOff) onTime = _window;
+
+    if (!_started) {
+        _started     = true;
+        _windowStart = now;
+        _lastSwitch  = now - (_minOn > _minOff ? _minOn : _minOff);
+    }
+    if (now - _windowStart >= _window) {
+        // Realinha sem acumular atraso (chamadas espaçadas de ~5 s)
+        _windowStart += ((now - _windowStart) / _window) * _window;
+    }
+
+    bool want = (now - _windowStart) < onTime;
+    if (want != _on) {
+        unsigned long held = now - _lastSwitch;
+        if (_on && held < _minOn)   return _on;   // tempo mínimo ligado
+        if (!_on && held < _minOff) return _on;   // tempo mínimo desligado
+        _on         = want;
+        _lastSwitch = now;
+    }
+    return _on;
+}
+
+void TimeProportionalOutput::forceOff(unsigned long now) {
+    if (_on) {
+        _on         = false;
+        _lastSwitch = now;
+    }
+}
@@ -0,0 +1,26 @@
+/**
+ * @file PeltierThermalModel.cpp
+ * @brief Implementação da estimativa térmica do dissipador do Peltier
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "PeltierThermalModel.h"
+#include <cmath>
+
+void PeltierThermalModel::reset(unsigned long now) {
+    _rise       = 0.5f * riseFullC;
+    _lastUpdate = now;
+}
+
+void PeltierThermalModel::update(bool heating, float ambient, unsigned long now) {
+    if (!isnan(ambient)) _ambient = ambient;
+
+    float dt = (now - _lastUpdate) / 1000.0f;
+    _lastUpdate = now;
+    if (dt <= 0.0f || tauSec <= 0.0f) return;
+
+    // Solução exata da 1ª ordem para entrada constante no intervalo
+    float target = heating ? riseFullC : 0.0f;
+    _rise = target + (_rise - target) * expf(-dt / tauSec);
+}
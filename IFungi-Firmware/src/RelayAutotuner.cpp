@@ -0,0 +1,105 @@
+/**
+ * @file RelayAutotuner.cpp
+ * @brief Implementação do autotune por realimentação a relé
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "RelayAutotuner.h"
+#include <cmath>
+
+void RelayAutotuner::start(float setpoint, float hysteresis, float amplitude,
+                           uint8_t cycles, unsigned long timeoutMs, AutotuneRule rule) {
+    _setpoint     = setpoint;
+    _hysteresis   = hysteresis > 0.0f ? hysteresis : 0.1f;
+    _amplitude    = amplitude > 0.0f ? amplitude : 1.0f;
+    _cyclesWanted = cycles > 0 ? cycles : 1;
+    _timeout      = timeoutMs;
+    _rule         = rule;
+    _startedAt    = millis();
+
+    _high         = true;   // primeira meia-onda empurra para cima
+    _peakMax      = -INFINITY;
+    _peakMin      = INFINITY;
+    _seenRise     = false;
+    _cyclesDone   = 0;
+    _sumAmplitude = 0.0f;
+    _sumPeriod    = 0.0f;
+    _ku = _pu = _kp = _ki = _kd = 0.0f;
+    _failReason   = "";
+    _state        = AUTOTUNE_RUNNING;
+
+    Serial.printf("[autotune] Inicio: sp=%.2f h=%.2f d=%.2f, %u ciclos, timeout %lu min\n",
+                  setpoint, _hysteresis, _amplitude, _cyclesWanted, timeoutMs / 60000UL);
+}
+
+void RelayAutotuner::abort(const char* reason) {
+    if (_state != AUTOTUNE_RUNNING) return;
+    _state      = AUTOTUNE_FAILED;
+    _failReason = reason ? reason : "abortado";
+    Serial.printf("[autotune] FALHOU: %s\n", _failReason);
+}
+
+bool RelayAutotuner::update(float measurement, unsigned long now) {
+    if (_state != AUTOTUNE_RUNNING) return false;
+    if (isnan(measurement)) return _high;
+
+    if (now - _startedAt > _timeout) {
+        abort("timeout sem oscilacao sustentada");
+        return false;
+    }
+
+    if (measurement > _peakMax) _peakMax = measurement;
+    if (measurement < _peakMin) _peakMin = measurement;
+
+    if (_high && measurement > _setpoint + _hysteresis) {
+        _high = false;
+    } else if (!_high && measurement < _setpoint - _hysteresis) {
+        // Subida do relé: fecha um ciclo completo (pico máx + pico mín vistos)
+        _high = true;
+        if (_seenRise) {
+            _cyclesDone++;
+            if (_cyclesDone > 1) {   // ciclo 1 = transitório, descartado
+                _sumAmplitude += 0.5f * (_peakMax - _peakMin);
+                _sumPeriod    += (now - _lastRise) / 1000.0f;
+                Serial.printf("[autotune] Ciclo %u/%u: a=%.3f P=%.0fs\n",
+                              _cyclesDone - 1, _cyclesWanted,
+                              0.5f * (_peakMax - _peakMin), (now - _lastRise) / 1000.0f);
+            }
+            if (_cyclesDone > _cyclesWanted) {
+                _finish();
+                return false;
+            }
+        }
+        _seenRise = true;
+        _lastRise = now;
+        _peakMax  = measurement;
+        _peakMin  = measurement;
+    }
+    return _high;
+}
+
+void RelayAutotuner::_finish() {
+    float n = (float)_cyclesWanted;
+    float a = _sumAmplitude / n;
+    _pu     = _sumPeriod / n;
+
+    if (a < 1e-3f || _pu <= 0.0f) {
+        abort("amplitude desprezivel — atuador sem efeito?");
+        return;
+    }
+
+    _ku = 4.0f * _amplitude / ((float)M_PI * a);
+    if (_rule == AUTOTUNE_RULE_PI) {
+        _kp = 0.45f * _ku;
+        _ki = 0.54f * _ku / _pu;
+        _kd = 0.0f;
+    } else {
+        _kp = 0.6f   * _ku;
+        _ki = 1.2f   * _ku / _pu;
+        _kd = 0.075f * _ku * _pu;
+    }
+    _state = AUTOTUNE_DONE;
+    Serial.printf("[autotune] CONCLUIDO: Ku=%.3f Pu=%.0fs -> Kp=%.4f Ki=%.6f Kd=%.3f\n",
+                  _ku, _pu, _kp, _ki, _kd);
+}
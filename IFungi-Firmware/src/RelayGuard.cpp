@@ -0,0 +1,112 @@
+/**
+ * @file RelayGuard.cpp
+ * @brief Implementação da proteção contra desgaste dos relés
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "RelayGuard.h"
+#include <Preferences.h>
+
+static const char* const WEAR_KEYS[RelayGuard::RELAYS] = {"c1", "c2", "c3", "c4"};
+
+void RelayGuard::configure(uint8_t relay, const RelayWearConfig& cfg) {
+    _r[_idx(relay)].cfg = cfg;
+}
+
+void RelayGuard::begin() {
+    Preferences prefs;
+    bool opened = prefs.begin("relay-wear", true);   // falha = primeiro boot
+
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < RELAYS; i++) {
+        RelayWear& r = _r[i];
+        r.lifetime = opened ? prefs.getULong(WEAR_KEYS[i], 0) : 0;
+        r.state    = false;
+        // Relés partem desligados: a primeira comutação não espera minOff
+        r.lastChange = now - r.cfg.minOffMs;
+    }
+    if (opened) prefs.end();
+
+    Serial.printf("[relay] Comutacoes acumuladas: R1=%lu R2=%lu R3=%lu R4=%lu\n",
+                  (unsigned long)_r[0].lifetime, (unsigned long)_r[1].lifetime,
+                  (unsigned long)_r[2].lifetime, (unsigned long)_r[3].lifetime);
+}
+
+uint16_t RelayGuard::switchesLastHour(uint8_t relay, unsigned long now) const {
+    const RelayWear& r = _r[_idx(relay)];
+    uint32_t epoch = now / WEAR_BUCKET_MS;
+    uint16_t total = 0;
+    for (uint8_t b = 0; b < WEAR_BUCKETS; b++) {
+        if (epoch - r.bucketEpoch[b] < WEAR_BUCKETS) total += r.bucketCount[b];
+    }
+    return total;
+}
+
+bool RelayGuard::permit(uint8_t relay, bool newState, unsigned long now) {
+    RelayWear& r = _r[_idx(relay)];
+    if (newState == r.state) return true;
+
+    const char* why = nullptr;
+    unsigned long held = now - r.lastChange;
+    if (r.state && held < r.cfg.minOnMs)        why = "tempo minimo ligado";
+    else if (!r.state && held < r.cfg.minOffMs) why = "tempo minimo desligado";
+    // Limite horário só adia o LIGAR, reservando a comutação de desligar: um
+    // relé energizado nunca fica preso ligado por falta de orçamento
+    else if (newState && r.cfg.maxSwitchesPerHour > 0 &&
+             switchesLastHour(relay, now) + 2 > r.cfg.maxSwitchesPerHour) why = "limite de comutacoes/hora";
+
+    if (why == nullptr) return true;
+
+    r.blocked++;
+    if (now - r.lastBlockLog > 30000UL || r.lastBlockLog == 0) {
+        r.lastBlockLog = now;
+        Serial.printf("[relay] R%u: comutacao para %s adiada (%s)\n",
+                      relay, newState ? "LIGADO" : "DESLIGADO", why);
+    }
+    return false;
+}
+
+void RelayGuard::record(uint8_t relay, bool newState, unsigned long now) {
+    RelayWear& r = _r[_idx(relay)];
+    if (newState == r.state) return;
+
+    r.state      = newState;
+    r.lastChange = now;
+    r.lifetime++;
+
+    uint32_t epoch = now / WEAR_BUCKET_MS;
+    uint8_t  b     = epoch % WEAR_BUCKETS;
+    if (r.bucketEpoch[b] != epoch) {
+        r.bucketEpoch[b] = epoch;
+        r.bucketCount[b] = 0;
+    }
+    r.bucketCount[b]++;
+
+    if (_pending == 0) _firstPendingAt = now;
+    _pending++;
+}
+
+void RelayGuard::flushIfDue(unsigned long now) {
+    if (_pending == 0) return;
+    if (_pending >= WEAR_FLUSH_SWITCHES || now - _firstPendingAt >= WEAR_FLUSH_INTERVAL_MS) {
+        flush();
+    }
+}
+
+void RelayGuard::flush() {
+    if (_pending == 0) return;
+
+    Preferences prefs;
+    if (!prefs.begin("relay-wear", false)) {
+        Serial.println("[nvs] Error opening NVS to save relay counters");
+        return;
+    }
+    for (uint8_t i = 0; i < RELAYS; i++) {
+        prefs.putULong(WEAR_KEYS[i], _r[i].lifetime);
+    }
+    prefs.end();
+
+    Serial.printf("[relay] %u comutacoes gravadas na NVS\n", _pending);
+    _pending = 0;
+}
@@ -0,0 +1,406 @@
+/**
+ * @file RuleEngine.cpp
+ * @brief Compilador (descida recursiva → pós-fixa) e interpretador das regras
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "RuleEngine.h"
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+
+// =============================================================================
+// BYTECODE
+// =============================================================================
+
+enum RuleOp : uint8_t {
+    OP_LOAD = 1,   ///< + índice do sensor (1 byte)
+    OP_CONST,      ///< + float (4 bytes)
+    OP_GT, OP_LT, OP_GE, OP_LE, OP_EQ, OP_NE,
+    OP_AND, OP_OR, OP_NOT
+};
+
+static const char* const RULE_SENSOR_NAMES[RULE_SENSOR_COUNT] = {
+    "temp", "humidity", "light", "co", "co2", "tvocs", "water"
+};
+static const char* const RULE_ACTUATOR_NAMES[RULE_ACT_COUNT] = {
+    "exhaust", "humidifier", "led"
+};
+
+// =============================================================================
+// COMPILADOR
+// =============================================================================
+
+namespace {
+
+enum TokType : uint8_t { TOK_END, TOK_WORD, TOK_NUM, TOK_OP, TOK_LPAREN, TOK_RPAREN, TOK_BAD };
+
+struct Tok {
+    TokType type;
+    char    text[16];
+    float   num;
+};
+
+/// Analisador léxico + emissor; erros param a compilação na primeira falha
+struct RuleCompiler {
+    const char* p;
+    Tok         tok;
+    uint8_t*    out;
+    uint8_t     len;
+    uint8_t     depth;
+    uint8_t     maxDepth;
+    const char* err;
+
+    void next() {
+        while (*p == ' ' || *p == '\t') p++;
+        tok.text[0] = '\0';
+        tok.num     = 0.0f;
+        if (*p == '\0') { tok.type = TOK_END; return; }
+
+        if (*p == '(') { tok.type = TOK_LPAREN; p++; return; }
+        if (*p == ')') { tok.type = TOK_RPAREN; p++; return; }
+
+        if (strchr("<>=!", *p)) {
+            uint8_t n = 0;
+            while (*p && strchr("<>=!", *p) && n < 2) tok.text[n++] = *p++;
+            tok.text[n] = '\0';
+            tok.type = TOK_OP;
+            return;
+        }
+
+        if (isdigit((unsigned char)*p) || *p == '-' || *p == '.') {
+            char* end = nullptr;
+            tok.num  = strtof(p, &end);
+            tok.type = (end != p) ? TOK_NUM : TOK_BAD;
+            p = (end != p) ? end : p + 1;
+            return;
+        }
+
+        if (isalpha((unsigned char)*p)) {
+            uint8_t n = 0;
+            while (isalnum((unsigned char)*p) || *p == '_') {
+                if (n < sizeof(tok.text) - 1) tok.text[n++] = (char)tolower((unsigned char)*p);
+                p++;
+            }
+            tok.text[n] = '\0';
+            tok.type = TOK_WORD;
+            return;
+        }
+        tok.type = TOK_BAD;
+        p++;
+    }
+
+    bool isWord(const char* w) const { return tok.type == TOK_WORD && strcmp(tok.text, w) == 0; }
+
+    bool fail(const char* msg) {
+        if (!err) err = msg;
+        return false;
+    }
+
+    bool emit(uint8_t b) {
+        if (len >= RuleEngine::RULE_MAX_CODE) return fail("regra longa demais");
+        out[len++] = b;
+        return true;
+    }
+
+    // Profundidade da pilha acompanhada na emissão (verificação estática)
+    bool push() {
+        if (++depth > RuleEngine::RULE_STACK_DEPTH) return fail("expressao profunda demais");
+        if (depth > maxDepth) maxDepth = depth;
+        return true;
+    }
+    void pop() { depth--; }
+
+    bool operand() {
+        if (tok.type == TOK_NUM) {
+            float v = tok.num;
+            if (!emit(OP_CONST)) return false;
+            uint8_t b[4];
+            memcpy(b, &v, sizeof(v));
+            for (uint8_t i = 0; i < 4; i++) if (!emit(b[i])) return false;
+            next();
+            return push();
+        }
+        if (tok.type == TOK_WORD) {
+            for (uint8_t i = 0; i < RULE_SENSOR_COUNT; i++) {
+                if (strcmp(tok.text, RULE_SENSOR_NAMES[i]) == 0) {
+                    if (!emit(OP_LOAD) || !emit(i)) return false;
+                    next();
+                    return push();
+                }
+            }
+            return fail("sensor desconhecido");
+        }
+        return fail("esperado sensor ou numero");
+    }
+
+    bool factor() {
+        if (isWord("not")) {
+            next();
+            if (!factor()) return false;
+            return emit(OP_NOT);
+        }
+        if (tok.type == TOK_LPAREN) {
+            next();
+            if (!orExpr()) return false;
+            if (tok.type != TOK_RPAREN) return fail("falta ')'");
+            next();
+            return true;
+        }
+        if (!operand()) return false;
+        if (tok.type != TOK_OP) return fail("esperado comparador");
+        uint8_t op;
+        if      (strcmp(tok.text, ">")  == 0) op = OP_GT;
+        else if (strcmp(tok.text, "<")  == 0) op = OP_LT;
+        else if (strcmp(tok.text, ">=") == 0) op = OP_GE;
+        else if (strcmp(tok.text, "<=") == 0) op = OP_LE;
+        else if (strcmp(tok.text, "==") == 0) op = OP_EQ;
+        else if (strcmp(tok.text, "!=") == 0) op = OP_NE;
+        else return fail("comparador invalido");
+        next();
+        if (!operand()) return false;
+        pop();
+        return emit(op);
+    }
+
+    bool andExpr() {
+        if (!factor()) return false;
+        while (isWord("and")) {
+            next();
+            if (!factor()) return false;
+            pop();
+            if (!emit(OP_AND)) return false;
+        }
+        return true;
+    }
+
+    bool orExpr() {
+        if (!andExpr()) return false;
+        while (isWord("or")) {
+            next();
+            if (!andExpr()) return false;
+            pop();
+            if (!emit(OP_OR)) return false;
+        }
+        return true;
+    }
+
+    /// NÚMERO [s|min|h] → ms; ausente = 0
+    bool duration(unsigned long& ms) {
+        ms = 0;
+        if (tok.type != TOK_NUM) return true;
+        float v = tok.num;
+        next();
+        float scale = 1000.0f;
+        if (isWord("s"))        { next(); }
+        else if (isWord("min")) { scale = 60000.0f;   next(); }
+        else if (isWord("h"))   { scale = 3600000.0f; next(); }
+        if (v < 0.0f || v * scale > 7.0f * 86400000.0f) return fail("duracao invalida");
+        ms = (unsigned long)(v * scale);
+        return true;
+    }
+};
+
+} // namespace
+
+bool RuleEngine::_compileRule(const char* text, Program& prog, String& error) {
+    if (prog.count >= RULE_MAX) { error = "regras demais"; return false; }
+
+    uint8_t buf[RULE_MAX_CODE];
+    RuleCompiler c = {text, {}, buf, 0, 0, 0, nullptr};
+    Rule r = {};
+
+    c.next();
+    if (!c.isWord("if")) c.fail("esperado 'if'");
+    else {
+        c.next();
+        if (c.orExpr()) {
+            if (c.isWord("for")) {
+                c.next();
+                if (c.tok.type != TOK_NUM) c.fail("esperada duracao apos 'for'");
+                else c.duration(r.holdMs);
+            }
+        }
+    }
+    if (!c.err && !c.isWord("then")) c.fail("esperado 'then'");
+
+    if (!c.err) {
+        c.next();
+        int act = -1;
+        for (uint8_t i = 0; i < RULE_ACT_COUNT; i++) {
+            if (c.isWord(RULE_ACTUATOR_NAMES[i])) act = i;
+        }
+        if (act < 0) c.fail("atuador desconhecido");
+        else {
+            r.actuator = (uint8_t)act;
+            c.next();
+            if (c.isWord("on"))       { r.value = (act == RULE_ACT_LED) ? 255 : 1; c.next(); }
+            else if (c.isWord("off")) { r.value = 0; c.next(); }
+            else if (act == RULE_ACT_LED && c.tok.type == TOK_NUM &&
+                     c.tok.num >= 0.0f && c.tok.num <= 255.0f) {
+                r.value = (int16_t)c.tok.num;
+                c.next();
+            } else c.fail("esperado on/off (ou intensidade 0-255 no led)");
+            if (!c.err) c.duration(r.durationMs);
+            if (!c.err && c.tok.type != TOK_END) c.fail("texto inesperado apos a acao");
+        }
+    }
+
+    if (c.err) { error = c.err; return false; }
+    if (prog.codeUsed + c.len > RULE_CODE_SIZE) { error = "bytecode total excedido"; return false; }
+
+    r.codeStart = prog.codeUsed;
+    r.codeLen   = c.len;
+    memcpy(prog.code + prog.codeUsed, buf, c.len);
+    prog.codeUsed += c.len;
+    prog.rules[prog.count++] = r;
+    return true;
+}
+
+bool RuleEngine::load(const String& source, String& error) {
+    Program next = {};
+    char line[160];
+    uint8_t lineNo = 0;
+    unsigned int i = 0, n = source.length();
+
+    while (i <= n) {
+        // Extrai a próxima regra (até '\n', ';' ou fim)
+        uint8_t k = 0;
+        bool truncated = false;
+        while (i < n && source[i] != '\n' && source[i] != ';') {
+            if (source[i] == '#') {   // comentário até o fim da linha, ';' incluso
+                while (i < n && source[i] != '\n') i++;
+                break;
+            }
+            if (k < sizeof(line) - 1) line[k++] = source[i];
+            else truncated = true;
+            i++;
+        }
+        i++;
+        line[k] = '\0';
+
+        const char* t = line;
+        while (*t == ' ' || *t == '\t' || *t == '\r') t++;
+        if (*t == '\0') continue;
+        lineNo++;
+
+        String e;
+        if (truncated) e = "regra longa demais";
+        if (truncated || !_compileRule(t, next, e)) {
+            error = "regra " + String(lineNo) + ": " + e;
+            return false;
+        }
+    }
+
+    _prog   = next;
+    memset(_state, 0, sizeof(_state));
+    _cursor = 0;
+    _active = 0;
+    error   = "";
+    return true;
+}
+
+void RuleEngine::clear() {
+    memset(&_prog, 0, sizeof(_prog));
+    memset(_state, 0, sizeof(_state));
+    _cursor = 0;
+    _active = 0;
+}
+
+// =============================================================================
+// INTERPRETADOR
+// =============================================================================
+
+bool RuleEngine::_run(const Rule& r, const float inputs[RULE_SENSOR_COUNT]) const {
+    float   st[RULE_STACK_DEPTH];
+    uint8_t sp = 0;
+    const uint8_t* pc  = _prog.code + r.codeStart;
+    const uint8_t* end = pc + r.codeLen;
+
+    // Profundidade e operandos já validados na compilação
+    while (pc < end) {
+        uint8_t op = *pc++;
+        switch (op) {
+            case OP_LOAD:
+                // Sensor inválido anula a condição inteira (inclusive sob "not")
+                if (isnan(inputs[*pc])) return false;
+                st[sp++] = inputs[*pc++];
+                break;
+            case OP_CONST: memcpy(&st[sp++], pc, sizeof(float)); pc += sizeof(float); break;
+            case OP_NOT:   st[sp - 1] = (st[sp - 1] != 0.0f) ? 0.0f : 1.0f; break;
+            default: {
+                float b = st[--sp];
+                float a = st[sp - 1];
+                bool  v = false;
+                switch (op) {
+                    case OP_GT:  v = a >  b; break;
+                    case OP_LT:  v = a <  b; break;
+                    case OP_GE:  v = a >= b; break;
+                    case OP_LE:  v = a <= b; break;
+                    case OP_EQ:  v = a == b; break;
+                    case OP_NE:  v = !isnan(a) && !isnan(b) && a != b; break;
+                    case OP_AND: v = (a != 0.0f) && (b != 0.0f); break;
+                    case OP_OR:  v = (a != 0.0f) || (b != 0.0f); break;
+                }
+                st[sp - 1] = v ? 1.0f : 0.0f;
+            }
+        }
+    }
+    return sp > 0 && st[0] != 0.0f;
+}
+
+RuleOverrides RuleEngine::evaluate(const float inputs[RULE_SENSOR_COUNT], unsigned long now) {
+    RuleOverrides ov = {-1, -1, -1};
+    _active = 0;
+    if (_prog.count == 0) return ov;
+
+    // Avaliação das condições dentro do orçamento (bytes ≥ instruções)
+    uint16_t budget = RULE_STEP_BUDGET;
+    for (uint8_t visited = 0; visited < _prog.count; visited++) {
+        const Rule& r = _prog.rules[_cursor];
+        if (r.codeLen > budget) break;   // continua desta regra no próximo ciclo
+        budget -= r.codeLen;
+
+        RuleState& s = _state[_cursor];
+        bool was = s.cond;
+        s.cond = _run(r, inputs);
+        if (s.cond && !was) s.trueSince = now;
+
+        _cursor = (_cursor + 1) % _prog.count;
+    }
+
+    // Temporização e composição das ações (todas as regras, O(n))
+    for (uint8_t i = 0; i < _prog.count; i++) {
+        const Rule& r = _prog.rules[i];
+        RuleState&  s = _state[i];
+
+        bool held = s.cond && now - s.trueSince >= r.holdMs;
+        if (r.durationMs == 0) {
+            s.firing = held;
+        } else if (s.firing) {
+            if (now - s.firedAt >= r.durationMs) {
+                s.firing    = false;
+                s.trueSince = now;   // exige novo período "for" (se ainda verdadeira)
+            }
+        } else if (held) {
+            s.firing  = true;
+            s.firedAt = now;
+        }
+        if (!s.firing) continue;
+
+        _active++;
+        switch (r.actuator) {
+            case RULE_ACT_EXHAUST:
+                if (ov.exhaust != 1) ov.exhaust = (int8_t)r.value;
+                break;
+            case RULE_ACT_HUMIDIFIER:
+                if (ov.humidifier != 0) ov.humidifier = (int8_t)r.value;
+                break;
+            case RULE_ACT_LED:
+                if (r.value > ov.led) ov.led = r.value;
+                break;
+        }
+    }
+    return ov;
+}
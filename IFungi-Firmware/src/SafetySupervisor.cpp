@@ -0,0 +1,156 @@
+/**
+ * @file SafetySupervisor.cpp
+ * @brief Limites rígidos nos relés, independentes do modo e da rede
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "SafetySupervisor.h"
+#include "ActuatorController.h"
+#include "SensorController.h"
+#include <cmath>
+
+static const uint8_t RELAYS      = 4;
+static const uint8_t NO_REASON   = 0xFF;
+static const uint8_t MASK_PELTIER_HUMIDIFIER = 0x07;   ///< R1, R2, R3
+
+bool SafetySupervisor::begin(ActuatorController& actuators, SensorController& sensors) {
+    if (_handle != nullptr) return true;
+    _actuators = &actuators;
+    _sensors   = &sensors;
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        task,
+        "Safety_Task",
+        3072,
+        this,
+        TASK_PRIORITY,
+        &_handle,
+        0   // ← core 0
+    );
+    if (created != pdPASS) {
+        _handle = nullptr;
+        Serial.println("[safety] ERRO: falha ao criar Safety_Task — limites verificados pela loop");
+        return false;
+    }
+    Serial.printf("[safety] Supervisor ativo: periodo %lums, Tmax %.1f C, leitura parada %lus\n",
+                  PERIOD_MS, limits.maxTemp, limits.staleMs / 1000UL);
+    return true;
+}
+
+void SafetySupervisor::task(void* parameter) {
+    SafetySupervisor* self = static_cast<SafetySupervisor*>(parameter);
+    TickType_t wake = xTaskGetTickCount();
+    for (;;) {
+        self->step();
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(PERIOD_MS));
+    }
+}
+
+void SafetySupervisor::poll() {
+    if (_handle != nullptr || _actuators == nullptr) return;
+    unsigned long now = millis();
+    if (_lastPoll != 0 && now - _lastPoll < PERIOD_MS) return;
+    _lastPoll = now;
+    step();
+}
+
+// =============================================================================
+// PERÍODO
+// =============================================================================
+
+void SafetySupervisor::step() {
+    // Leituras sem sensorMutex: valores de 32 bits, escritos só por update().
+    // lastRead antes de millis(): update() concorrente não gera leitura "no
+    // futuro"; comparação com sinal cobre o que escapar (sem wrap = parada).
+    unsigned long lastRead = _sensors->lastReadMillis();
+    unsigned long now      = millis();
+    float         temp     = _sensors->getTemperature();
+    bool          dhtOK    = _sensors->isDHTHealthy() && !isnan(temp);
+    bool          stale    = lastRead == 0 || (long)(now - lastRead) > (long)limits.staleMs;
+    bool          waterLow = _sensors->getWaterLevel();
+
+    if (!isnan(temp)) {
+        if (temp >= limits.maxTemp)                              _overTemp = true;
+        else if (temp <= limits.maxTemp - limits.tempHysteresis) _overTemp = false;
+    }
+
+    // Tempo ligado contínuo medido na saída efetiva de cada relé
+    uint8_t outputs = _actuators->relayOutputs();
+    for (uint8_t i = 0; i < RELAYS; i++) {
+        if (!(outputs & (1 << i))) {
+            _onSince[i] = 0;
+        } else if (_onSince[i] == 0) {
+            _onSince[i] = now ? now : 1UL;   // 0 reservado para "desligado"
+        }
+
+        if (limits.maxOnMs[i] > 0 && _onSince[i] != 0 && now - _onSince[i] >= limits.maxOnMs[i]) {
+            _locked[i]      = true;
+            _lockedUntil[i] = now + limits.lockoutMs;
+        } else if (_locked[i] && (long)(now - _lockedUntil[i]) >= 0) {
+            _locked[i] = false;
+        }
+    }
+
+    // Motivo do bloqueio de cada relé (o primeiro que se aplica)
+    uint8_t why[RELAYS] = {NO_REASON, NO_REASON, NO_REASON, NO_REASON};
+    auto block = [&why](uint8_t mask, SafetyReason reason) {
+        for (uint8_t i = 0; i < RELAYS; i++) {
+            if ((mask & (1 << i)) && why[i] == NO_REASON) why[i] = reason;
+        }
+    };
+    if (stale)       block(MASK_PELTIER_HUMIDIFIER, SAFETY_SENSOR_STALE);
+    else if (!dhtOK) block(MASK_PELTIER_HUMIDIFIER, SAFETY_DHT_FAULT);
+    if (_overTemp)   block(0x02, SAFETY_OVER_TEMP);
+    if (waterLow)    block(0x04, SAFETY_WATER_LOW);
+    for (uint8_t i = 0; i < RELAYS; i++) {
+        if (_locked[i]) block(1 << i, SAFETY_MAX_ON_TIME);
+    }
+
+    uint8_t inhibit = 0;
+    for (uint8_t i = 0; i < RELAYS; i++) {
+        if (why[i] != NO_REASON) inhibit |= 1 << i;
+    }
+    _inhibit = inhibit;   // mudança registrada pela loop
+
+    uint8_t cut = _actuators->safetyEnforce(inhibit);
+    if (cut == 0) return;
+
+    // Uma intervenção por motivo; relé do par do Peltier cortado junto herda
+    // o motivo do outro
+    uint8_t reasons = 0;
+    for (uint8_t i = 0; i < RELAYS; i++) {
+        if (!(cut & (1 << i))) continue;
+        uint8_t reason = why[i];
+        if (reason == NO_REASON && i < 2) reason = why[1 - i];
+        if (reason != NO_REASON) reasons |= 1 << reason;
+    }
+    // Motivo e relés antes do contador: a loop lê o contador e depois os demais
+    _lastCut = cut;
+    for (uint8_t r = 0; r < SAFETY_REASONS; r++) {
+        if (!(reasons & (1 << r))) continue;
+        _lastReason = (SafetyReason)r;
+        _count[r]   = _count[r] + 1;
+    }
+}
+
+// =============================================================================
+// CONSULTA
+// =============================================================================
+
+uint32_t SafetySupervisor::totalInterventions() const {
+    uint32_t total = 0;
+    for (uint8_t r = 0; r < SAFETY_REASONS; r++) total += _count[r];
+    return total;
+}
+
+const char* SafetySupervisor::reasonName(SafetyReason reason) {
+    switch (reason) {
+        case SAFETY_SENSOR_STALE: return "leituraParada";
+        case SAFETY_DHT_FAULT:    return "falhaDht";
+        case SAFETY_OVER_TEMP:    return "temperaturaMax";
+        case SAFETY_WATER_LOW:    return "aguaBaixa";
+        case SAFETY_MAX_ON_TIME:  return "tempoLigado";
+        default:                  return "?";
+    }
+}
@@ -1,9 +1,28 @@
 /**
  * @file SensorController.cpp
  * @brief Controlador de sensores ambientais (DHT22, CCS811, LDR, MQ-7, nível de água)
- * @version 1.3.0
+ * @version 1.5.0
  * @date 2026
  *
+ * NOVIDADES (v1.5.0):
+ *  - LUX REAL: getLight() converte a contagem do LDR para lux pela curva de
+ *    LightCalibration (pontos de referência capturados no modo calibração,
+ *    gravados na NVS "ldrcal"). Sem calibração continua a contagem crua, como
+ *    antes. getLightRaw() expõe o ADC.
+ *
+ * NOVIDADES (v1.4.0):
+ *  - DHT22 e LDR passam pelo registro de drivers (SensorRegistry.h): N sondas
+ *    por tipo definidas em tempo de compilação, saúde por sonda e fusão
+ *    (mediana/média/mín/máx). getTemperature()/getHumidity()/getLight()
+ *    retornam o valor fundido; isDHTHealthy() = ao menos uma sonda operante.
+ *  - CCS811 WARM START: o registrador de baseline é salvo periodicamente na
+ *    NVS (namespace "ccs811") e restaurado após begin()/recuperação se tiver
+ *    menos de CCS_BASELINE_MAX_AGE_S. Com baseline restaurado as leituras são
+ *    confiáveis após ~1 min; sem ele, só após o condicionamento de 20 min.
+ *    isCCS811Ready() sinaliza ao controle que eCO2/TVOC já podem ser usados.
+ *  - SNAPSHOT: ao fim de update(), se algum valor entregue ao controle mudou,
+ *    as tasks registradas em addSnapshotListener() recebem xTaskNotifyGive().
+ *
  * CORREÇÕES (v1.2.0):
  *  - BUG CRÍTICO DHT22 TIMING: adicionado delay de 500ms antes de cada leitura
  *    de recuperação. O sensor DHT22 requer no mínimo 250ms entre reinicialização
@@ -20,6 +39,7 @@
 
 #include "SensorController.h"
 #include <Adafruit_CCS811.h>
+#include <Preferences.h>
 #include <cmath>
 #include <type_traits>
 
@@ -51,6 +71,84 @@ int SensorController::mq7PpmFromAdc(int adcRaw, float tempC, float rhPct, bool c
     return (int)(ppm + 0.5f);
 }
 
+// =============================================================================
+// CCS811 — BASELINE (warm start)
+// =============================================================================
+
+unsigned long SensorController::nowEpoch() const {
+    return clockFn ? clockFn() : 0;
+}
+
+void SensorController::onCCS811Started() {
+    ccsStartedAt = millis();
+    lastBaselineSave = ccsStartedAt;
+
+    bool restored = restoreCCS811Baseline();
+    ccsReadyAt    = ccsStartedAt + (restored ? CCS_WARM_START_MS : CCS_CONDITIONING_MS);
+
+    if (restored) {
+        Serial.printf("[sensor] CCS811: baseline restaurado — leituras confiaveis em ~%lus\n",
+                      CCS_WARM_START_MS / 1000UL);
+    } else {
+        Serial.printf("[sensor] CCS811: sem baseline valido — condicionamento de %lu min\n",
+                      CCS_CONDITIONING_MS / 60000UL);
+    }
+}
+
+bool SensorController::restoreCCS811Baseline() {
+    Preferences prefs;
+    if (!prefs.begin("ccs811", true)) return false;   // namespace ainda não existe
+
+    if (!prefs.isKey("base")) {
+        prefs.end();
+        return false;
+    }
+    uint16_t      baseline = prefs.getUShort("base", 0);
+    unsigned long savedAt  = prefs.getULong("ts", 0);
+    prefs.end();
+
+    // Validade por idade: baseline muito antigo já não representa o sensor
+    // (deriva do elemento + mudança de ambiente). Sem relógio plausível não
+    // há como medir a idade — nesse caso o baseline é descartado.
+    unsigned long now = nowEpoch();
+    if (baseline == 0 || savedAt < 1609459200UL || now < 1609459200UL) {
+        Serial.println("[sensor] CCS811: baseline sem carimbo de tempo valido — ignorado");
+        return false;
+    }
+    unsigned long age = (now > savedAt) ? now - savedAt : 0;
+    if (age > CCS_BASELINE_MAX_AGE_S) {
+        Serial.printf("[sensor] CCS811: baseline expirado (%lu h) — ignorado\n", age / 3600UL);
+        return false;
+    }
+
+    ccs.setBaseline(baseline);
+    Serial.printf("[sensor] CCS811: baseline 0x%04X restaurado (idade %lu h)\n",
+                  baseline, age / 3600UL);
+    return true;
+}
+
+void SensorController::saveCCS811Baseline() {
+    unsigned long now = nowEpoch();
+    if (now < 1609459200UL) return;   // sem relógio — não dá para datar o baseline
+
+    uint16_t baseline = ccs.getBaseline();
+    if (baseline == 0) return;
+
+    Preferences prefs;
+    if (!prefs.begin("ccs811", false)) {
+        Serial.println("[nvs] Error opening NVS to save CCS811 baseline");
+        return;
+    }
+    prefs.putUShort("base", baseline);
+    prefs.putULong("ts", now);
+    prefs.end();
+    Serial.printf("[sensor] CCS811: baseline 0x%04X salvo na NVS\n", baseline);
+}
+
+bool SensorController::isCCS811Ready() const {
+    return ccsOK && (long)(millis() - ccsReadyAt) >= 0;
+}
+
 void SensorController::begin() {
     Serial.println("[sensor] Inicializando controlador de sensores...");
 
@@ -58,8 +156,10 @@ void SensorController::begin() {
     Serial.println("[sensor] MQ-7: aguardando ~120 s de estabilização.");
 
     pinMode(WATERLEVEL_PIN, INPUT);
-    pinMode(LDR_PIN, INPUT);
     pinMode(MQ7_PIN, INPUT);
+    ldrGroup.attach(SensorConfig::LDR_PINS);
+    ldrGroup.begin(1, 0, 0);
+    ldrCal.begin();
 
     Serial.println("[sensor] Configuração de pinos concluída");
     Serial.printf("[sensor] Threshold sensor água: %d\n", WATER_LEVEL_THRESHOLD);
@@ -69,38 +169,20 @@ void SensorController::begin() {
     // 1-2 segundos antes da primeira comunicação. O delay anterior de 2000ms era
     // insuficiente em boots frios (capacitor de desacoplamento carregando).
     // Aumentado para 3000ms para garantir estabilização completa.
-    Serial.println("[sensor] Inicializando DHT22...");
-    dht.begin();
-    delay(3000);   // ← era 2000ms; aumentado para boot frio confiável
-
-    int dhtAttempts = 0;
-    dhtOK = false;
-
-    while (dhtAttempts < 5 && !dhtOK) {
-        // BUG CORRIGIDO (v1.2.0): sem delay entre tentativas, o DHT22 não tem
-        // tempo de completar o ciclo de medição (mínimo 250ms). Aqui usamos
-        // 500ms para margem segura.
-        if (dhtAttempts > 0) {
-            delay(500);
-        }
-
-        float tempTest = dht.readTemperature();
-        float humidityTest = dht.readHumidity();
-
-        if (!isnan(tempTest) && !isnan(humidityTest)) {
-            dhtOK = true;
-            temperature = tempTest;
-            humidity = humidityTest;
-            Serial.printf("[sensor] DHT22 inicializado com sucesso (tentativa %d): %.1fC, %.1f%%\n",
-                          dhtAttempts + 1, tempTest, humidityTest);
-        } else {
-            Serial.printf("[sensor] Tentativa %d/5: DHT22 retornou NAN — aguardando\n", dhtAttempts + 1);
-            dhtAttempts++;
-        }
-    }
-
-    if (!dhtOK) {
-        Serial.println("[sensor] DHT22: ERRO - Sensor não responde após 5 tentativas");
+    //
+    // v1.4.0: as sondas vêm da tabela SensorConfig::DHT_PINS. Cada uma tem até
+    // 5 tentativas com 500ms entre elas (mínimo de 250ms do ciclo do DHT22).
+    Serial.printf("[sensor] Inicializando %u sonda(s) DHT22...\n", SensorConfig::DHT_COUNT);
+    dhtGroup.attach(SensorConfig::DHT_PINS);
+    uint8_t dhtUp = dhtGroup.begin(5, 500, 3000);   // ← settle era 2000ms; 3000ms p/ boot frio
+
+    if (dhtUp > 0) {
+        temperature = dhtGroup.value(Dht22Driver::CHANNEL_TEMPERATURE);
+        humidity    = dhtGroup.value(Dht22Driver::CHANNEL_HUMIDITY);
+        Serial.printf("[sensor] DHT22 inicializado (%u/%u sondas): %.1fC, %.1f%%\n",
+                      dhtUp, SensorConfig::DHT_COUNT, temperature, humidity);
+    } else {
+        Serial.println("[sensor] DHT22: ERRO - nenhuma sonda responde após 5 tentativas");
         // FAIL-SAFE: temperature=NAN sinaliza dado inválido.
         // ActuatorController verifica isDHTHealthy() e bloqueia o Peltier.
         // humidity=100% mantém umidificador desligado por segurança.
@@ -124,6 +206,7 @@ void SensorController::begin() {
 
             if (ccs.available()) {
                 Serial.println("[sensor] CCS811 pronto para leitura");
+                onCCS811Started();
                 break;
             } else {
                 Serial.println("[sensor] CCS811: ERRO - Não ficou pronto dentro do timeout");
@@ -144,10 +227,9 @@ void SensorController::begin() {
     co = 0;
     tvocs = 0;
     light = 0;
+    lightRaw = 0;
     waterLevel = false;
-    dhtFailCount = 0;
     ccsFailCount = 0;
-    dhtRecoveryTime = 0;
     ccsRecoveryTime = 0;
 
     Serial.println("[sensor] Controlador de sensores inicializado com sucesso");
@@ -157,68 +239,36 @@ void SensorController::update() {
     if (millis() - lastUpdate >= 2000) {
         static unsigned int readCount = 0;
 
-        light     = analogRead(LDR_PIN);
+        ldrGroup.sample();
+        lightRaw  = (int)(ldrGroup.value(0) + 0.5f);
+        light     = ldrCal.toLux(lightRaw);
         int mqAdc = analogRead(MQ7_PIN);
 
         if (readCount % 2 == 0) {
-            if (dhtOK) {
-                float newTemp = dht.readTemperature();
-                float newHum  = dht.readHumidity();
-
-                if (isnan(newTemp) || isnan(newHum)) {
-                    dhtFailCount++;
-                    Serial.printf("[sensor] DHT22: leitura inválida (%d/3 falhas consecutivas)\n", dhtFailCount);
-
-                    if (dhtFailCount >= 3) {
-                        dhtOK           = false;
-                        dhtRecoveryTime = millis();
-
-                        // FAIL-SAFE: NAN para temperatura sinaliza ao ActuatorController
-                        // que o Peltier deve ser bloqueado imediatamente.
-                        // humidity=100.0f mantém umidificador desligado.
-                        temperature = NAN;
-                        humidity    = 100.0f;
-
-                        Serial.println("[sensor] DHT22: INOPERANTE — Peltier bloqueado até recuperação");
-                    }
-                } else {
-                    temperature  = newTemp;
-                    humidity     = newHum;
-                    dhtFailCount = 0;
-
-                    if (ccsOK) {
-                        ccs.setEnvironmentalData(humidity, temperature);
-                    }
+            // Cada sonda tem contador próprio: 3 falhas consecutivas tiram a
+            // sonda da fusão e a recuperação (begin + 500ms + leitura) é tentada
+            // a cada 30s. O grupo só fica inoperante quando TODAS caem.
+            bool wasHealthy = dhtGroup.healthy();
+            bool nowHealthy = dhtGroup.sample();
+
+            if (nowHealthy) {
+                temperature = dhtGroup.value(Dht22Driver::CHANNEL_TEMPERATURE);
+                humidity    = dhtGroup.value(Dht22Driver::CHANNEL_HUMIDITY);
+
+                if (!wasHealthy) {
+                    Serial.printf("[sensor] DHT22: RECUPERADO — %.1fC, %.1f%%\n", temperature, humidity);
                 }
-            } else {
-                // ── Tentativa de recuperação do DHT22 ────────────────────────
-                if (millis() - dhtRecoveryTime >= 30000) {
-                    Serial.println("[sensor] DHT22: tentando recuperação...");
-                    dht.begin();
-
-                    // BUG CORRIGIDO (v1.2.0): delay OBRIGATÓRIO após dht.begin()
-                    // antes de tentar a leitura. O DHT22 precisa de pelo menos
-                    // 250ms para completar a inicialização interna. Sem este delay
-                    // a leitura sempre retornava NAN e o sensor nunca se recuperava.
-                    delay(500);
-
-                    float testTemp = dht.readTemperature();
-                    float testHum  = dht.readHumidity();
-
-                    if (!isnan(testTemp) && !isnan(testHum)) {
-                        dhtOK        = true;
-                        dhtFailCount = 0;
-                        temperature  = testTemp;
-                        humidity     = testHum;
-                        Serial.printf("[sensor] DHT22: RECUPERADO — %.1fC, %.1f%%\n", testTemp, testHum);
-                        if (ccsOK) {
-                            ccs.setEnvironmentalData(humidity, temperature);
-                        }
-                    } else {
-                        dhtRecoveryTime = millis();
-                        Serial.println("[sensor] DHT22: recuperação falhou, nova tentativa em 30s");
-                    }
+                if (ccsOK) {
+                    ccs.setEnvironmentalData(humidity, temperature);
                 }
+            } else if (wasHealthy) {
+                // FAIL-SAFE: NAN para temperatura sinaliza ao ActuatorController
+                // que o Peltier deve ser bloqueado imediatamente.
+                // humidity=100.0f mantém umidificador desligado.
+                temperature = NAN;
+                humidity    = 100.0f;
+
+                Serial.println("[sensor] DHT22: INOPERANTE — Peltier bloqueado até recuperação");
             }
         }
 
@@ -230,12 +280,28 @@ void SensorController::update() {
                         co2          = ccs.geteCO2();
                         tvocs        = ccs.getTVOC();
                         ccsFailCount = 0;
+
+                        if (!ccsReadyLogged && isCCS811Ready()) {
+                            ccsReadyLogged = true;
+                            Serial.printf("[sensor] CCS811: leituras liberadas para o controle (CO2=%d, TVOCs=%d)\n",
+                                          co2, tvocs);
+                        }
+
+                        // Só salva baseline de sensor condicionado (≥20 min rodando);
+                        // antes disso o registrador ainda reflete o aquecimento.
+                        unsigned long runFor = millis() - ccsStartedAt;
+                        if (runFor >= CCS_CONDITIONING_MS &&
+                            millis() - lastBaselineSave >= CCS_BASELINE_SAVE_INTERVAL_MS) {
+                            saveCCS811Baseline();
+                            lastBaselineSave = millis();
+                        }
                     } else {
                         ccsFailCount++;
                         Serial.printf("[sensor] CCS811: falha na leitura código %u (%d/3)\n", st, ccsFailCount);
 
                         if (ccsFailCount >= 3) {
                             ccsOK           = false;
+                            ccsReadyLogged  = false;
                             ccsRecoveryTime = millis();
                             Serial.println("[sensor] CCS811: INOPERANTE — tentativa de recuperação em 30s");
                         }
@@ -251,7 +317,8 @@ void SensorController::update() {
                             ccsFailCount = 0;
                             ccsOK        = true;
                             Serial.println("[sensor] CCS811: RECUPERADO com sucesso");
-                            if (dhtOK) {
+                            onCCS811Started();
+                            if (isDHTHealthy()) {
                                 ccs.setEnvironmentalData(humidity, temperature);
                             }
                         } else {
@@ -270,6 +337,7 @@ void SensorController::update() {
             co = 0;
         } else {
             // Usa temperatura/umidade reais só se o DHT está OK e os valores são válidos
+            bool  dhtOK = isDHTHealthy();
             float tComp = (dhtOK && !isnan(temperature)) ? temperature : 20.0f;
             float hComp = (dhtOK && !isnan(humidity))    ? humidity    : 50.0f;
             co = mq7PpmFromAdc(mqAdc, tComp, hComp, dhtOK);
@@ -288,21 +356,74 @@ void SensorController::update() {
         }
 
         if (readCount % 10 == 0) {
-            if (dhtOK) {
-                Serial.printf("[sensor] DHT22: %.1fC, %.1f%%, LDR: %d, CO: %d ppm, CCS811: %d ppm CO2\n",
-                             temperature, humidity, light, co, co2);
+            if (isDHTHealthy()) {
+                Serial.printf("[sensor] DHT22: %.1fC, %.1f%%, LDR: %d%s (ADC %d), CO: %d ppm, CCS811: %d ppm CO2\n",
+                             temperature, humidity, light, ldrCal.calibrated() ? " lux" : "",
+                             lightRaw, co, co2);
             } else {
-                Serial.printf("[sensor] DHT22: INOPERANTE | LDR: %d, CO: %d ppm, CCS811: %d ppm CO2\n",
-                             light, co, co2);
+                Serial.printf("[sensor] DHT22: INOPERANTE | LDR: %d%s (ADC %d), CO: %d ppm, CCS811: %d ppm CO2\n",
+                             light, ldrCal.calibrated() ? " lux" : "", lightRaw, co, co2);
             }
         }
 
         lastUpdate = millis();
         readCount++;
+
+        publishSnapshotIfChanged();
+    }
+}
+
+// =============================================================================
+// NOTIFICAÇÃO DE SNAPSHOT
+// =============================================================================
+
+bool SensorController::addSnapshotListener(TaskHandle_t task) {
+    if (task == nullptr || snapshotListenerCount >= MAX_SNAPSHOT_LISTENERS) return false;
+    for (uint8_t i = 0; i < snapshotListenerCount; i++) {
+        if (snapshotListeners[i] == task) return true;
+    }
+    snapshotListeners[snapshotListenerCount++] = task;
+    return true;
+}
+
+void SensorController::publishSnapshotIfChanged() {
+    // NAN != NAN: compara "ambos NAN" explicitamente para não notificar à toa
+    auto sameF = [](float a, float b) { return (isnan(a) && isnan(b)) || a == b; };
+
+    Snapshot cur = {temperature, humidity, co2, co, tvocs, light,
+                    waterLevel, isDHTHealthy(), isCCS811Ready()};
+    const Snapshot& last = lastSnapshot;
+    bool changed = !sameF(cur.temperature, last.temperature) ||
+                   !sameF(cur.humidity, last.humidity) ||
+                   cur.co2 != last.co2 || cur.co != last.co || cur.tvocs != last.tvocs ||
+                   cur.light != last.light || cur.waterLevel != last.waterLevel ||
+                   cur.dhtOK != last.dhtOK || cur.ccsReady != last.ccsReady;
+    if (!changed) return;
+
+    lastSnapshot = cur;
+    snapshotMs   = millis();
+    snapshotSeq++;
+    for (uint8_t i = 0; i < snapshotListenerCount; i++) {
+        xTaskNotifyGive(snapshotListeners[i]);
     }
 }
 
-// Retorna NAN quando dhtOK=false — chamador DEVE verificar isDHTHealthy()
+// =============================================================================
+// CALIBRAÇÃO DO LDR
+// =============================================================================
+
+bool SensorController::captureLightPoint(float lux, String& error) {
+    if (!ldrCal.addPoint(lightRaw, lux, error)) return false;
+    light = ldrCal.toLux(lightRaw);
+    return true;
+}
+
+void SensorController::clearLightCalibration() {
+    ldrCal.clear();
+    light = lightRaw;
+}
+
+// Retorna NAN quando nenhuma sonda DHT22 está operante — chamador DEVE verificar isDHTHealthy()
 float SensorController::getTemperature() { return temperature; }
 float SensorController::getHumidity()    { return humidity;    }
 int   SensorController::getCO2()         { return co2;         }
@@ -0,0 +1,86 @@
+/**
+ * @file SensorRegistry.cpp
+ * @brief Drivers concretos e fusão do registro de sensores
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "SensorRegistry.h"
+#include <cmath>
+
+// =============================================================================
+// DHT22
+// =============================================================================
+
+void Dht22Driver::attach(uint8_t pin) {
+    _pin = pin;
+    if (_dht == nullptr) {
+        // Alocação única no boot — a classe DHT não tem construtor padrão
+        _dht = new DHT(pin, DHT22);
+    }
+}
+
+void Dht22Driver::begin() {
+    if (_dht) _dht->begin();
+}
+
+bool Dht22Driver::read(float out[CHANNELS]) {
+    if (_dht == nullptr) return false;
+    float t = _dht->readTemperature();
+    float h = _dht->readHumidity();
+    if (isnan(t) || isnan(h)) return false;
+    out[CHANNEL_TEMPERATURE] = t;
+    out[CHANNEL_HUMIDITY]    = h;
+    return true;
+}
+
+bool Dht22Driver::recover(float out[CHANNELS]) {
+    if (_dht == nullptr) return false;
+    _dht->begin();
+    // O DHT22 precisa de pelo menos 250 ms após begin() para completar a
+    // inicialização interna — sem esta espera a leitura sempre retorna NAN.
+    delay(500);
+    return read(out);
+}
+
+// =============================================================================
+// FUSÃO
+// =============================================================================
+
+float fuseSensorValues(float* values, uint8_t n, FusionPolicy policy) {
+    if (n == 0) return NAN;
+    if (n == 1) return values[0];
+
+    switch (policy) {
+        case FUSION_MIN: {
+            float m = values[0];
+            for (uint8_t i = 1; i < n; i++) if (values[i] < m) m = values[i];
+            return m;
+        }
+        case FUSION_MAX: {
+            float m = values[0];
+            for (uint8_t i = 1; i < n; i++) if (values[i] > m) m = values[i];
+            return m;
+        }
+        case FUSION_MEDIAN: {
+            // Insertion sort — n é no máximo algumas sondas
+            for (uint8_t i = 1; i < n; i++) {
+                float v = values[i];
+                int8_t j = i - 1;
+                while (j >= 0 && values[j] > v) {
+                    values[j + 1] = values[j];
+                    j--;
+                }
+                values[j + 1] = v;
+            }
+            if (n % 2) return values[n / 2];
+            return 0.5f * (values[n / 2 - 1] + values[n / 2]);
+        }
+        case FUSION_MEAN:
+        default: {
+            float sum = 0.0f;
+            for (uint8_t i = 0; i < n; i++) sum += values[i];
+            return sum / n;
+        }
+    }
+}
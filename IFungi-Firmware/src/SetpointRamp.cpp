@@ -0,0 +1,58 @@
+/**
+ * @file SetpointRamp.cpp
+ * @brief Avanço incremental dos setpoints efetivos
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "SetpointRamp.h"
+
+void SetpointRamp::snap() {
+    for (uint8_t ch = 0; ch < RAMP_CHANNELS; ch++) {
+        _effective[ch] = _target[ch];
+    }
+}
+
+float SetpointRamp::_approach(float value, float target, float maxStep) {
+    if (maxStep < 0.0f) return target;    // taxa 0 → imediato
+    if (target > value) return (target - value <= maxStep) ? target : value + maxStep;
+    return (value - target <= maxStep) ? target : value - maxStep;
+}
+
+bool SetpointRamp::update(unsigned long now) {
+    if (!_initialized) {
+        _initialized = true;
+        _lastUpdate  = now;
+        snap();
+        return false;
+    }
+
+    unsigned long dt = now - _lastUpdate;
+    _lastUpdate = now;
+    if (dt > RAMP_MAX_STEP_MS) dt = RAMP_MAX_STEP_MS;
+    float hours = dt / 3600000.0f;
+
+    // Passo negativo sinaliza taxa 0 (imediato); Δt = 0 dá passo 0 (parado)
+    float tempStep     = tempRatePerHour > 0.0f ? tempRatePerHour * hours : -1.0f;
+    float humidityStep = humidityRatePerHour > 0.0f ? humidityRatePerHour * hours : -1.0f;
+
+    _effective[RAMP_TEMP_MIN]     = _approach(_effective[RAMP_TEMP_MIN],     _target[RAMP_TEMP_MIN],     tempStep);
+    _effective[RAMP_TEMP_MAX]     = _approach(_effective[RAMP_TEMP_MAX],     _target[RAMP_TEMP_MAX],     tempStep);
+    _effective[RAMP_HUMIDITY_MIN] = _approach(_effective[RAMP_HUMIDITY_MIN], _target[RAMP_HUMIDITY_MIN], humidityStep);
+    _effective[RAMP_HUMIDITY_MAX] = _approach(_effective[RAMP_HUMIDITY_MAX], _target[RAMP_HUMIDITY_MAX], humidityStep);
+
+    if (_effective[RAMP_TEMP_MIN] > _effective[RAMP_TEMP_MAX]) {
+        _effective[RAMP_TEMP_MIN] = _effective[RAMP_TEMP_MAX];
+    }
+    if (_effective[RAMP_HUMIDITY_MIN] > _effective[RAMP_HUMIDITY_MAX]) {
+        _effective[RAMP_HUMIDITY_MIN] = _effective[RAMP_HUMIDITY_MAX];
+    }
+    return ramping();
+}
+
+bool SetpointRamp::ramping() const {
+    for (uint8_t ch = 0; ch < RAMP_CHANNELS; ch++) {
+        if (_effective[ch] != _target[ch]) return true;
+    }
+    return false;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file TimeWindows.cpp
+ * @brief Decodificação das janelas de horário e cálculo da próxima transição
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "TimeWindows.h"
+#include <cstring>
+
+static const uint32_t TW_MINUTES_PER_DAY = 1440;
+
+// =============================================================================
+// DECODIFICAÇÃO
+// =============================================================================
+
+/// "HH:MM" → minutos do dia; avança p. Aceita "24:00" só como fim.
+static bool parseTimeWindowHM(const char*& p, bool allowEndOfDay, int& minutes) {
+    if (p[0] < '0' || p[0] > '9') return false;
+    int h = *p++ - '0';
+    if (*p >= '0' && *p <= '9') h = h * 10 + (*p++ - '0');
+    if (*p++ != ':') return false;
+    if (p[0] < '0' || p[0] > '5' || p[1] < '0' || p[1] > '9') return false;
+    int m = (p[0] - '0') * 10 + (p[1] - '0');
+    p += 2;
+    if (h == 24 && m == 0 && allowEndOfDay) { minutes = TW_MINUTES_PER_DAY; return true; }
+    if (h > 23) return false;
+    minutes = h * 60 + m;
+    return true;
+}
+
+bool TimeWindowSchedule::_parseEntry(char* entry, TimeWindow& w, String& error) {
+    const char* p = entry;
+    int start, end;
+    if (!parseTimeWindowHM(p, false, start) || *p++ != '-' || !parseTimeWindowHM(p, true, end)) {
+        error = "esperado HH:MM-HH:MM";
+        return false;
+    }
+    if (start == end) {
+        // Ambíguo (vazio ou 24 h) — o dia todo se escreve 00:00-24:00
+        error = "inicio igual ao fim";
+        return false;
+    }
+
+    uint8_t days = TW_ALL_DAYS;
+    if (*p == '@') {
+        p++;
+        days = 0;
+        if (*p == '\0') { error = "dias vazios"; return false; }
+        for (; *p >= '0' && *p <= '6'; p++) days |= (uint8_t)(1 << (*p - '0'));
+    }
+    if (*p != '\0') {
+        error = "caractere inesperado: " + String(p);
+        return false;
+    }
+
+    w.startMin = (uint16_t)start;
+    w.endMin   = (uint16_t)end;
+    w.days     = days;
+    return true;
+}
+
+bool TimeWindowSchedule::setText(const String& text, String& error) {
+    TimeWindow parsed[TW_MAX_WINDOWS];
+    uint8_t    count = 0;
+
+    char buf[160];
+    if (text.length() >= sizeof(buf)) {
+        error = "texto longo demais";
+        return false;
+    }
+    // Remove espaços para aceitar "06:00 - 12:00 @ 12345"
+    uint8_t k = 0;
+    for (unsigned int i = 0; i < text.length(); i++) {
+        char c = text[i];
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') buf[k++] = c;
+    }
+    buf[k] = '\0';
+    if (_text == buf) {
+        error = "";
+        return true;   // sem mudança: não invalida o cache nem regrava a NVS
+    }
+    String normalized(buf);   // strtok_r abaixo quebra buf
+
+    uint8_t n = 0;
+    char* save = nullptr;
+    for (char* e = strtok_r(buf, ";,", &save); e; e = strtok_r(nullptr, ";,", &save)) {
+        n++;
+        String err;
+        if (count >= TW_MAX_WINDOWS) err = "janelas demais";
+        if (err.length() || !_parseEntry(e, parsed[count], err)) {
+            error = "janela " + String(n) + ": " + err;
+            return false;
+        }
+        count++;
+    }
+
+    _text = normalized;
+    if (count > 0) {
+        memcpy(_windows, parsed, sizeof(TimeWindow) * count);
+        _count = count;
+    } else {
+        // Texto vazio: volta para a janela dos campos antigos
+        _count = 0;
+        int s = _defaultStart, e = _defaultEnd;
+        _defaultStart = _defaultEnd = -1;
+        if (s >= 0) setDefaultWindow(s, e);
+    }
+    _revision++;
+    _dirty = true;
+    error  = "";
+    return true;
+}
+
+void TimeWindowSchedule::setDefaultWindow(int startMin, int endMin) {
+    if (startMin == _defaultStart && endMin == _defaultEnd) return;
+    _defaultStart = startMin;
+    _defaultEnd   = endMin;
+    if (hasCustom()) return;
+
+    _dirty = true;
+    if (startMin < 0 || startMin >= (int)TW_MINUTES_PER_DAY ||
+        endMin   < 0 || endMin   >  (int)TW_MINUTES_PER_DAY || startMin == endMin) {
+        _count = 0;
+        Serial.printf("[sched] WARN: Janela %02d:%02d-%02d:%02d invalida, agenda ignorada.\n",
+                      startMin / 60, startMin % 60, endMin / 60, endMin % 60);
+        return;
+    }
+    _windows[0].startMin = (uint16_t)startMin;
+    _windows[0].endMin   = (uint16_t)endMin;
+    _windows[0].days     = TW_ALL_DAYS;
+    _count = 1;
+}
+
+String TimeWindowSchedule::label() const {
+    if (hasCustom()) return _text;
+    if (_count == 0) return "invalida";
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%02d:%02d-%02d:%02d",
+             _windows[0].startMin / 60, _windows[0].startMin % 60,
+             _windows[0].endMin / 60, _windows[0].endMin % 60);
+    return String(buf);
+}
+
+// =============================================================================
+// AVALIAÇÃO
+// =============================================================================
+
+bool TimeWindowSchedule::_stateAtMinute(uint32_t minute) const {
+    uint32_t day   = minute / TW_MINUTES_PER_DAY;
+    uint16_t m     = (uint16_t)(minute % TW_MINUTES_PER_DAY);
+    uint8_t  today = (uint8_t)((day + 4) % 7);
+    uint8_t  yday  = (uint8_t)((today + 6) % 7);
+
+    for (uint8_t i = 0; i < _count; i++) {
+        const TimeWindow& w = _windows[i];
+        if (w.startMin < w.endMin) {
+            if ((w.days & (1 << today)) && m >= w.startMin && m < w.endMin) return true;
+        } else {
+            // Cruza a meia-noite: trecho da noite de hoje + madrugada iniciada ontem
+            if ((w.days & (1 << today)) && m >= w.startMin) return true;
+            if ((w.days & (1 << yday))  && m <  w.endMin)   return true;
+        }
+    }
+    return false;
+}
+
+void TimeWindowSchedule::_recompute(unsigned long ts) {
+    _dirty = false;
+    uint32_t now = ts / 60UL;
+    _on = _stateAtMinute(now);
+
+    // Fronteiras possíveis (minuto do dia), ordenadas e sem repetição
+    uint16_t marks[TW_MAX_WINDOWS * 2];
+    uint8_t  nMarks = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        uint16_t cand[2] = { _windows[i].startMin,
+                             (uint16_t)(_windows[i].endMin % TW_MINUTES_PER_DAY) };
+        for (uint8_t c = 0; c < 2; c++) {
+            uint8_t j = nMarks;
+            bool dup = false;
+            for (uint8_t k = 0; k < nMarks; k++) dup |= (marks[k] == cand[c]);
+            if (dup) continue;
+            while (j > 0 && marks[j - 1] > cand[c]) { marks[j] = marks[j - 1]; j--; }
+            marks[j] = cand[c];
+            nMarks++;
+        }
+    }
+
+    uint32_t today = now / TW_MINUTES_PER_DAY;
+
+    // Próxima transição: primeira fronteira após agora com estado diferente
+    _nextChange = TW_NEVER;
+    for (uint8_t d = 0; d <= TW_SCAN_DAYS && _nextChange == TW_NEVER; d++) {
+        for (uint8_t i = 0; i < nMarks; i++) {
+            uint32_t t = (today + d) * TW_MINUTES_PER_DAY + marks[i];
+            if (t <= now || _stateAtMinute(t) == _on) continue;
+            _nextChange = (unsigned long)t * 60UL;
+            break;
+        }
+    }
+
+    // Início do bloco: última fronteira até agora em que o estado mudou
+    _blockStart = 0;
+    for (uint8_t d = 0; d <= TW_SCAN_DAYS && d <= today && _blockStart == 0; d++) {
+        for (int8_t i = (int8_t)nMarks - 1; i >= 0; i--) {
+            uint32_t t = (today - d) * TW_MINUTES_PER_DAY + marks[i];
+            if (t > now || t == 0 || _stateAtMinute(t - 1) == _on) continue;
+            _blockStart = (unsigned long)t * 60UL;
+            break;
+        }
+    }
+}
+
+bool TimeWindowSchedule::isOn(unsigned long ts) {
+    if (_dirty || ts < _blockStart || ts >= _nextChange) {
+        _recompute(ts);
+    }
+    return _on;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file TimingProbe.cpp
+ * @brief Implementação das sondas de temporização
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "TimingProbe.h"
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <cstring>
+
+// Limites superiores das faixas (µs); a última faixa é aberta
+static const uint32_t PROBE_BIN_EDGES_US[TimingProbe::BINS - 1] = {
+    100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL
+};
+static const char* const PROBE_BIN_LABELS[TimingProbe::BINS] = {
+    "<0.1ms", "<1ms", "<10ms", "<100ms", "<1s", "<10s", ">=10s"
+};
+
+// Pior estágio — mesmo tratamento do rtcLastStage (RTC, sobrevive a reset)
+RTC_DATA_ATTR static char     rtcWorstStage[32] = "";
+RTC_DATA_ATTR static uint32_t rtcWorstStageUs   = 0;
+static portMUX_TYPE worstStageMux = portMUX_INITIALIZER_UNLOCKED;
+
+uint8_t TimingProbe::_bin(uint32_t us) {
+    uint8_t b = 0;
+    while (b < BINS - 1 && us >= PROBE_BIN_EDGES_US[b]) b++;
+    return b;
+}
+
+uint8_t TimingProbe::_p99(const uint32_t* hist, uint32_t total) {
+    if (total == 0) return 0;
+    uint32_t needed = total - total / 100;   // ceil(99%)
+    uint32_t acc = 0;
+    for (uint8_t b = 0; b < BINS; b++) {
+        acc += hist[b];
+        if (acc >= needed) return b;
+    }
+    return BINS - 1;
+}
+
+const char* TimingProbe::binLabel(uint8_t bin) {
+    return bin < BINS ? PROBE_BIN_LABELS[bin] : "?";
+}
+
+void TimingProbe::start() {
+    _startUs = esp_timer_get_time();
+    int64_t late = _released ? _startUs - _releaseUs : 0;
+    _jitterUs = late > 0 ? (uint32_t)late : 0;
+    if (!_released) _releaseUs = _startUs;
+    _waiting = false;
+}
+
+void TimingProbe::beginWait() {
+    if (_waiting) return;
+    _waitUs  = esp_timer_get_time();
+    _waiting = true;
+}
+
+void TimingProbe::stop() {
+    int64_t now  = esp_timer_get_time();
+    int64_t busy = _waiting ? _waitUs : now;
+    uint32_t exec = (uint32_t)(busy - _startUs);
+    uint32_t resp = (uint32_t)(now - _releaseUs);
+    _released = false;
+
+    if (_waiting) {
+        uint32_t wait = (uint32_t)(now - _waitUs);
+        _waiting = false;
+        _waitCount++;
+        _waitHist[_bin(wait)]++;
+        if (wait > _maxWaitUs) _maxWaitUs = wait;
+    }
+
+    _count++;
+    _execHist[_bin(exec)]++;
+    _jitterHist[_bin(_jitterUs)]++;
+    if (exec > _maxExecUs)          _maxExecUs   = exec;
+    if (_jitterUs > _maxJitterUs)   _maxJitterUs = _jitterUs;
+    if (resp > _deadlineUs)         _missed++;
+
+    noteStage(_name, exec);
+}
+
+void TimingProbe::summary(char* buf, size_t len) const {
+    int n = snprintf(buf, len, "%s n=%lu perdidos=%lu exec max=%lums p99%s jitter max=%lums p99%s",
+                     _name, (unsigned long)_count, (unsigned long)_missed,
+                     (unsigned long)(_maxExecUs / 1000UL), binLabel(_p99(_execHist, _count)),
+                     (unsigned long)(_maxJitterUs / 1000UL), binLabel(_p99(_jitterHist, _count)));
+    if (_waitCount > 0 && n > 0 && (size_t)n < len) {
+        snprintf(buf + n, len - n, " espera max=%lums p99%s",
+                 (unsigned long)(_maxWaitUs / 1000UL), binLabel(_p99(_waitHist, _waitCount)));
+    }
+}
+
+void TimingProbe::noteStage(const char* stage, uint32_t us) {
+    if (us <= rtcWorstStageUs) return;   // leitura sem trava: caminho comum barato
+    portENTER_CRITICAL(&worstStageMux);
+    if (us > rtcWorstStageUs) {
+        rtcWorstStageUs = us;
+        strncpy(rtcWorstStage, stage, sizeof(rtcWorstStage) - 1);
+        rtcWorstStage[sizeof(rtcWorstStage) - 1] = '\0';
+    }
+    portEXIT_CRITICAL(&worstStageMux);
+}
+
+const char* TimingProbe::worstStage() {
+    return rtcWorstStage[0] ? rtcWorstStage : "-";
+}
+
+uint32_t TimingProbe::worstStageUs() {
+    return rtcWorstStageUs;
+}
+
+void TimingProbe::resetWorstStage() {
+    portENTER_CRITICAL(&worstStageMux);
+    rtcWorstStage[0] = '\0';
+    rtcWorstStageUs  = 0;
+    portEXIT_CRITICAL(&worstStageMux);
+}
@@ -1,13 +1,89 @@
 /**
  * @file exhaustScheduler.cpp
- * @brief Implementação do agendador por horário do exaustor
- * @version 1.0
+ * @brief Implementação do agendador por horário e ciclo do exaustor
+ * @version 1.2
  * @date 2026
  */
 
 #include "exhaustScheduler.h"
 #include "LEDScheduler.h"
 
+/// Mistura de 32 bits (murmur3 fmix) — semente + nº do ciclo → início sorteado
+static uint32_t exhaustMix(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+bool ExhaustScheduler::_cycleWantsOn(unsigned long ts, int onMinutes) const {
+    if (onMinutes <= 0) return false;
+    uint32_t period = (uint32_t)(cyclePeriodMinutes > 0 ? cyclePeriodMinutes : 1) * 60UL;
+    uint32_t on     = (uint32_t)onMinutes * 60UL;
+    if (on >= period) return true;
+
+    uint32_t slack  = period - on;
+    uint32_t jitter = jitterMinutes > 0 ? (uint32_t)jitterMinutes * 60UL : 0;
+    if (jitter > slack) jitter = slack;
+
+    // Sem jitter o ciclo fica alinhado ao relógio (ex.: :00 e :30)
+    uint32_t t     = (uint32_t)ts + (jitter ? exhaustMix(_seed) % period : 0);
+    uint32_t cycle = t / period;
+    uint32_t pos   = t % period;
+    uint32_t start = jitter ? exhaustMix(_seed ^ cycle) % (jitter + 1) : 0;
+    return pos >= start && pos < start + on;
+}
+
+// =============================================================================
+// LIMITES DO RELÉ
+// =============================================================================
+
+bool ExhaustScheduler::fitCycleToRelay(const RelayWearConfig& relay) {
+    int minOn  = (int)((relay.minOnMs  + 59999UL) / 60000UL);
+    int minOff = (int)((relay.minOffMs + 59999UL) / 60000UL);
+    // Cada período com liga/desliga gasta 2 comutações
+    int minPeriod = relay.maxSwitchesPerHour ? (120 + relay.maxSwitchesPerHour - 1) / relay.maxSwitchesPerHour : 1;
+
+    int period  = cyclePeriodMinutes > 0 ? cyclePeriodMinutes : 1;
+    int onIn    = cycleOnMinutes;
+    int onOut   = cycleOutsideOnMinutes;
+    int jitter  = jitterMinutes;
+
+    // Ligado curto demais sobe para minOn; ligado o período todo não comuta
+    if (onIn  > 0 && onIn  < minOn) onIn  = minOn;
+    if (onOut > 0 && onOut < minOn) onOut = minOn;
+
+    // Maior tempo ligado que ainda comuta (< período) define o menor desligado
+    int longest = 0;
+    if (onIn  < period && onIn  > longest) longest = onIn;
+    if (onOut < period && onOut > longest) longest = onOut;
+    if (longest > 0) {
+        if (period < minPeriod)        period = minPeriod;
+        if (period < longest + minOff) period = longest + minOff;
+        int slack = period - longest - minOff;
+        if (jitter > slack) jitter = slack;
+        // Inícios sorteados aproximam ciclos vizinhos em até jitter
+        if (period - jitter < minPeriod) jitter = period - minPeriod;
+    }
+
+    bool changed = period != cyclePeriodMinutes || onIn != cycleOnMinutes ||
+                   onOut != cycleOutsideOnMinutes || jitter != jitterMinutes;
+    if (changed) {
+        Serial.printf("[exhaust] Ciclo ajustado ao rele 4 (min %d/%d min, %u/h): "
+                      "%d/%d min (fora %d), jitter %d -> %d/%d min (fora %d), jitter %d\n",
+                      minOn, minOff, relay.maxSwitchesPerHour,
+                      cycleOnMinutes, cyclePeriodMinutes, cycleOutsideOnMinutes, jitterMinutes,
+                      onIn, period, onOut, jitter);
+        cyclePeriodMinutes    = period;
+        cycleOnMinutes        = onIn;
+        cycleOutsideOnMinutes = onOut;
+        jitterMinutes         = jitter;
+    }
+    return changed;
+}
+
 void ExhaustScheduler::update(unsigned long currentTimestamp, bool debugMode) {
     // Scheduler fica completamente inativo no modo debug
     if (debugMode) {
@@ -15,8 +91,8 @@ void ExhaustScheduler::update(unsigned long currentTimestamp, bool debugMode) {
         return;
     }
 
-    // Timer desabilitado — não interfere no controle automático
-    if (!scheduleEnabled) {
+    // Timer e ciclo desabilitados — não interfere no controle automático
+    if (!isActive()) {
         _exhaustOn = false;
         return;
     }
@@ -27,26 +103,41 @@ void ExhaustScheduler::update(unsigned long currentTimestamp, bool debugMode) {
     int nowHour, nowMinute;
     LEDScheduler::secondsToHM(secondsOfDay, nowHour, nowMinute);
 
-    int nowMinutes   = nowHour * 60 + nowMinute;
-    int startMinutes = onHour  * 60 + onMinute;
-    int endMinutes   = offHour * 60 + offMinute;
+    int nowMinutes = nowHour * 60 + nowMinute;
 
-    // Valida janela
-    if (endMinutes <= startMinutes) {
-        Serial.println("[exhaust] WARN: Horario de fim <= horario de inicio, scheduler ignorado.");
-        _exhaustOn = false;
-        return;
+    bool withinWindow = true;   // ciclo sem timer vale o dia todo
+    if (scheduleEnabled) {
+        // Campos antigos viram a janela padrão (sem efeito com "windows" definido)
+        windows.setDefaultWindow(onHour * 60 + onMinute, offHour * 60 + offMinute);
+        if (windows.count() == 0) {
+            _exhaustOn = false;
+            return;
+        }
+        withinWindow = windows.isOn(currentTimestamp);
     }
 
-    bool withinWindow = (nowMinutes >= startMinutes && nowMinutes < endMinutes);
-    _exhaustOn = withinWindow;
+    if (!cycleEnabled) {
+        _exhaustOn = withinWindow;
+    } else {
+        int onMinutes = withinWindow ? cycleOnMinutes : cycleOutsideOnMinutes;
+        _exhaustOn = _cycleWantsOn(currentTimestamp, onMinutes);
+    }
 
-    static int lastReportedMin = -1;
-    if (nowMinutes != lastReportedMin) {
-        Serial.printf("[exhaust] Timer: %02d:%02d | Janela: %02d:%02d-%02d:%02d | %s\n",
-                      nowHour, nowMinute,
-                      onHour, onMinute, offHour, offMinute,
-                      _exhaustOn ? "LIGADO" : "DESLIGADO");
+    static int  lastReportedMin = -1;
+    static bool lastReportedOn  = false;
+    if (nowMinutes != lastReportedMin || _exhaustOn != lastReportedOn) {
+        if (cycleEnabled) {
+            Serial.printf("[exhaust] Ciclo: %02d:%02d | %d/%d min%s | %s\n",
+                          nowHour, nowMinute,
+                          withinWindow ? cycleOnMinutes : cycleOutsideOnMinutes,
+                          cyclePeriodMinutes, withinWindow ? "" : " (fora da janela)",
+                          _exhaustOn ? "LIGADO" : "DESLIGADO");
+        } else {
+            Serial.printf("[exhaust] Timer: %02d:%02d | Janelas: %s | %s\n",
+                          nowHour, nowMinute, windows.label().c_str(),
+                          _exhaustOn ? "LIGADO" : "DESLIGADO");
+        }
         lastReportedMin = nowMinutes;
+        lastReportedOn  = _exhaustOn;
     }
 }